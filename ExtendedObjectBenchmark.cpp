@@ -0,0 +1,372 @@
+/*************************************************************************\
+* Copyright (c) 2021 HZB.
+* Author: Carsten Winkler carsten.winkler@helmholtz-berlin.de
+*
+* Benchmarks of the hot paths of ExtendedObjectOpen62541
+*
+*   ExtendedObjectBenchmark [endpointUrl] [parentId] [repeats] [resultFile]
+*
+* defaults to the local test server (ExtendedObjectTestServer) and
+* writes one JSON object per benchmark line to resultFile (default stdout,
+* which also receives the log output of the module):
+*   {"benchmark":"...","ops":n,"ns_per_op":t,"allocs_per_op":a,
+*    "requests_per_op":r,"throughput":x,"unit":"...","peak_rss_kb":k}
+* allocations are counted on glibc systems only (otherwise -1),
+* requests are the client service calls of the module
+* --------------------------------------------------------------------------
+* based on open62541
+*   https://github.com/open62541/open62541/releases/tag/v1.2.2
+*
+\*************************************************************************/
+
+#include <open62541/client_config_default.h>
+#include <open62541/client_highlevel.h>
+#include <open62541/client_subscriptions.h>
+#include <open62541/plugin/log_stdout.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// allocation counter, glibc allows to replace malloc and friends
+static std::atomic<size_t> benchAllocations(0);
+#if defined(__GLIBC__)
+static const UA_Boolean benchCountsAllocations = true;
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* p, size_t size);
+void* malloc(size_t size) {
+    benchAllocations++;
+    return __libc_malloc(size);
+}
+void* calloc(size_t count, size_t size) {
+    benchAllocations++;
+    return __libc_calloc(count, size);
+}
+void* realloc(void* p, size_t size) {
+    benchAllocations++;
+    return __libc_realloc(p, size);
+}
+}
+#else
+static const UA_Boolean benchCountsAllocations = false;
+#endif
+
+// request counter, the service calls of the module are redirected to these wrappers
+static std::atomic<size_t> benchRequests(0);
+static FILE* benchResults;
+static UA_ReadResponse benchServiceRead(UA_Client* client, const UA_ReadRequest request) {
+    benchRequests++;
+    return UA_Client_Service_read(client, request);
+}
+static UA_BrowseResponse benchServiceBrowse(UA_Client* client, const UA_BrowseRequest request) {
+    benchRequests++;
+    return UA_Client_Service_browse(client, request);
+}
+static UA_BrowseNextResponse benchServiceBrowseNext(UA_Client* client, const UA_BrowseNextRequest request) {
+    benchRequests++;
+    return UA_Client_Service_browseNext(client, request);
+}
+static UA_StatusCode benchReadValueAttribute(UA_Client* client, const UA_NodeId nodeId, UA_Variant* outValue) {
+    benchRequests++;
+    return UA_Client_readValueAttribute(client, nodeId, outValue);
+}
+static UA_StatusCode benchReadNodeClassAttribute(UA_Client* client, const UA_NodeId nodeId, UA_NodeClass* outNodeClass) {
+    benchRequests++;
+    return UA_Client_readNodeClassAttribute(client, nodeId, outNodeClass);
+}
+static UA_StatusCode benchReadBrowseNameAttribute(UA_Client* client, const UA_NodeId nodeId, UA_QualifiedName* outBrowseName) {
+    benchRequests++;
+    return UA_Client_readBrowseNameAttribute(client, nodeId, outBrowseName);
+}
+static UA_StatusCode benchReadDataTypeAttribute(UA_Client* client, const UA_NodeId nodeId, UA_NodeId* outDataType) {
+    benchRequests++;
+    return UA_Client_readDataTypeAttribute(client, nodeId, outDataType);
+}
+#define UA_Client_Service_read benchServiceRead
+#define UA_Client_Service_browse benchServiceBrowse
+#define UA_Client_Service_browseNext benchServiceBrowseNext
+#define UA_Client_readValueAttribute benchReadValueAttribute
+#define UA_Client_readNodeClassAttribute benchReadNodeClassAttribute
+#define UA_Client_readBrowseNameAttribute benchReadBrowseNameAttribute
+#define UA_Client_readDataTypeAttribute benchReadDataTypeAttribute
+
+// the registry is static, so the module is part of this translation unit
+#define EXTENDEDOBJECT_NO_MAIN
+#include "ExtendedObjectOpen62541.cpp"
+
+typedef struct {
+    const char* name;
+    size_t ops;
+    std::chrono::steady_clock::time_point start;
+    size_t allocations;
+    size_t requests;
+} benchmark_t;
+
+typedef struct {
+    UA_DataValue value;
+    const customTypeProperties_t* customTypeProperties; // enumerations only
+} benchValue_t;
+
+static size_t peakRssKb(void) {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PeakWorkingSetSize / 1024;
+    return 0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (size_t)usage.ru_maxrss;
+#endif
+}
+
+static void benchStart(benchmark_t* benchmark, const char* name) {
+    benchmark->name = name;
+    benchmark->ops = 0;
+    benchmark->allocations = benchAllocations;
+    benchmark->requests = benchRequests;
+    benchmark->start = std::chrono::steady_clock::now();
+}
+
+// excludes the preparation of the next operation (since start) from the time, the allocations and the requests of the benchmark
+static void benchExclude(benchmark_t* benchmark, std::chrono::steady_clock::time_point start, size_t allocations, size_t requests) {
+    benchmark->start += std::chrono::steady_clock::now() - start;
+    benchmark->allocations += benchAllocations - allocations;
+    benchmark->requests += benchRequests - requests;
+}
+
+// writes the result as JSON line, throughput is the amount of unit per second for amount per operation
+static void benchStop(benchmark_t* benchmark, UA_Double amount, const char* unit) {
+    const UA_Double ns = (UA_Double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - benchmark->start).count();
+    const UA_Double ops = benchmark->ops ? (UA_Double)benchmark->ops : 1.0;
+    const UA_Double allocations = benchCountsAllocations ? (UA_Double)(benchAllocations - benchmark->allocations) / ops : -1.0;
+    fprintf(benchResults, "{\"benchmark\":\"%s\",\"ops\":%zu,\"ns_per_op\":%.1f,\"allocs_per_op\":%.2f,\"requests_per_op\":%.2f,\"throughput\":%.3f,\"unit\":\"%s\",\"peak_rss_kb\":%zu}\n",
+           benchmark->name, benchmark->ops, ns / ops, allocations, (UA_Double)(benchRequests - benchmark->requests) / ops,
+           ns > 0 ? amount * ops * 1e9 / ns : 0.0, unit, peakRssKb());
+    fflush(benchResults);
+}
+
+static UA_StatusCode collectValue(void* context, const UA_NodeId* nodeId, const UA_NodeId* dataTypeId, UA_DataValue* value) {
+    std::vector<benchValue_t>* values = (std::vector<benchValue_t>*)context;
+    benchValue_t benchValue;
+    benchValue.customTypeProperties = findCustomTypeProperties(dataTypeId);
+    benchValue.value = *value;
+    UA_DataValue_init(value);
+    values->push_back(benchValue);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode discardValue(void* context, const UA_NodeId* nodeId, const UA_NodeId* dataTypeId, UA_DataValue* value) {
+    return UA_STATUSCODE_GOOD;
+}
+
+// initializeCustomDataTypes: wall time and requests per discovery of the whole type system
+static void benchDiscovery(UA_Client* client, size_t repeats) {
+    benchmark_t benchmark;
+    std::string name;
+    benchStart(&benchmark, "initializeCustomDataTypes");
+    for (; benchmark.ops < repeats; benchmark.ops++) {
+        // the client must not decode with the freed types
+        UA_Client_getConfig(client)->customDataTypes = 0x0;
+        clearCustomDataTypes();
+        initializeCustomDataTypes(client);
+    }
+    name = "initializeCustomDataTypes/types=" + std::to_string(numberOfCustomDataTypes);
+    benchmark.name = name.c_str();
+    benchStop(&benchmark, 1.0, "discoveries/s");
+}
+
+// parseXml: dictionary throughput, every repeat parses into a new registry of the discovered types
+// (the discovery before each repeat is not measured), the client gets the registry of the last repeat
+static void benchParseXml(UA_Client* client, size_t repeats) {
+    std::map<UA_UInt32, std::string> dictionaries;
+    benchmark_t benchmark;
+    size_t bytes = 0;
+    getDictionaries(client, &dictionaries);
+    for (const std::pair<const UA_UInt32, std::string>& dictionary : dictionaries)
+        bytes += dictionary.second.length();
+    benchStart(&benchmark, "parseXml");
+    for (; benchmark.ops < repeats; benchmark.ops++) {
+        const std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+        const size_t allocations = benchAllocations;
+        const size_t requests = benchRequests;
+        UA_Client_getConfig(client)->customDataTypes = 0x0;
+        clearCustomDataTypes();
+        scan4BaseDataTypes(client);
+        benchExclude(&benchmark, started, allocations, requests);
+        parseXml(&dictionaries);
+    }
+    benchStop(&benchmark, (UA_Double)bytes / 1e6, "MB/s");
+    if (repeats && linkCustomDataTypes() == UA_STATUSCODE_GOOD)
+        UA_Client_getConfig(client)->customDataTypes = customDataTypes;
+}
+
+// decoding of custom ExtensionObjects, scalar and as array of 100 values
+static void benchDecode(const std::vector<benchValue_t>& values, size_t repeats) {
+    std::vector<UA_ByteString> scalars;
+    std::vector<UA_ByteString> arrays;
+    benchmark_t benchmark;
+    UA_Variant decoded;
+
+    for (const benchValue_t& benchValue : values) {
+        const UA_Variant* value = &benchValue.value.value;
+        UA_ByteString encoded;
+        UA_Variant array;
+        if (!value->type || !UA_Variant_isScalar(value) || !findCustomTypeProperties(&value->type->typeId) || value->type->typeKind == UA_DATATYPEKIND_ENUM)
+            continue;
+        UA_ByteString_init(&encoded);
+        if (UA_encodeBinary(value, &UA_TYPES[UA_TYPES_VARIANT], &encoded) == UA_STATUSCODE_GOOD)
+            scalars.push_back(encoded);
+        std::vector<UA_Byte> elements(100 * value->type->memSize);
+        for (size_t i = 0; i < 100; i++)
+            memcpy(&elements[i * value->type->memSize], value->data, value->type->memSize);
+        // shallow copies of the scalar, the array is not cleared
+        UA_Variant_setArray(&array, elements.data(), 100, value->type);
+        UA_ByteString_init(&encoded);
+        if (UA_encodeBinary(&array, &UA_TYPES[UA_TYPES_VARIANT], &encoded) == UA_STATUSCODE_GOOD)
+            arrays.push_back(encoded);
+    }
+    if (scalars.empty())
+        return;
+    benchStart(&benchmark, "decode/scalar");
+    for (size_t r = 0; r < repeats; r++) {
+        for (const UA_ByteString& encoded : scalars) {
+            size_t offset = 0;
+            UA_decodeBinary(&encoded, &offset, &decoded, &UA_TYPES[UA_TYPES_VARIANT], customDataTypes);
+            UA_Variant_clear(&decoded);
+            benchmark.ops++;
+        }
+    }
+    benchStop(&benchmark, 1.0, "values/s");
+    benchStart(&benchmark, "decode/array100");
+    for (size_t r = 0; r < repeats; r++) {
+        for (const UA_ByteString& encoded : arrays) {
+            size_t offset = 0;
+            UA_decodeBinary(&encoded, &offset, &decoded, &UA_TYPES[UA_TYPES_VARIANT], customDataTypes);
+            UA_Variant_clear(&decoded);
+            benchmark.ops++;
+        }
+    }
+    benchStop(&benchmark, 100.0, "values/s");
+    for (UA_ByteString& encoded : scalars)
+        UA_ByteString_clear(&encoded);
+    for (UA_ByteString& encoded : arrays)
+        UA_ByteString_clear(&encoded);
+}
+
+// UA_PrintStructure, UA_PrintUnion and UA_PrintEnum: values per second and allocations per value
+static void benchPrint(const std::vector<benchValue_t>& values, size_t repeats) {
+    const UA_UInt32 typeKinds[3] = { UA_DATATYPEKIND_STRUCTURE, UA_DATATYPEKIND_UNION, UA_DATATYPEKIND_ENUM };
+    const char* names[3] = { "UA_PrintStructure", "UA_PrintUnion", "UA_PrintEnum" };
+    benchmark_t benchmark;
+    UA_String output;
+
+    for (size_t k = 0; k < 3; k++) {
+        benchStart(&benchmark, names[k]);
+        for (size_t r = 0; r < repeats; r++) {
+            for (const benchValue_t& benchValue : values) {
+                const UA_Variant* value = &benchValue.value.value;
+                UA_StatusCode retval;
+                if (!value->type)
+                    continue;
+                UA_String_init(&output);
+                if (typeKinds[k] == UA_DATATYPEKIND_ENUM) {
+                    if (!benchValue.customTypeProperties || benchValue.customTypeProperties->dataType.typeKind != UA_DATATYPEKIND_ENUM)
+                        continue;
+                    retval = UA_PrintEnum(value, (customTypeProperties_t*)benchValue.customTypeProperties, &output);
+                }
+                else if (typeKinds[k] == UA_DATATYPEKIND_UNION) {
+                    if (value->type->typeKind != UA_DATATYPEKIND_UNION)
+                        continue;
+                    retval = UA_PrintUnion(value, &output);
+                }
+                else {
+                    if (value->type->typeKind != UA_DATATYPEKIND_STRUCTURE && value->type->typeKind != UA_DATATYPEKIND_OPTSTRUCT)
+                        continue;
+                    retval = UA_PrintStructure(value, &output);
+                }
+                if (retval == UA_STATUSCODE_GOOD)
+                    benchmark.ops++;
+                UA_String_clear(&output);
+            }
+        }
+        if (benchmark.ops)
+            benchStop(&benchmark, 1.0, "values/s");
+    }
+}
+
+// UA_ReadValues: batched reads of all variables on the server
+static void benchRead(UA_Client* client, const std::vector<UA_NodeId>& variableIds, size_t repeats) {
+    benchmark_t benchmark;
+    benchStart(&benchmark, "UA_ReadValues");
+    for (size_t r = 0; r < repeats; r++) {
+        UA_ReadValues(client, variableIds.data(), variableIds.size(), discardValue, 0x0);
+        benchmark.ops += variableIds.size();
+    }
+    benchStop(&benchmark, 1.0, "values/s");
+}
+
+int main(int argc, char* argv[]) {
+    const char* uaUrl = "opc.tcp://localhost:4840";
+    const char* parentId = "ns=2;i=90"; // folder of the first test namespace of ExtendedObjectTestServer
+    size_t repeats = 10;
+    std::vector<UA_NodeId> variableIds;
+    std::vector<benchValue_t> values;
+    UA_Client* client;
+    UA_NodeId nodeId;
+    UA_StatusCode retval;
+
+    if (argc > 1) uaUrl = argv[1];
+    if (argc > 2) parentId = argv[2];
+    if (argc > 3) repeats = strtoul(argv[3], 0x0, 10);
+    benchResults = argc > 4 ? fopen(argv[4], "w") : stdout;
+    if (!benchResults) {
+        fprintf(stderr, "Could not open %s\n", argv[4]);
+        return EXIT_FAILURE;
+    }
+
+    client = UA_Client_new();
+    UA_ClientConfig_setDefault(UA_Client_getConfig(client));
+    retval = UA_Client_connect(client, uaUrl);
+    if (retval != UA_STATUSCODE_GOOD) {
+        fprintf(stderr, "Could not open OPC UA client session to %s. (%s)\n", uaUrl, UA_StatusCode_name(retval));
+        UA_Client_delete(client);
+        if (benchResults != stdout)
+            fclose(benchResults);
+        return EXIT_FAILURE;
+    }
+    benchDiscovery(client, repeats);
+    benchParseXml(client, repeats);
+
+    retval = UA_NodeId_parse(&nodeId, UA_STRING((char*)parentId));
+    if (retval == UA_STATUSCODE_GOOD)
+        retval = scan4Variables(client, nodeId, &variableIds);
+    if (retval != UA_STATUSCODE_GOOD)
+        fprintf(stderr, "Could not retrieve variable node IDs from parent ID %s. (%s)\n", parentId, UA_StatusCode_name(retval));
+    UA_NodeId_clear(&nodeId);
+    UA_ReadValues(client, variableIds.data(), variableIds.size(), collectValue, &values);
+    benchDecode(values, repeats);
+    benchPrint(values, repeats);
+    benchRead(client, variableIds, repeats);
+
+    for (benchValue_t& benchValue : values)
+        UA_DataValue_clear(&benchValue.value);
+    for (UA_NodeId& variableId : variableIds)
+        UA_NodeId_clear(&variableId);
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+    clearCustomDataTypes();
+    if (benchResults != stdout)
+        fclose(benchResults);
+    return EXIT_SUCCESS;
+}
@@ -29,6 +29,7 @@
 
 #include <open62541/client_config_default.h>
 #include <open62541/client_highlevel.h>
+#include <open62541/client_subscriptions.h>
 #include <open62541/plugin/log_stdout.h>
 
 #include <libxml/parser.h> 
@@ -36,11 +37,31 @@
 #include <libxml/xpath.h>
 #include <libxml/xpathInternals.h>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
 #include <map>
 #include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "ExtendedObjectOpen62541.h"
@@ -50,18 +71,58 @@
 #define MEMORY_BANK_SIZE 4
 //#undef UA_ENABLE_TYPEDESCRIPTION // for compatibility check only
 
-static const UA_DataType* parseDataType(std::string text);
+static const UA_DataType* parseDataType(xmlNode* node, const std::string& text);
 static const UA_UInt32 ADDRESS_SIZE = sizeof(void*);
 static std::string byteStringToString(UA_ByteString* bytes);
 static UA_Boolean isOptionSet(const UA_NodeId* subTypeNodeId);
+static UA_Boolean isRegistryMapped(void);
+static void forEachShard(size_t workers, size_t size, const std::function<void(size_t, size_t, size_t)>& worker);
+static UA_StatusCode linkCustomDataTypes(void);
 static UA_PrintOutput* UA_PrintContext_addOutput(UA_PrintContext* ctx, size_t length);
+static void metricsCount(UA_CounterId counter, UA_UInt64 value);
+static void metricsCountTypes(void);
+static void metricsRecord(UA_HistogramId histogram, UA_UInt64 start);
+static void metricsRecordPrint(UA_UInt64 start, const UA_NodeId* dataTypeId, const UA_Variant* data);
+static void metricsRecordResponse(UA_HistogramId histogram, UA_UInt64 start, const void* response, const UA_DataType* type);
+static UA_UInt64 metricsStart(void);
+static void profileAddWorkers(UA_UInt64 childTime, UA_UInt64 allocations);
+static UA_UInt64 profileArraySize(const void* p, size_t length, const UA_DataType* type);
+static UA_Boolean profileAttach(const std::string& parentPath);
+static void profileCountAllocation(void);
+static void profileDecode(const UA_ReadResponse* readResponse, const UA_PublishResponse* publishResponse, UA_UInt64 decodeTime);
+static void profileDetach(std::atomic<UA_UInt64>* childTime, std::atomic<UA_UInt64>* allocations);
+static UA_Boolean profileEnterArray(const UA_DataType* type);
+static UA_Boolean profileEnterMember(const UA_DataType* type, size_t index);
+static UA_Boolean profileEnterType(const UA_DataType* type);
+static void profileLeave(UA_UInt64 bytes);
+static std::string profileParentPath(void);
+static UA_UInt64 profileMemberSize(const UA_DataTypeMember* member, const void* p);
 UA_StatusCode parseXml(std::map<UA_UInt32, std::string>* dictionaries);
+static void recordMonitoredValues(const UA_Monitor* monitor);
+static void recordReadResponse(const UA_NodeId* nodeIds, size_t nodeIdsSize, const UA_ReadResponse* response);
+static void releaseRegistryImage(void);
 UA_StatusCode printUInt32(UA_PrintContext* ctx, UA_UInt32 p, UA_UInt32 width = 0, UA_Boolean isHex = false);
-UA_StatusCode scan4BaseDataTypes(UA_Client* client);
+UA_StatusCode scan4BaseDataTypes(UA_Client* client, const UA_DiscoveryConfig* discoveryConfig = 0x0);
+UA_StatusCode scan4Variables(UA_Client* client, UA_NodeId parentNode, std::vector<UA_NodeId>* variableIds, UA_UInt32 maxDepth = 0, size_t maxNodes = 0);
 UA_StatusCode UA_PrintContext_addNewlineTabs(UA_PrintContext* ctx, size_t tabs);
 UA_StatusCode UA_PrintContext_addString(UA_PrintContext* ctx, const char* str);
 void scanForTypeIds(UA_BrowseResponse* bResp, std::vector<UA_NodeId>* dataTypeIds, std::vector<UA_NodeId>* cutomDataTypeIds);
 void UA_PrintTypeKind(UA_UInt32 typeKind, UA_String* out);
+static UA_Int64 traceBegin(void);
+static void traceEnd(UA_Int64 start, const char* category, const char* name, const char* detail = 0x0);
+static std::string traceNodeId(const UA_NodeId* nodeId);
+static void traceSetSession(size_t session);
+
+// span of the trace (see UA_Trace_start), the span is written when the scope ends
+typedef struct traceSpan_t {
+    const char* category;
+    const char* name;
+    std::string detail; // argument of the span (optional)
+    UA_Int64 start;
+    traceSpan_t(const char* category, const char* name) : category(category), name(name), start(traceBegin()) {}
+    ~traceSpan_t() { traceEnd(start, category, name, detail.c_str()); }
+    UA_Boolean active(void) const { return start >= 0; }
+} traceSpan_t;
 
 // https://www.programmingalgorithms.com/algorithm/sdbm-hash/cpp/
 UA_UInt32 UA_ByteString_SDBMHash(UA_UInt32 fnv, const UA_Byte* buf, size_t size) {
@@ -108,7 +169,12 @@ UA_StatusCode browseNodeId(UA_Client* client, UA_NodeId nodeId, UA_BrowseRespons
     UA_NodeId_copy(&nodeId, &bReq.nodesToBrowse[0].nodeId);
     bReq.nodesToBrowse[0].resultMask = UA_BROWSERESULTMASK_ALL; /* return everything */
     bReq.nodesToBrowse[0].browseDirection = UA_BROWSEDIRECTION_BOTH;
+    UA_UInt64 started = metricsStart();
+    UA_Int64 traced = traceBegin();
     *bResp = UA_Client_Service_browse(client, bReq);
+    metricsRecordResponse(UA_HISTOGRAM_BROWSE, started, bResp, &UA_TYPES[UA_TYPES_BROWSERESPONSE]);
+    if (traced >= 0)
+        traceEnd(traced, "network", "Browse", traceNodeId(&nodeId).c_str());
     UA_BrowseRequest_clear(&bReq);
     return UA_STATUSCODE_GOOD;
 }
@@ -188,12 +254,155 @@ UA_UInt32 calc_struct_padding(UA_DataType* dataType) {
     return size;
 }
 
+// interned strings of the registry (type, member, enumeration and option set names), index 0 is the empty string
+// the characters are stored once in blocks which are never moved, typeName and memberName point into them
+#define REGISTRY_STRING_BLOCK_SIZE 65536
+static std::mutex registryMutex; // sessions of the discovery add strings and tables concurrently
+static std::vector<char*> registryStringBlocks; // all blocks including the ones of long strings (freed by clearRegistryStrings)
+static char* registryStringBlock = 0x0; // current block of the short strings
+static size_t registryStringBlockUsed;
+static std::deque<UA_String> registryStrings;
+static std::unordered_map<std::string_view, UA_UInt32> registryStringIndexes;
+
+// subfunction of internRegistryString and internRegistryName, registryMutex has to be locked
+static UA_UInt32 registryStringIndex(const char* data, size_t length, UA_Boolean borrowed) {
+    UA_String registryString = UA_STRING_NULL;
+    if (registryStrings.empty()) {
+        registryString.data = (UA_Byte*)"";
+        registryStrings.push_back(registryString);
+    }
+    if (!data || !length)
+        return 0;
+    std::unordered_map<std::string_view, UA_UInt32>::iterator indexIt = registryStringIndexes.find(std::string_view(data, length));
+    if (indexIt != registryStringIndexes.end())
+        return indexIt->second;
+    if (!borrowed) {
+        char* copy;
+        // long strings get a block of their own, the current block is continued
+        if (length + 1 > REGISTRY_STRING_BLOCK_SIZE / 4) {
+            copy = (char*)UA_malloc(length + 1);
+            if (copy)
+                registryStringBlocks.push_back(copy);
+        }
+        else if (registryStringBlock && registryStringBlockUsed + length + 1 <= REGISTRY_STRING_BLOCK_SIZE) {
+            copy = registryStringBlock + registryStringBlockUsed;
+            registryStringBlockUsed += length + 1;
+        }
+        else {
+            copy = (char*)UA_malloc(REGISTRY_STRING_BLOCK_SIZE);
+            if (copy) {
+                registryStringBlocks.push_back(copy);
+                registryStringBlock = copy;
+                registryStringBlockUsed = length + 1;
+            }
+        }
+        if (!copy) {
+            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "registryStringIndex: Could not allocate memory for a name");
+            return 0;
+        }
+        memcpy(copy, data, length);
+        copy[length] = 0;
+        data = copy;
+    }
+    registryString.length = length;
+    registryString.data = (UA_Byte*)data;
+    registryStrings.push_back(registryString);
+    registryStringIndexes.emplace(std::string_view(data, length), (UA_UInt32)(registryStrings.size() - 1));
+    return (UA_UInt32)(registryStrings.size() - 1);
+}
+
+// returns the index of the interned string, borrowed strings have to be zero-terminated and stay valid until clearCustomDataTypes
+// (e.g. strings of the registry image), they are not copied
+static UA_UInt32 internRegistryString(const char* data, size_t length, UA_Boolean borrowed = false) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return registryStringIndex(data, length, borrowed);
+}
+
+// returns the interned copy of a name for typeName and memberName
+static const char* internRegistryName(const char* name) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return (const char*)registryStrings[registryStringIndex(name, name ? strlen(name) : 0, false)].data;
+}
+
+// returns an interned string, the registry is only read after initialization (no lock)
+static const UA_String* registryString(UA_UInt32 index) {
+    static const UA_String empty = UA_STRING_NULL;
+    return index < registryStrings.size() ? &registryStrings[index] : &empty;
+}
+
+// frees the interned strings
+static void clearRegistryStrings(void) {
+    for (char* block : registryStringBlocks)
+        UA_free(block);
+    registryStringBlocks.clear();
+    registryStringBlock = 0x0;
+    registryStringBlockUsed = 0;
+    registryStrings.clear();
+    registryStringIndexes.clear();
+}
+
+// stores the enumeration values of a custom data type as one range of the registry tables
+static void setEnumValues(customTypeProperties_t* customTypeProperties, const std::vector<UA_Int64>& values, const std::vector<UA_UInt32>& names) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    customTypeProperties->enumValuesIndex = (UA_UInt32)registryEnumValues.size();
+    customTypeProperties->enumValuesSize = (UA_UInt32)values.size();
+    registryEnumValues.insert(registryEnumValues.end(), values.begin(), values.end());
+    registryEnumNames.insert(registryEnumNames.end(), names.begin(), names.end());
+}
+
+// stores the names of the option set bits of a custom data type (bit 0 first) as one range of registryOptionBits
+static void setOptionBits(customTypeProperties_t* customTypeProperties, const std::vector<UA_UInt32>& names) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    customTypeProperties->optionBitsIndex = (UA_UInt32)registryOptionBits.size();
+    customTypeProperties->optionBitsSize = (UA_UInt32)names.size();
+    registryOptionBits.insert(registryOptionBits.end(), names.begin(), names.end());
+}
+
+// value of the index-th enumeration value of a custom data type
+static UA_Int64 getEnumValue(const customTypeProperties_t* customTypeProperties, size_t index) {
+    return registryEnumValues[customTypeProperties->enumValuesIndex + index];
+}
+
+// display name of the index-th enumeration value of a custom data type
+static const UA_String* getEnumValueName(const customTypeProperties_t* customTypeProperties, size_t index) {
+    return registryString(registryEnumNames[customTypeProperties->enumValuesIndex + index]);
+}
+
+// returns the display name of an enumeration value or 0x0 if the value is not declared
+static const UA_String* findEnumValueName(const customTypeProperties_t* customTypeProperties, UA_Int64 value) {
+    if (!customTypeProperties)
+        return 0x0;
+    const UA_Int64* values = registryEnumValues.data() + customTypeProperties->enumValuesIndex;
+    for (UA_UInt32 i = 0; i < customTypeProperties->enumValuesSize; i++) {
+        if (values[i] == value)
+            return getEnumValueName(customTypeProperties, i);
+    }
+    return 0x0;
+}
+
+// name of a bit of an option set
+static const UA_String* getOptionBitName(const customTypeProperties_t* customTypeProperties, size_t bit) {
+    return registryString(registryOptionBits[customTypeProperties->optionBitsIndex + bit]);
+}
+
 // initializes the structure customTypeProperties_t
 void customTypePropertiesInit(customTypeProperties_t* customTypeProperties, const UA_NodeId* customDataTypeId) {
-    memset(&customTypeProperties->dataType, 0x0, sizeof(UA_DataType));
+    memset(customTypeProperties, 0x0, sizeof(customTypeProperties_t));
     UA_NodeId_copy(customDataTypeId, &customTypeProperties->dataType.typeId);
 }
 
+// frees the content of the structure customTypeProperties_t
+// names are interned, enumeration values and option set bits are ranges of the registry tables (see clearCustomDataTypes)
+static void customTypePropertiesClear(customTypeProperties_t* customTypeProperties) {
+    // the members and node IDs of a mapped type point into the registry image
+    if (customTypeProperties->isMapped)
+        return;
+    UA_free(customTypeProperties->dataType.members);
+    UA_NodeId_clear(&customTypeProperties->dataType.typeId);
+    UA_NodeId_clear(&customTypeProperties->dataType.binaryEncodingId);
+    UA_NodeId_clear(&customTypeProperties->subTypeOfId);
+}
+
 // source: https://stackoverflow.com/questions/23943728/case-insensitive-standard-string-comparison-in-c
 static UA_Boolean exo_compare_pred(unsigned char a, unsigned char b) {
     return std::tolower(a) == std::tolower(b);
@@ -266,6 +475,7 @@ UA_StatusCode getDictionaries(UA_Client* client, std::map<UA_UInt32, std::string
         return UA_STATUSCODE_BADUNEXPECTEDERROR;
     }
     UA_LOG_DEBUG(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "getDictionaries: retrieve OPC UA dictionaries in progress ...");
+    traceSpan_t span("discovery", "getDictionaries");
     dictionaries->clear();
     retval = browseNodeId(client, UA_NODEID_NUMERIC(0, UA_NS0ID_OPCBINARYSCHEMA_TYPESYSTEM), &bResp);
     for (size_t i = 0; (retval == UA_STATUSCODE_GOOD) && i < bResp.resultsSize; ++i) {
@@ -273,7 +483,12 @@ UA_StatusCode getDictionaries(UA_Client* client, std::map<UA_UInt32, std::string
             rDesc = bResp.results[i].references[j];
             nameSpaceIndex = rDesc.nodeId.nodeId.namespaceIndex;
             if (nameSpaceIndex != 0) {
+                UA_UInt64 started = metricsStart();
+                UA_Int64 traced = traceBegin();
                 retval = UA_Client_readValueAttribute(client, rDesc.nodeId.nodeId, &outValue);
+                metricsRecord(UA_HISTOGRAM_READ, started);
+                if (traced >= 0)
+                    traceEnd(traced, "network", "Read dictionary", ("ns=" + std::to_string(nameSpaceIndex)).c_str());
                 if ((retval == UA_STATUSCODE_GOOD) && (outValue.type == &UA_TYPES[UA_TYPES_BYTESTRING])) {
                     std::string rawDictionary = byteStringToString((UA_ByteString*)outValue.data);
                     dictionaryIt = dictionaries->find(nameSpaceIndex);
@@ -312,14 +527,14 @@ UA_StatusCode getDictionaries(UA_Client* client, std::map<UA_UInt32, std::string
     return retval;
 }
 
-// converts dictionary data type tag to OPC data type address (generated open62541 data types)
+// converts dictionary data type tag of a field node to OPC data type address (generated open62541 data types)
 // checks for sub data types
-const UA_DataType* getMemberDataType(std::string typeName) {
+const UA_DataType* getMemberDataType(xmlNode* node, std::string typeName) {
     const UA_DataType* memberDataType = 0x0;
     std::size_t found;
     if (typeName.empty())
         return memberDataType;
-    memberDataType = parseDataType(typeName);
+    memberDataType = parseDataType(node, typeName);
     if (!memberDataType) {
         found = typeName.find_first_of(':');
         if (found != std::string::npos)
@@ -346,16 +561,12 @@ void getSubTypeProperties(UA_NodeId* subTypeNodeId, customTypeProperties_t* cust
             memset(&customTypeProperties->dataType.members[0], 0x0, sizeof(UA_DataTypeMember));
             customTypeProperties->dataType.members[0].memberType = &UA_TYPES[UA_TYPES_BYTESTRING];
 #ifdef UA_ENABLE_TYPEDESCRIPTION
-            customTypeProperties->dataType.members[0].memberName = (char*)UA_malloc(6 * sizeof(char));
-            if (customTypeProperties->dataType.members[0].memberName)
-                strcpy((char*)customTypeProperties->dataType.members[0].memberName, "Value");
+            customTypeProperties->dataType.members[0].memberName = internRegistryName("Value");
 #endif
             memset(&customTypeProperties->dataType.members[1], 0x0, sizeof(UA_DataTypeMember));
             customTypeProperties->dataType.members[1].memberType = &UA_TYPES[UA_TYPES_BYTESTRING];
 #ifdef UA_ENABLE_TYPEDESCRIPTION
-            customTypeProperties->dataType.members[1].memberName = (char*)UA_malloc(10 * sizeof(char));
-            if (customTypeProperties->dataType.members[1].memberName)
-                strcpy((char*)customTypeProperties->dataType.members[1].memberName, "ValidBits");
+            customTypeProperties->dataType.members[1].memberName = internRegistryName("ValidBits");
 #endif
         }
         else {
@@ -404,7 +615,8 @@ static std::string getXmlPropery(xmlNode* node, const char* name) {
 }
 
 // search for and implement custom data types of the server
-UA_StatusCode initializeCustomDataTypes(UA_Client* client) {
+// discoveryConfig (optional) enables the parallel type discovery with additional sessions
+UA_StatusCode initializeCustomDataTypes(UA_Client* client, const UA_DiscoveryConfig* discoveryConfig) {
     UA_StatusCode retval;
     std::map<UA_UInt32, std::string> dictionaries;
     std::map<UA_UInt32, xmlDocPtr> xmlDocMap;
@@ -413,9 +625,16 @@ UA_StatusCode initializeCustomDataTypes(UA_Client* client) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "initializeCustomDataTypes: Client session invalid");
         return UA_STATUSCODE_BADUNEXPECTEDERROR;
     }
+    // the members of a loaded registry image are read-only
+    if (isRegistryMapped()) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "initializeCustomDataTypes: A registry image is loaded, call clearCustomDataTypes first");
+        return UA_STATUSCODE_BADINVALIDSTATE;
+    }
+    traceSetSession(0);
+    traceSpan_t span("discovery", "initializeCustomDataTypes");
 
     // retrieve custom data types from the server node /Types/DataTypes/BaseDataType
-    retval = scan4BaseDataTypes(client);
+    retval = scan4BaseDataTypes(client, discoveryConfig);
     if (retval != UA_STATUSCODE_GOOD) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "initializeCustomDataTypes: Retrieve custom data types from the server node /Types/DataTypes/BaseDataType failed");
         return UA_STATUSCODE_BADUNEXPECTEDERROR;
@@ -428,9 +647,25 @@ UA_StatusCode initializeCustomDataTypes(UA_Client* client) {
         return UA_STATUSCODE_BADUNEXPECTEDERROR;
     }
 
+    UA_UInt64 started = metricsStart();
     retval = parseXml(&dictionaries);
+    metricsRecord(UA_HISTOGRAM_PARSEXML, started);
 
     // initialize client with custom data types
+    UA_Int64 traced = traceBegin();
+    if (linkCustomDataTypes() != UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    traceEnd(traced, "registry", "linkCustomDataTypes");
+    metricsCountTypes();
+    // initialize current client session with new custom data types
+    UA_Client_getConfig(client)->customDataTypes = customDataTypes;
+
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "initializeCustomDataTypes: Custom data types initialized");
+    return retval;
+}
+
+// links the data types of dataTypeMap to the array customDataTypes (custom types of decoding)
+static UA_StatusCode linkCustomDataTypes(void) {
     numberOfCustomDataTypes = (UA_UInt32)dataTypeMap.size();
     customDataTypes = (UA_DataTypeArray*)UA_malloc(numberOfCustomDataTypes * sizeof(UA_DataTypeArray));
     if (!customDataTypes) {
@@ -450,11 +685,25 @@ UA_StatusCode initializeCustomDataTypes(UA_Client* client) {
             customDataTypes[i].next = 0x0;
         i++;
     }
-    // initialize current client session with new custom data types
-    UA_Client_getConfig(client)->customDataTypes = customDataTypes;
+    return UA_STATUSCODE_GOOD;
+}
 
-    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "initializeCustomDataTypes: Custom data types initialized");
-    return retval;
+// frees the custom data type registry (dataTypeMap, dataTypeNameMap, customDataTypes, the enumeration and option set tables and the names)
+// clients must not use the custom data types anymore, e.g. before initializeCustomDataTypes is called for another server
+void clearCustomDataTypes(void) {
+    for (typePropIt_t typePropIt = dataTypeMap.begin(); typePropIt != dataTypeMap.end(); typePropIt++)
+        customTypePropertiesClear(&typePropIt->second);
+    dataTypeMap.clear();
+    dataTypeNameMap.clear();
+    UA_free(customDataTypes);
+    customDataTypes = 0x0;
+    numberOfCustomDataTypes = 0;
+    std::vector<UA_Int64>().swap(registryEnumValues);
+    std::vector<UA_UInt32>().swap(registryEnumNames);
+    std::vector<UA_UInt32>().swap(registryOptionBits);
+    // borrowed strings point into the image
+    clearRegistryStrings();
+    releaseRegistryImage();
 }
 
 // checks whether the SubTypeID is equal to the OptionSetID
@@ -462,62 +711,188 @@ static UA_Boolean isOptionSet(const UA_NodeId* subTypeNodeId) {
     return UA_NodeId_equal(subTypeNodeId, &NS0ID_OPTIONSET);
 }
 
+// namespace of the prefix of a TypeName attribute (xmlns declarations of the dictionary)
+#define DICTIONARY_NAMESPACE_OTHER 0x00 // target namespace of the dictionary (custom data types) or unknown
+#define DICTIONARY_NAMESPACE_BINARYSCHEMA 0x01 // http://opcfoundation.org/BinarySchema/ (usually opc:)
+#define DICTIONARY_NAMESPACE_UA 0x02 // http://opcfoundation.org/UA/ (usually ua:)
+
+// built-in type names of the dictionaries
+typedef struct {
+    const char* name;
+    UA_Int16 typeIndex; // index in UA_TYPES, -1 = no data type (opc:Bit is used for bit masks only)
+    UA_Byte namespaces; // namespaces which define the name
+} builtinTypeName_t;
+
+static constexpr builtinTypeName_t builtinTypeNames[] = {
+    { "Bit", -1, DICTIONARY_NAMESPACE_BINARYSCHEMA },
+    { "Boolean", UA_TYPES_BOOLEAN, DICTIONARY_NAMESPACE_BINARYSCHEMA | DICTIONARY_NAMESPACE_UA },
+    { "SByte", UA_TYPES_SBYTE, DICTIONARY_NAMESPACE_BINARYSCHEMA | DICTIONARY_NAMESPACE_UA },
+    { "Byte", UA_TYPES_BYTE, DICTIONARY_NAMESPACE_BINARYSCHEMA | DICTIONARY_NAMESPACE_UA },
+    { "Int16", UA_TYPES_INT16, DICTIONARY_NAMESPACE_BINARYSCHEMA | DICTIONARY_NAMESPACE_UA },
+    { "UInt16", UA_TYPES_UINT16, DICTIONARY_NAMESPACE_BINARYSCHEMA | DICTIONARY_NAMESPACE_UA },
+    { "Int32", UA_TYPES_INT32, DICTIONARY_NAMESPACE_BINARYSCHEMA | DICTIONARY_NAMESPACE_UA },
+    { "UInt32", UA_TYPES_UINT32, DICTIONARY_NAMESPACE_BINARYSCHEMA | DICTIONARY_NAMESPACE_UA },
+    { "Int64", UA_TYPES_INT64, DICTIONARY_NAMESPACE_BINARYSCHEMA | DICTIONARY_NAMESPACE_UA },
+    { "UInt64", UA_TYPES_UINT64, DICTIONARY_NAMESPACE_BINARYSCHEMA | DICTIONARY_NAMESPACE_UA },
+    { "Float", UA_TYPES_FLOAT, DICTIONARY_NAMESPACE_BINARYSCHEMA | DICTIONARY_NAMESPACE_UA },
+    { "Double", UA_TYPES_DOUBLE, DICTIONARY_NAMESPACE_BINARYSCHEMA | DICTIONARY_NAMESPACE_UA },
+    { "String", UA_TYPES_STRING, DICTIONARY_NAMESPACE_BINARYSCHEMA | DICTIONARY_NAMESPACE_UA },
+    { "CharArray", UA_TYPES_STRING, DICTIONARY_NAMESPACE_BINARYSCHEMA },
+    { "DateTime", UA_TYPES_DATETIME, DICTIONARY_NAMESPACE_BINARYSCHEMA | DICTIONARY_NAMESPACE_UA },
+    { "Guid", UA_TYPES_GUID, DICTIONARY_NAMESPACE_BINARYSCHEMA | DICTIONARY_NAMESPACE_UA },
+    { "ByteString", UA_TYPES_BYTESTRING, DICTIONARY_NAMESPACE_BINARYSCHEMA | DICTIONARY_NAMESPACE_UA },
+    { "XmlElement", UA_TYPES_XMLELEMENT, DICTIONARY_NAMESPACE_UA },
+    { "NodeId", UA_TYPES_NODEID, DICTIONARY_NAMESPACE_UA },
+    { "ExpandedNodeId", UA_TYPES_EXPANDEDNODEID, DICTIONARY_NAMESPACE_UA },
+    { "StatusCode", UA_TYPES_STATUSCODE, DICTIONARY_NAMESPACE_UA },
+    { "QualifiedName", UA_TYPES_QUALIFIEDNAME, DICTIONARY_NAMESPACE_UA },
+    { "LocalizedText", UA_TYPES_LOCALIZEDTEXT, DICTIONARY_NAMESPACE_UA },
+    { "ExtensionObject", UA_TYPES_EXTENSIONOBJECT, DICTIONARY_NAMESPACE_UA },
+    { "DataValue", UA_TYPES_DATAVALUE, DICTIONARY_NAMESPACE_UA },
+    { "Variant", UA_TYPES_VARIANT, DICTIONARY_NAMESPACE_UA },
+    { "DiagnosticInfo", UA_TYPES_DIAGNOSTICINFO, DICTIONARY_NAMESPACE_UA },
+};
+static constexpr size_t BUILTIN_TYPE_NAMES_SIZE = sizeof(builtinTypeNames) / sizeof(builtinTypeNames[0]);
+#define BUILTIN_TYPE_NAME_SLOTBITS 7
+#define BUILTIN_TYPE_NAME_SLOTS (1 << BUILTIN_TYPE_NAME_SLOTBITS) // at least twice the number of names
+
+// case-insensitive FNV-1a hash of a type name (the names are compared case-insensitive like exo_compare)
+static constexpr UA_UInt32 hashTypeName(const char* data, size_t length, UA_UInt32 seed) {
+    UA_UInt32 hash = 2166136261u ^ seed;
+    for (size_t i = 0; i < length; i++) {
+        char c = data[i];
+        if (c >= 'A' && c <= 'Z')
+            c = (char)(c - 'A' + 'a');
+        hash = (hash ^ (UA_Byte)c) * 16777619u;
+    }
+    return hash;
+}
+
+// slot of a hash in the perfect hash table, the high bits depend on all bits of the seed
+static constexpr UA_UInt32 builtinTypeNameSlot(UA_UInt32 hash) {
+    return hash >> (32 - BUILTIN_TYPE_NAME_SLOTBITS);
+}
+
+static constexpr size_t constexprStrlen(const char* str) {
+    size_t length = 0;
+    while (str[length])
+        length++;
+    return length;
+}
+
+// finds (at compile time) the first seed which maps all built-in type names to different slots
+static constexpr UA_UInt32 findBuiltinTypeNameSeed(void) {
+    for (UA_UInt32 seed = 0;; seed++) {
+        UA_Boolean used[BUILTIN_TYPE_NAME_SLOTS] = {};
+        size_t i = 0;
+        for (; i < BUILTIN_TYPE_NAMES_SIZE; i++) {
+            UA_UInt32 slot = builtinTypeNameSlot(hashTypeName(builtinTypeNames[i].name, constexprStrlen(builtinTypeNames[i].name), seed));
+            if (used[slot])
+                break;
+            used[slot] = true;
+        }
+        if (i == BUILTIN_TYPE_NAMES_SIZE)
+            return seed;
+    }
+}
+static constexpr UA_UInt32 builtinTypeNameSeed = findBuiltinTypeNameSeed();
+
+// perfect hash table: slot -> index in builtinTypeNames + 1 (0 = empty slot)
+typedef struct {
+    UA_Byte entries[BUILTIN_TYPE_NAME_SLOTS];
+} builtinTypeNameSlots_t;
+
+static constexpr builtinTypeNameSlots_t buildBuiltinTypeNameSlots(void) {
+    builtinTypeNameSlots_t slots = {};
+    for (size_t i = 0; i < BUILTIN_TYPE_NAMES_SIZE; i++)
+        slots.entries[builtinTypeNameSlot(hashTypeName(builtinTypeNames[i].name, constexprStrlen(builtinTypeNames[i].name), builtinTypeNameSeed))] = (UA_Byte)(i + 1);
+    return slots;
+}
+static constexpr builtinTypeNameSlots_t builtinTypeNameSlots = buildBuiltinTypeNameSlots();
+static_assert(BUILTIN_TYPE_NAMES_SIZE * 2 <= BUILTIN_TYPE_NAME_SLOTS, "builtinTypeNames: BUILTIN_TYPE_NAME_SLOTS is too small");
+
+// returns the built-in type name or 0x0, one hash and one comparison
+static const builtinTypeName_t* findBuiltinTypeName(std::string_view localName) {
+    UA_Byte entry = builtinTypeNameSlots.entries[builtinTypeNameSlot(hashTypeName(localName.data(), localName.length(), builtinTypeNameSeed))];
+    if (!entry)
+        return 0x0;
+    const builtinTypeName_t* builtinTypeName = &builtinTypeNames[entry - 1];
+    if (localName.length() != constexprStrlen(builtinTypeName->name) ||
+        xmlStrncasecmp((const xmlChar*)builtinTypeName->name, (const xmlChar*)localName.data(), (int)localName.length()))
+        return 0x0;
+    return builtinTypeName;
+}
+
+// returns a generated data type of namespace 0 by its name (e.g. ua:EUInformation) or 0x0
+// the generated types depend on the build of open62541, the index is built at the first use
+static const UA_DataType* findUaDataType(std::string_view localName) {
+#ifdef UA_ENABLE_TYPEDESCRIPTION
+    static const std::unordered_map<std::string_view, const UA_DataType*> uaDataTypes = []() {
+        std::unordered_map<std::string_view, const UA_DataType*> index;
+        for (size_t i = 0; i < UA_TYPES_COUNT; i++) {
+            if (UA_TYPES[i].typeName)
+                index.emplace(UA_TYPES[i].typeName, &UA_TYPES[i]);
+        }
+        return index;
+    }();
+    std::unordered_map<std::string_view, const UA_DataType*>::const_iterator uaDataTypeIt = uaDataTypes.find(localName);
+    if (uaDataTypeIt != uaDataTypes.end())
+        return uaDataTypeIt->second;
+#endif
+    return 0x0;
+}
+
+// splits a TypeName attribute "prefix:Name" and resolves the prefix with the xmlns declarations in scope of the node
+// undeclared prefixes opc and ua are accepted for dictionaries without declarations
+static UA_Byte resolveTypeName(xmlNode* node, const std::string& typeName, std::string_view* localName) {
+    const size_t colon = typeName.find(':');
+    std::string prefix;
+    xmlNsPtr ns;
+
+    *localName = std::string_view(typeName);
+    if (colon != std::string::npos) {
+        prefix = typeName.substr(0, colon);
+        *localName = localName->substr(colon + 1);
+    }
+    ns = node ? xmlSearchNs(node->doc, node, prefix.empty() ? 0x0 : (const xmlChar*)prefix.c_str()) : 0x0;
+    if (ns && ns->href) {
+        if (xmlStrEqual(ns->href, BAD_CAST "http://opcfoundation.org/BinarySchema/"))
+            return DICTIONARY_NAMESPACE_BINARYSCHEMA;
+        if (xmlStrEqual(ns->href, BAD_CAST "http://opcfoundation.org/UA/"))
+            return DICTIONARY_NAMESPACE_UA;
+        return DICTIONARY_NAMESPACE_OTHER;
+    }
+    if (exo_compare(prefix, "opc"))
+        return DICTIONARY_NAMESPACE_BINARYSCHEMA;
+    if (exo_compare(prefix, "ua"))
+        return DICTIONARY_NAMESPACE_UA;
+    return DICTIONARY_NAMESPACE_OTHER;
+}
+
+// checks whether the TypeName attribute of a field is opc:Bit (bit mask of optional fields)
+static UA_Boolean isBitTypeName(xmlNode* node, const std::string& typeName) {
+    std::string_view localName;
+    const builtinTypeName_t* builtinTypeName;
+    if (resolveTypeName(node, typeName, &localName) != DICTIONARY_NAMESPACE_BINARYSCHEMA)
+        return false;
+    builtinTypeName = findBuiltinTypeName(localName);
+    return builtinTypeName && builtinTypeName->typeIndex < 0;
+}
+
 // converts dictionary data type tag to OPC data type address (generated open62541 data types)
-static const UA_DataType* parseDataType(std::string text) {
-    if (xmlStrncasecmp((const xmlChar*)("opc:String"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_STRING]);
-    if (xmlStrncasecmp((const xmlChar*)("opc:Byte"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_BYTE]);
-    if (xmlStrncasecmp((const xmlChar*)("opc:SByte"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_SBYTE]);
-    if (xmlStrncasecmp((const xmlChar*)("opc:Boolean"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_BOOLEAN]);
-    if (xmlStrncasecmp((const xmlChar*)("opc:Bit"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return 0x0;// used for bit mask only
-    if (xmlStrncasecmp((const xmlChar*)("opc:Int16"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_INT16]);
-    if (xmlStrncasecmp((const xmlChar*)("opc:Int32"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_INT32]);
-    if (xmlStrncasecmp((const xmlChar*)("opc:Int64"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_INT64]);
-    if (xmlStrncasecmp((const xmlChar*)("opc:UInt16"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_UINT16]);
-    if (xmlStrncasecmp((const xmlChar*)("opc:UInt32"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_UINT32]);
-    if (xmlStrncasecmp((const xmlChar*)("opc:UInt64"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_UINT64]);
-    if (xmlStrncasecmp((const xmlChar*)("opc:Float"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_FLOAT]);
-    if (xmlStrncasecmp((const xmlChar*)("opc:Double"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_DOUBLE]);
-    if (xmlStrncasecmp((const xmlChar*)("opc:DateTime"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_DATETIME]);
-    if (xmlStrncasecmp((const xmlChar*)("opc:Guid"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_GUID]);
-    if (xmlStrncasecmp((const xmlChar*)("opc:ByteString"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_BYTESTRING]);
-    if (xmlStrncasecmp((const xmlChar*)("ua:XmlElement"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_XMLELEMENT]);
-    if (xmlStrncasecmp((const xmlChar*)("ua:NodeId"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_NODEID]);
-    if (xmlStrncasecmp((const xmlChar*)("ua:ExpandedNodeId"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
-    if (xmlStrncasecmp((const xmlChar*)("ua:QualifiedName"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_QUALIFIEDNAME]);
-    if (xmlStrncasecmp((const xmlChar*)("ua:LocalizedText"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
-    if (xmlStrncasecmp((const xmlChar*)("ua:StatusCode"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_STATUSCODE]);
-    if (xmlStrncasecmp((const xmlChar*)("ua:Variant"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_VARIANT]);
-    if (xmlStrncasecmp((const xmlChar*)("ua:Int32"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_INT32]);
-    if (xmlStrncasecmp((const xmlChar*)("ua:ExtensionObject"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_EXTENSIONOBJECT]);
-    if (xmlStrncasecmp((const xmlChar*)("ua:DiagnosticInfo"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_DIAGNOSTICINFO]);
-    if (xmlStrncasecmp((const xmlChar*)("opc:CharArray"), (xmlChar*)text.data(), (UA_UInt32)text.length()) == 0)
-        return &(UA_TYPES[UA_TYPES_STRING]);
+// the prefix is resolved with the xmlns declarations of the dictionary, the name with the perfect hash of the built-in type names
+static const UA_DataType* parseDataType(xmlNode* node, const std::string& text) {
+    std::string_view localName;
+    const UA_Byte ns = resolveTypeName(node, text, &localName);
+    const builtinTypeName_t* builtinTypeName;
+
+    if (ns == DICTIONARY_NAMESPACE_OTHER)
+        return 0x0;
+    builtinTypeName = findBuiltinTypeName(localName);
+    if (builtinTypeName && (builtinTypeName->namespaces & ns))
+        return builtinTypeName->typeIndex < 0 ? 0x0 : &UA_TYPES[builtinTypeName->typeIndex];
+    if (ns == DICTIONARY_NAMESPACE_UA)
+        return findUaDataType(localName);
     return 0x0;
 }
 
@@ -528,9 +903,13 @@ UA_StatusCode parseXml(std::map<UA_UInt32, std::string>* dictionaries) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "getXmlDocMap: Parameter 1 (std::map<UA_UInt32, std::string>*) invalid");
         return UA_STATUSCODE_BADUNEXPECTEDERROR;
     }
+    if (isRegistryMapped()) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "parseXml: A registry image is loaded, call clearCustomDataTypes first");
+        return UA_STATUSCODE_BADINVALIDSTATE;
+    }
     const UA_UInt16 xmlPathCount = 2;
     const char xmlPath[xmlPathCount][40] = { "/opc:TypeDictionary/opc:StructuredType" , "/opc:TypeDictionary/opc:EnumeratedType" };
-    char** tmp, * pError;
+    char* pError;
     const UA_DataType* memberDataType;
     UA_DataTypeMember* member;
     nameTypePropIt_t typePropIt;
@@ -555,8 +934,12 @@ UA_StatusCode parseXml(std::map<UA_UInt32, std::string>* dictionaries) {
     xmlXPathContextPtr xpathCtx;
     xmlXPathObjectPtr xpathObj;
 
+    traceSpan_t span("parse", "parseXml");
     // collects custom data type properties of all specified dictionaries
     for (it = dictionaries->begin(); it != dictionaries->end(); ++it) {
+        traceSpan_t dictionarySpan("parse", "dictionary");
+        if (dictionarySpan.active())
+            dictionarySpan.detail = "ns=" + std::to_string(it->first) + ", " + std::to_string(it->second.length()) + " bytes";
         // parse the current dictionary and build a node tree
         doc = xmlReadMemory((const char*)it->second.c_str(), (UA_UInt32)it->second.length(), "include.xml", 0x0, 0);
         if (!doc) {
@@ -587,10 +970,13 @@ UA_StatusCode parseXml(std::map<UA_UInt32, std::string>* dictionaries) {
             for (UA_UInt16 j = 0; j < xpathObj->nodesetval->nodeNr; j++) {
                 xmlNode* node = xpathObj->nodesetval->nodeTab[j];
                 xmlNode* children = node->children;
+                traceSpan_t typeSpan("parse", "type");
                 isArray = false;
                 isOptional = false;
                 propertyType = (char*)node->name;
                 browseName = (char*)xmlGetProp(node, BAD_CAST "Name");
+                if (typeSpan.active())
+                    typeSpan.detail = browseName;
                 typePropIt = dataTypeNameMap.find(browseName);
                 if (typePropIt == dataTypeNameMap.end()) {
                     UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "parseXml: custom data type %s not found in the node branch DataTypes", browseName.c_str());
@@ -615,7 +1001,7 @@ UA_StatusCode parseXml(std::map<UA_UInt32, std::string>* dictionaries) {
                         }
                         if (typeName.empty()) {
                             val = getXmlPropery(children, "TypeName");
-                            if (!val.empty() && exo_compare(val, "opc:Bit"))
+                            if (!val.empty() && isBitTypeName(children, val))
                                 typeName = val;
                         }
                         if (switchField.empty()) {
@@ -653,7 +1039,7 @@ UA_StatusCode parseXml(std::map<UA_UInt32, std::string>* dictionaries) {
                             if (!lengthField.empty())
                                 isArray = true;
                             if (!typeName.empty())
-                                memberDataType = getMemberDataType(typeName);
+                                memberDataType = getMemberDataType(children, typeName);
                             else
                                 memberDataType = 0x0;
                             if (!memberDataType) {
@@ -667,12 +1053,7 @@ UA_StatusCode parseXml(std::map<UA_UInt32, std::string>* dictionaries) {
                             memset(&dataTypeMember, 0x0, sizeof(UA_DataTypeMember));
                             dataTypeMember.memberType = memberDataType;
  #ifdef UA_ENABLE_TYPEDESCRIPTION
-                            if (!dataTypeMember.memberName) {
-                                tmp = (char**)&dataTypeMember.memberName;
-                                *tmp = (char*)UA_malloc(name.length() * sizeof(char) + 1);
-                                if (*tmp)
-                                    strcpy(*tmp, name.c_str());
-                            }
+                            dataTypeMember.memberName = internRegistryName(name.c_str());
 #endif
                             dataTypeMember.isOptional = false;
                             dataTypeMember.isArray = isArray;
@@ -696,7 +1077,7 @@ UA_StatusCode parseXml(std::map<UA_UInt32, std::string>* dictionaries) {
                             val = getXmlPropery(children, "TypeName");
                             if (!val.empty()) {
                                 typeName = val;
-                                if (exo_compare(typeName, "opc:Bit")) {
+                                if (isBitTypeName(children, typeName)) {
                                     children = children->next;
                                     continue;
                                 }
@@ -715,7 +1096,7 @@ UA_StatusCode parseXml(std::map<UA_UInt32, std::string>* dictionaries) {
                             if (!lengthField.empty())
                                 isArray = true;
                             if (!typeName.empty())
-                                memberDataType = getMemberDataType(typeName);
+                                memberDataType = getMemberDataType(children, typeName);
                             else
                                 memberDataType = 0x0;
                             if (!memberDataType) {
@@ -729,10 +1110,7 @@ UA_StatusCode parseXml(std::map<UA_UInt32, std::string>* dictionaries) {
                             memset(&dataTypeMember, 0x0, sizeof(UA_DataTypeMember));
                             dataTypeMember.memberType = memberDataType;
 #ifdef UA_ENABLE_TYPEDESCRIPTION
-                            tmp = (char**)&dataTypeMember.memberName;
-                            *tmp = (char*)UA_malloc(name.length() * sizeof(char) + 1);
-                            if (*tmp)
-                                strcpy(*tmp, name.c_str());
+                            dataTypeMember.memberName = internRegistryName(name.c_str());
 #endif
                             dataTypeMember.isOptional = isOptional;
                             dataTypeMember.isArray = isArray;
@@ -756,7 +1134,7 @@ UA_StatusCode parseXml(std::map<UA_UInt32, std::string>* dictionaries) {
                             val = getXmlPropery(children, "TypeName");
                             if (!val.empty()) {
                                 typeName = val;
-                                if (exo_compare(typeName, "opc:Bit")) {
+                                if (isBitTypeName(children, typeName)) {
                                     children = children->next;
                                     continue;
                                 }
@@ -773,7 +1151,7 @@ UA_StatusCode parseXml(std::map<UA_UInt32, std::string>* dictionaries) {
                             if (!lengthField.empty())
                                 isArray = true;
                             if (!typeName.empty())
-                                memberDataType = getMemberDataType(typeName);
+                                memberDataType = getMemberDataType(children, typeName);
                             else
                                 memberDataType = 0x0;
                             if (!memberDataType) {
@@ -787,10 +1165,7 @@ UA_StatusCode parseXml(std::map<UA_UInt32, std::string>* dictionaries) {
                             memset(&dataTypeMember, 0x0, sizeof(UA_DataTypeMember));
                             dataTypeMember.memberType = memberDataType;
 #ifdef UA_ENABLE_TYPEDESCRIPTION
-                            tmp = (char**)&dataTypeMember.memberName;
-                            *tmp = (char*)UA_malloc(name.length() * sizeof(char) + 1);
-                            if (*tmp)
-                                strcpy(*tmp, name.c_str());
+                            dataTypeMember.memberName = internRegistryName(name.c_str());
 #endif
                             dataTypeMember.isOptional = isOptional;
                             dataTypeMember.isArray = isArray;
@@ -803,10 +1178,10 @@ UA_StatusCode parseXml(std::map<UA_UInt32, std::string>* dictionaries) {
                     }*/
                 }
                 // processing of enumerations if no declaration was previously available
-                else if (exo_compare(propertyType, "EnumeratedType") && typePropIt->second->enumValueSet.empty()) {
+                else if (exo_compare(propertyType, "EnumeratedType") && !typePropIt->second->enumValuesSize) {
+                    std::vector<UA_Int64> enumValues;
+                    std::vector<UA_UInt32> enumNames;
                     while (children) {
-                        UA_EnumValueType enumValue;
-                        UA_EnumValueType_init(&enumValue);
                         name.clear();
                         value.clear();
                         if (children->type != XML_ELEMENT_NODE || !exo_compare((char*)children->name, "EnumeratedValue")) {
@@ -824,14 +1199,13 @@ UA_StatusCode parseXml(std::map<UA_UInt32, std::string>* dictionaries) {
                         if (!name.empty() && !value.empty()) {
                             long i = strtol(val.c_str(), &pError, 10);
                             if (val.c_str() != pError) {
-                                enumValue.value = i;
-                                enumValue.description.text = UA_STRING_ALLOC(name.c_str());
-                                enumValue.displayName.text = UA_STRING_ALLOC(name.c_str());
-                                typePropIt->second->enumValueSet.push_back(enumValue);
+                                enumValues.push_back(i);
+                                enumNames.push_back(internRegistryString(name.data(), name.length()));
                             }
                         }
                         children = children->next;
                     }
+                    setEnumValues(typePropIt->second, enumValues, enumNames);
                 }
                 // finalize completion of the custom data type
                 if (!structMemberTypes.empty()) {
@@ -886,10 +1260,7 @@ UA_StatusCode parseXml(std::map<UA_UInt32, std::string>* dictionaries) {
                                 dataType->members[i - 1].isArray = structMemberTypes.at(i).isArray;
                                 dataType->members[i - 1].isOptional = structMemberTypes.at(i).isOptional;
 #ifdef UA_ENABLE_TYPEDESCRIPTION
-                                if (*structMemberTypes.at(i).memberName) {
-                                    dataType->members[i - 1].memberName = (char*)UA_malloc(strlen(structMemberTypes.at(i).memberName) * sizeof(char) + 1);
-                                    strcpy((char*)dataType->members[i - 1].memberName, structMemberTypes.at(i).memberName);
-                                }
+                                dataType->members[i - 1].memberName = structMemberTypes.at(i).memberName;
 #endif
                                 dataType->members[i - 1].memberType = structMemberTypes.at(i).memberType;
                                 dataType->members[i - 1].padding = 0;
@@ -910,11 +1281,7 @@ UA_StatusCode parseXml(std::map<UA_UInt32, std::string>* dictionaries) {
                                 dataType->members[i].isArray = member->isArray;
                                 dataType->members[i].memberType = member->memberType;
 #ifdef UA_ENABLE_TYPEDESCRIPTION
-                                if (member->memberName) {
-                                    dataType->members[i].memberName = (char*)UA_malloc(strlen(member->memberName) * sizeof(char*) + 1);
-                                    if (dataType->members[i].memberName)
-                                        strcpy((char*)dataType->members[i].memberName, member->memberName);
-                                }
+                                dataType->members[i].memberName = member->memberName;
 #endif
                             }
                             dataType->memSize = calc_struct_padding(dataType);
@@ -945,6 +1312,7 @@ UA_StatusCode printArray(UA_PrintContext* ctx, const void* p, const size_t lengt
         return retval;
     }
 
+    const UA_Boolean profiled = profileEnterArray(type);
     UA_UInt32 length32 = (UA_UInt32)length;
     retval |= UA_PrintContext_addString(ctx, "(");
     retval |= UA_PrintContext_addString(ctx, type->typeName);
@@ -971,18 +1339,25 @@ UA_StatusCode printArray(UA_PrintContext* ctx, const void* p, const size_t lengt
     ctx->depth--;
     UA_PrintContext_addNewlineTabs(ctx, ctx->depth);
     retval |= UA_PrintContext_addString(ctx, "}");
+    if (profiled)
+        profileLeave(profileArraySize(p, length, type));
     return retval;
 }
 
 // copy of open62541/src/ua_types_print.c
 // modifications: new optional parameters width (leading white spaces) and isHex (print value 
+//                number formatting with std::to_chars instead of snprintf
 UA_StatusCode printUInt32(UA_PrintContext* ctx, UA_UInt32 p, UA_UInt32 width, UA_Boolean isHex) {
-    char out[32];
-    if (isHex)
-        snprintf(out, 32, "%0*x", width, p);
-    else
-        snprintf(out, 32, "%0*u", width, p);
-    return UA_PrintContext_addString(ctx, out);
+    char digits[16];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), p, isHex ? 16 : 10);
+    size_t length = result.ptr - digits;
+    size_t padding = width > length ? width - length : 0;
+    UA_PrintOutput* out = UA_PrintContext_addOutput(ctx, padding + length);
+    if (!out)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    memset(out->data, '0', padding);
+    memcpy(&out->data[padding], digits, length);
+    return UA_STATUSCODE_GOOD;
 }
 
 // copy of open62541/src/ua_types_print.c
@@ -1014,6 +1389,8 @@ static UA_PrintOutput* UA_PrintContext_addOutput(UA_PrintContext* ctx, size_t le
     UA_PrintOutput* output = (UA_PrintOutput*)UA_malloc(sizeof(UA_PrintOutput) + length + 1);
     if (!output)
         return 0x0;
+    metricsCount(UA_COUNTER_PRINTALLOCATIONS, 1);
+    profileCountAllocation();
     output->length = length;
     TAILQ_INSERT_TAIL(&ctx->outputs, output, next);
     return output;
@@ -1050,7 +1427,7 @@ UA_StatusCode UA_PrintContext_addString(UA_PrintContext* ctx, const char* str) {
 }
 
 // copy of open62541/src/ua_types_print.c
-UA_StatusCode UA_PrintContext_addUAString(UA_PrintContext* ctx, UA_String* str) {
+UA_StatusCode UA_PrintContext_addUAString(UA_PrintContext* ctx, const UA_String* str) {
     UA_PrintOutput* out = UA_PrintContext_addOutput(ctx, str->length);
     if (!out)
         return UA_STATUSCODE_BADOUTOFMEMORY;
@@ -1189,15 +1566,15 @@ UA_StatusCode UA_PrintDataType(const UA_DataType* dataType, UA_String* output) {
                 retval |= UA_PrintContext_addString(&ctx, "}");
                 retval |= UA_PrintContext_addNewlineTabs(&ctx, ctx.depth);
                 retval |= UA_PrintContext_addString(&ctx, "OptionSet Values: {");
-                for (UA_UInt32 i = 0; i < typePropIt->second.structureDefinition.size(); i++) {
+                if (typePropIt->second.optionBitsSize) {
                     ctx.depth++;
                     retval |= UA_PrintContext_addNewlineTabs(&ctx, ctx.depth);
-                    for (UA_UInt32 j = 0; j < typePropIt->second.structureDefinition[i].fieldsSize; j++) {
+                    for (UA_UInt32 j = 0; j < typePropIt->second.optionBitsSize; j++) {
                         retval |= UA_PrintContext_addString(&ctx, "[0x");
                         retval |= printUInt32(&ctx, pow(2, j), 4, true);
                         retval |= UA_PrintContext_addString(&ctx, "] ");
-                        retval |= UA_PrintContext_addUAString(&ctx, &typePropIt->second.structureDefinition[i].fields[j].name);
-                        if (j + 1 < (UA_UInt32)typePropIt->second.structureDefinition[i].fieldsSize)
+                        retval |= UA_PrintContext_addUAString(&ctx, getOptionBitName(&typePropIt->second, j));
+                        if (j + 1 < typePropIt->second.optionBitsSize)
                             retval |= UA_PrintContext_addNewlineTabs(&ctx, ctx.depth);
                     }
                     ctx.depth--;
@@ -1211,12 +1588,12 @@ UA_StatusCode UA_PrintDataType(const UA_DataType* dataType, UA_String* output) {
             retval |= UA_PrintContext_addString(&ctx, "ENUM values: {");
             ctx.depth++;
             retval |= UA_PrintContext_addNewlineTabs(&ctx, ctx.depth);
-            for (UA_UInt32 i = 0; i < typePropIt->second.enumValueSet.size(); i++) {
-                retval |= UA_PrintContext_addUAString(&ctx, &typePropIt->second.enumValueSet[i].displayName.text);
+            for (UA_UInt32 i = 0; i < typePropIt->second.enumValuesSize; i++) {
+                retval |= UA_PrintContext_addUAString(&ctx, getEnumValueName(&typePropIt->second, i));
                 retval |= UA_PrintContext_addString(&ctx, " (");
-                retval |= printUInt32(&ctx, (UA_UInt32)typePropIt->second.enumValueSet[i].value);
+                retval |= printUInt32(&ctx, (UA_UInt32)getEnumValue(&typePropIt->second, i));
                 retval |= UA_PrintContext_addString(&ctx, ")");
-                if (i + 1 < (UA_UInt32)typePropIt->second.enumValueSet.size())
+                if (i + 1 < typePropIt->second.enumValuesSize)
                     retval |= UA_PrintContext_addNewlineTabs(&ctx, ctx.depth);
             }
             ctx.depth--;
@@ -1418,7 +1795,7 @@ UA_StatusCode UA_PrintEnum(const UA_Variant* pData, customTypeProperties_t* cust
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintEnum: Parameter 1 (UA_Variant*) invalid");
         return UA_STATUSCODE_BADUNEXPECTEDERROR;
     }
-    if (!customTypeProperties || !customTypeProperties->enumValueSet.size() || pData->type->membersSize) {
+    if (!customTypeProperties || !customTypeProperties->enumValuesSize || pData->type->membersSize) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintEnum: Parameter 2 (customTypeProperties_t*) invalid");
         return UA_STATUSCODE_BADUNEXPECTEDERROR;
     }
@@ -1432,6 +1809,7 @@ UA_StatusCode UA_PrintEnum(const UA_Variant* pData, customTypeProperties_t* cust
     TAILQ_INIT(&ctx.outputs);
     UA_String_init(output);
     value = *(UA_Int32*)pData->data;
+    const UA_Boolean profiled = profileEnterType(&customTypeProperties->dataType);
     retval |= UA_PrintContext_addString(&ctx, "{");
     ctx.depth++;
 #ifdef UA_ENABLE_TYPEDESCRIPTION
@@ -1442,22 +1820,21 @@ UA_StatusCode UA_PrintEnum(const UA_Variant* pData, customTypeProperties_t* cust
 #endif
     retval |= UA_PrintContext_addNewlineTabs(&ctx, ctx.depth);
     retval |= UA_PrintContext_addName(&ctx, "Value");
-    UA_UInt32 i = 0;
-    for (; i < customTypeProperties->enumValueSet.size(); i++) {
-        if (customTypeProperties->enumValueSet.at(i).value == value) {
-            retval |= UA_PrintContext_addUAString(&ctx, &customTypeProperties->enumValueSet.at(i).displayName.text);
-            retval |= UA_PrintContext_addString(&ctx, " (");
-            retval |= printUInt32(&ctx, value);
-            retval |= UA_PrintContext_addString(&ctx, ")");
-            break;
-        }
+    const UA_String* valueName = findEnumValueName(customTypeProperties, value);
+    if (valueName) {
+        retval |= UA_PrintContext_addUAString(&ctx, valueName);
+        retval |= UA_PrintContext_addString(&ctx, " (");
+        retval |= printUInt32(&ctx, value);
+        retval |= UA_PrintContext_addString(&ctx, ")");
     }
-    if (i >= customTypeProperties->enumValueSet.size()) {
+    else {
         retval |= printUInt32(&ctx, value);
     }
     ctx.depth--;
     retval |= UA_PrintContext_addNewlineTabs(&ctx, ctx.depth);
     retval |= UA_PrintContext_addString(&ctx, "}");
+    if (profiled)
+        profileLeave(sizeof(UA_Int32));
     /* Allocate memory for the output */
     if (retval == UA_STATUSCODE_GOOD) {
         size_t total = 0;
@@ -1484,194 +1861,472 @@ UA_StatusCode UA_PrintEnum(const UA_Variant* pData, customTypeProperties_t* cust
     return retval;
 }
 
-// prints variant data type STRUCTURE to UA_String
-UA_StatusCode UA_PrintStructure(const UA_Variant* data, UA_String* output) {
-    const UA_DataType* dataType;
+// elements of custom structure and union arrays are formatted in chunks, each chunk into a print context of its own
+// arrays of more than one chunk are formatted by worker threads, the chunks are appended in order
+#define UA_PRINT_CHUNKSIZE 256
+#define UA_PRINT_WINDOWCHUNKS 4 // chunks per worker which are formatted ahead of the chunk appended or streamed next
+
+typedef UA_StatusCode(*printElementFunction_t)(UA_PrintContext* ctx, const UA_DataType* dataType, const void* p);
+
+// formatted chunk of printCustomArray, ready is guarded by the mutex of the array
+typedef struct {
     UA_PrintContext ctx;
-    UA_PrintOutput* out;
     UA_StatusCode retval;
-    UA_String outString;
-    uintptr_t ptrs;
+    UA_Boolean ready;
+} printChunk_t;
 
-    if (!data) {
-        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintStructure: Parameter 1 (UA_Variant*) invalid");
-        return UA_STATUSCODE_BADUNEXPECTEDERROR;
-    }
-    if (!output) {
-        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintStructure: Parameter 2 (UA_String*) invalid");
-        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+// frees the outputs of a print context
+static void clearPrintContext(UA_PrintContext* ctx) {
+    UA_PrintOutput* o, * o2;
+    TAILQ_FOREACH_SAFE(o, &ctx->outputs, next, o2) {
+        TAILQ_REMOVE(&ctx->outputs, o, next);
+        UA_free(o);
     }
-    retval = UA_STATUSCODE_GOOD;
-    ctx = UA_PrintContext();
-    ctx.depth = 0;
-    dataType = data->type;
-    ptrs = (uintptr_t)data->data;
-    TAILQ_INIT(&ctx.outputs);
-    UA_String_init(output);
-    if (!dataType) {
-        *output = UA_STRING_ALLOC("NullVariant");
-        return UA_STATUSCODE_GOOD;
+}
+
+// writes the outputs of a print context to the sink and frees them
+static UA_StatusCode writePrintContext(UA_PrintContext* ctx, UA_OutputSink* sink) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    UA_PrintOutput* out;
+    TAILQ_FOREACH(out, &ctx->outputs, next) {
+        if (retval == UA_STATUSCODE_GOOD)
+            retval = UA_OutputSink_write(sink, out->data, out->length);
     }
-    retval |= UA_PrintContext_addString(&ctx, "{");
-    ctx.depth++;
-#ifdef UA_ENABLE_TYPEDESCRIPTION
-    retval |= UA_PrintContext_addNewlineTabs(&ctx, ctx.depth);
-    retval |= UA_PrintContext_addName(&ctx, "DataType");
-    retval |= UA_PrintContext_addString(&ctx, dataType->typeName);
-    retval |= UA_PrintContext_addString(&ctx, ",");
-#endif
-    retval |= UA_PrintContext_addNewlineTabs(&ctx, ctx.depth);
-    retval |= UA_PrintContext_addName(&ctx, "Value");
-    if (UA_Variant_isScalar(data)) {
-        retval |= UA_PrintContext_addString(&ctx, "{");
-        ctx.depth++;
-        retval |= UA_PrintContext_addNewlineTabs(&ctx, ctx.depth);
-        // print OptionSet
-        if (dataType->membersSize == 2 && 
-            UA_NodeId_equal(&dataType->members[0].memberType->typeId, &NS0ID_BYTESTRING) && 
-            UA_NodeId_equal(&dataType->members[1].memberType->typeId, &NS0ID_BYTESTRING)) {
-            typePropIt_t typePropIt = dataTypeMap.find(UA_NodeId_SDBMHash(&dataType->typeId));
-            if (typePropIt != dataTypeMap.end()) {
-                UA_Byte* pValue;
-                UA_Byte* pValidBits;
-                UA_Byte resultingBits;
-                ptrs += dataType->members[0].padding;
-                pValue = ((UA_ByteString*)ptrs)->data;
-                ptrs += UA_TYPES[UA_TYPES_BYTESTRING].memSize;
-                ptrs += dataType->members[1].padding;
-                pValidBits = ((UA_ByteString*)ptrs)->data;
-                resultingBits = *pValue & *pValidBits;
-                for (UA_UInt32 i = 0; i < typePropIt->second.structureDefinition.size(); i++) {
-                    for (UA_UInt32 j = 0; j < typePropIt->second.structureDefinition[i].fieldsSize; j++) {
-                        retval |= UA_PrintContext_addUAString(&ctx, &typePropIt->second.structureDefinition[i].fields[j].name);
-                        retval |= UA_PrintContext_addString(&ctx, ": ");
-                        retval |= UA_PrintContext_addString(&ctx, resultingBits & 0x01 << j ? "TRUE" : "FALSE");
-                        if (j < typePropIt->second.structureDefinition[i].fieldsSize - 1)
-                            retval |= UA_PrintContext_addNewlineTabs(&ctx, ctx.depth);
-                    }
-                }
+    clearPrintContext(ctx);
+    return retval;
+}
+
+// prints the members of a structure value (or the bits of an option set) in braces
+static UA_StatusCode printStructureElement(UA_PrintContext* ctx, const UA_DataType* dataType, const void* p) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    uintptr_t ptrs = (uintptr_t)p;
+    UA_PrintOutput* out;
+    UA_String outString;
+
+    retval |= UA_PrintContext_addString(ctx, "{");
+    ctx->depth++;
+    retval |= UA_PrintContext_addNewlineTabs(ctx, ctx->depth);
+    // print OptionSet
+    if (dataType->membersSize == 2 && 
+        UA_NodeId_equal(&dataType->members[0].memberType->typeId, &NS0ID_BYTESTRING) && 
+        UA_NodeId_equal(&dataType->members[1].memberType->typeId, &NS0ID_BYTESTRING)) {
+        typePropIt_t typePropIt = dataTypeMap.find(UA_NodeId_SDBMHash(&dataType->typeId));
+        if (typePropIt != dataTypeMap.end()) {
+            UA_Byte* pValue;
+            UA_Byte* pValidBits;
+            UA_Byte resultingBits;
+            ptrs += dataType->members[0].padding;
+            pValue = ((UA_ByteString*)ptrs)->data;
+            ptrs += UA_TYPES[UA_TYPES_BYTESTRING].memSize;
+            ptrs += dataType->members[1].padding;
+            pValidBits = ((UA_ByteString*)ptrs)->data;
+            resultingBits = *pValue & *pValidBits;
+            for (UA_UInt32 j = 0; j < typePropIt->second.optionBitsSize; j++) {
+                retval |= UA_PrintContext_addUAString(ctx, getOptionBitName(&typePropIt->second, j));
+                retval |= UA_PrintContext_addString(ctx, ": ");
+                retval |= UA_PrintContext_addString(ctx, resultingBits & 0x01 << j ? "TRUE" : "FALSE");
+                if (j < typePropIt->second.optionBitsSize - 1)
+                    retval |= UA_PrintContext_addNewlineTabs(ctx, ctx->depth);
             }
-        } // print structure members
-        else {
-            for (UA_UInt32 i = 0; i < dataType->membersSize; i++) {
-                typePropIt_t typePropIt = dataTypeMap.end();
-                UA_DataTypeMember* dataTypeMember = &dataType->members[i];
-#ifdef UA_ENABLE_TYPEDESCRIPTION
-                retval |= UA_PrintContext_addName(&ctx, dataTypeMember->memberName);                
-#endif
-                ptrs += dataTypeMember->padding;
-                if (dataTypeMember->isOptional) {
-                    if (*(UA_Int32**)ptrs) {
-                        if (dataTypeMember->isArray) {
-                            const size_t size = *((const size_t*)ptrs);
-                            ptrs += sizeof(size_t);
-                            retval |= printArray(&ctx, *(void* const*)ptrs, size, dataTypeMember->memberType);
-                            ptrs += sizeof(void*);
-                        }
-                        else {
-                            retval |= UA_print(*(UA_Int32**)ptrs, dataTypeMember->memberType, &outString);
-                            out = UA_PrintContext_addOutput(&ctx, outString.length);
-                            if (!out)
-                                retval |= UA_STATUSCODE_BADOUTOFMEMORY;
-                            else
-                                memcpy(&out->data, outString.data, outString.length);
-                            UA_String_clear(&outString);
-                        }
+        }
+    } // print structure members
+    else {
+        for (UA_UInt32 i = 0; i < dataType->membersSize; i++) {
+            typePropIt_t typePropIt = dataTypeMap.end();
+            UA_DataTypeMember* dataTypeMember = &dataType->members[i];
+            retval |= UA_PrintContext_addName(ctx, dataTypeMember->memberName);                
+            ptrs += dataTypeMember->padding;
+            const uintptr_t memberPtrs = ptrs;
+            const UA_Boolean memberProfiled = profileEnterMember(dataType, i);
+            if (dataTypeMember->isOptional) {
+                if (*(UA_Int32**)ptrs) {
+                    if (dataTypeMember->isArray) {
+                        const size_t size = *((const size_t*)ptrs);
+                        ptrs += sizeof(size_t);
+                        retval |= printArray(ctx, *(void* const*)ptrs, size, dataTypeMember->memberType);
+                        ptrs += sizeof(void*);
                     }
                     else {
-                        retval |= UA_PrintContext_addString(&ctx, "(disabled)");
+                        retval |= UA_print(*(UA_Int32**)ptrs, dataTypeMember->memberType, &outString);
+                        out = UA_PrintContext_addOutput(ctx, outString.length);
+                        if (!out)
+                            retval |= UA_STATUSCODE_BADOUTOFMEMORY;
+                        else
+                            memcpy(&out->data, outString.data, outString.length);
+                        UA_String_clear(&outString);
                     }
+                }
+                else {
+                    retval |= UA_PrintContext_addString(ctx, "(disabled)");
+                }
+                ptrs += sizeof(void*);
+                if (i < dataType->membersSize - 1u)
+                    retval |= UA_PrintContext_addNewlineTabs(ctx, ctx->depth);
+            }
+            else {
+                if (dataTypeMember->isArray) {
+                    const size_t size = *((const size_t*)ptrs);
+                    ptrs += sizeof(size_t);
+                    retval |= printArray(ctx, *(void* const*)ptrs, size, dataTypeMember->memberType);
                     ptrs += sizeof(void*);
-                    if (i < dataType->membersSize - 1u)
-                        retval |= UA_PrintContext_addNewlineTabs(&ctx, ctx.depth);
                 }
                 else {
-                    if (dataTypeMember->isArray) {
-                        const size_t size = *((const size_t*)ptrs);
-                        ptrs += sizeof(size_t);
-                        retval |= printArray(&ctx, *(void* const*)ptrs, size, dataTypeMember->memberType);
-                        ptrs += sizeof(void*);
+                    retval |= UA_print((const void*)ptrs, dataTypeMember->memberType, &outString);
+                    if(dataTypeMember->memberType->typeKind != UA_DATATYPEKIND_ENUM) {
+                        out = UA_PrintContext_addOutput(ctx, outString.length);
+                        if (!out)
+                            retval |= UA_STATUSCODE_BADOUTOFMEMORY;
+                        else
+                            memcpy(&out->data, outString.data, outString.length);
                     }
                     else {
-                        retval |= UA_print((const void*)ptrs, dataTypeMember->memberType, &outString);
-                        if(dataTypeMember->memberType->typeKind != UA_DATATYPEKIND_ENUM) {
-                            out = UA_PrintContext_addOutput(&ctx, outString.length);
-                            if (!out)
-                                retval |= UA_STATUSCODE_BADOUTOFMEMORY;
-                            else
-                                memcpy(&out->data, outString.data, outString.length);
-                        }
-                        else {
-                            char* pError;
-                            std::string ancestorsNameValue = std::string((char*)outString.data, outString.length);                            
-                            UA_UInt32 i = (UA_UInt32)strtoll(ancestorsNameValue.c_str(), &pError, 10);
-                            typePropIt = dataTypeMap.find(UA_NodeId_SDBMHash(&dataTypeMember->memberType->typeId));
-                            if (ancestorsNameValue.c_str() != pError && typePropIt != dataTypeMap.end()) {
-                                for (UA_UInt32 j = 0; j < typePropIt->second.enumValueSet.size(); j++) {
-                                    if (i == typePropIt->second.enumValueSet.at(j).value) {
-                                        retval |= UA_PrintContext_addUAString(&ctx, &typePropIt->second.enumValueSet.at(j).displayName.text);
-                                        break;
-                                    }
-                                }
-                            }
+                        char* pError;
+                        std::string ancestorsNameValue = std::string((char*)outString.data, outString.length);                            
+                        UA_UInt32 i = (UA_UInt32)strtoll(ancestorsNameValue.c_str(), &pError, 10);
+                        typePropIt = dataTypeMap.find(UA_NodeId_SDBMHash(&dataTypeMember->memberType->typeId));
+                        if (ancestorsNameValue.c_str() != pError && typePropIt != dataTypeMap.end()) {
+                            const UA_String* valueName = findEnumValueName(&typePropIt->second, i);
+                            if (valueName)
+                                retval |= UA_PrintContext_addUAString(ctx, valueName);
                         }
-                        UA_String_clear(&outString);
-                        ptrs += dataTypeMember->memberType->memSize;
                     }
-                    if (i < dataType->membersSize - 1u)
-                        retval |= UA_PrintContext_addNewlineTabs(&ctx, ctx.depth);
+                    UA_String_clear(&outString);
+                    ptrs += dataTypeMember->memberType->memSize;
                 }
+                if (i < dataType->membersSize - 1u)
+                    retval |= UA_PrintContext_addNewlineTabs(ctx, ctx->depth);
             }
+            if (memberProfiled)
+                profileLeave(profileMemberSize(dataTypeMember, (const void*)memberPtrs));
         }
     }
-    ctx.depth--;
-    retval |= UA_PrintContext_addNewlineTabs(&ctx, ctx.depth);
-    retval |= UA_PrintContext_addString(&ctx, "}");
-    ctx.depth--;
-    retval |= UA_PrintContext_addNewlineTabs(&ctx, ctx.depth);
-    retval |= UA_PrintContext_addString(&ctx, "}");
-    /* Allocate memory for the output */
-    if (retval == UA_STATUSCODE_GOOD) {
-        size_t total = 0;
-        UA_PrintOutput* out;
-        TAILQ_FOREACH(out, &ctx.outputs, next)
-            total += out->length;
-        retval = UA_ByteString_allocBuffer((UA_String*)output, total);
-    }
-    /* Write the output */
-    if (retval == UA_STATUSCODE_GOOD) {
-        size_t pos = 0;
-        UA_PrintOutput* out;
-        TAILQ_FOREACH(out, &ctx.outputs, next) {
-            memcpy(&output->data[pos], out->data, out->length);
-            pos += out->length;
+    ctx->depth--;
+    retval |= UA_PrintContext_addNewlineTabs(ctx, ctx->depth);
+    retval |= UA_PrintContext_addString(ctx, "}");
+    return retval;
+}
+
+// prints switch value, name and value of the selected member of a union value (one line each)
+static UA_StatusCode printUnionFields(UA_PrintContext* ctx, const UA_DataType* dataType, const void* p) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    uintptr_t ptrs = (uintptr_t)p;
+    UA_String outString;
+
+    retval |= UA_PrintContext_addName(ctx, "SwitchValue");
+    UA_UInt32 switchIndex = *((UA_UInt32*)ptrs);
+    retval |= printUInt32(ctx, switchIndex);
+    //ptrs += UA_TYPES[dataType->members[0].memberTypeIndex].memSize;
+    ptrs += dataType->members[1].padding;
+    if (switchIndex > 0 && switchIndex <= dataType->membersSize) {
+        const UA_DataTypeMember* unionDataTypeMember = &dataType->members[switchIndex - 1];
+        if (unionDataTypeMember) {
+            retval |= UA_PrintContext_addNewlineTabs(ctx, ctx->depth);
+#ifdef UA_ENABLE_TYPEDESCRIPTION
+            retval |= UA_PrintContext_addName(ctx, "Name");
+            retval |= UA_PrintContext_addString(ctx, unionDataTypeMember->memberName);
+            retval |= UA_PrintContext_addNewlineTabs(ctx, ctx->depth);
+#endif
+            retval |= UA_PrintContext_addName(ctx, "Value");
+            const UA_Boolean memberProfiled = profileEnterMember(dataType, switchIndex - 1);
+            UA_print((void*)ptrs, unionDataTypeMember->memberType, &outString);
+            if (memberProfiled)
+                profileLeave(profileMemberSize(unionDataTypeMember, (const void*)ptrs));
+            if (retval == UA_STATUSCODE_GOOD) {
+                retval |= UA_PrintContext_addUAString(ctx, &outString);
+                UA_String_clear(&outString);
+            }
+            else {
+                retval = UA_PrintContext_addString(ctx, UA_StatusCode_name(retval));
+            }
+        }
+        else {
+            retval |= UA_PrintContext_addString(ctx, "UNION data type unknown");
         }
     }
-    /* Free the context */
-    UA_PrintOutput* o, * o2;
-    TAILQ_FOREACH_SAFE(o, &ctx.outputs, next, o2) {
-        TAILQ_REMOVE(&ctx.outputs, o, next);
-        UA_free(o);
+    else {
+        retval |= UA_PrintContext_addNewlineTabs(ctx, ctx->depth);
+        retval |= UA_PrintContext_addName(ctx, "Value");
+        retval |= UA_PrintContext_addString(ctx, "(disabled)");
     }
     return retval;
 }
 
-// prints data type kind name to string
-void UA_PrintTypeKind(UA_UInt32 typeKind, UA_String* output) {
-    if (!output) {
-        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintTypeKind: Parameter 2 (UA_String*) invalid");
-        return;
+// prints a union value of an array in braces
+static UA_StatusCode printUnionElement(UA_PrintContext* ctx, const UA_DataType* dataType, const void* p) {
+    UA_StatusCode retval = UA_PrintContext_addString(ctx, "{");
+    ctx->depth++;
+    retval |= UA_PrintContext_addNewlineTabs(ctx, ctx->depth);
+    retval |= printUnionFields(ctx, dataType, p);
+    ctx->depth--;
+    retval |= UA_PrintContext_addNewlineTabs(ctx, ctx->depth);
+    retval |= UA_PrintContext_addString(ctx, "}");
+    return retval;
+}
+
+// subfunction of printCustomArray, formats the elements of a chunk into the print context of the chunk
+static void printArrayChunk(printChunk_t* chunk, const UA_Variant* data, printElementFunction_t printElement, size_t first, size_t depth) {
+    const UA_DataType* dataType = data->type;
+    const size_t last = std::min(data->arrayLength, first + UA_PRINT_CHUNKSIZE);
+    chunk->ctx.depth = depth;
+    TAILQ_INIT(&chunk->ctx.outputs);
+    chunk->retval = UA_STATUSCODE_GOOD;
+    for (size_t i = first; i < last; i++) {
+        chunk->retval |= UA_PrintContext_addNewlineTabs(&chunk->ctx, depth);
+        chunk->retval |= printUInt32(&chunk->ctx, (UA_UInt32)i);
+        chunk->retval |= UA_PrintContext_addString(&chunk->ctx, ": ");
+        chunk->retval |= printElement(&chunk->ctx, dataType, (const UA_Byte*)data->data + i * dataType->memSize);
+        if (i < data->arrayLength - 1)
+            chunk->retval |= UA_PrintContext_addString(&chunk->ctx, ",");
     }
-    switch (typeKind) {
-    case UA_DATATYPEKIND_BOOLEAN: {
-        *output = UA_STRING_ALLOC("boolean");
-        break;
+}
+
+// prints an array of custom structures or unions in the format of printArray
+// the worker threads are started once per array and take the next chunk from a counter, the calling thread appends
+// the chunks to ctx in order or writes them to the sink (ctx is written first)
+// workers stay at most UA_PRINT_WINDOWCHUNKS chunks per worker ahead, so the memory of the output is bounded with a sink
+static UA_StatusCode printCustomArray(UA_PrintContext* ctx, const UA_Variant* data, printElementFunction_t printElement, UA_OutputSink* sink) {
+    const UA_DataType* dataType = data->type;
+    const size_t length = data->arrayLength;
+    const size_t chunks = (length + UA_PRINT_CHUNKSIZE - 1) / UA_PRINT_CHUNKSIZE;
+    // a single chunk is formatted by the calling thread
+    const size_t workers = chunks > 1 ? std::min<size_t>(chunks, std::max<size_t>(1, std::thread::hardware_concurrency())) : 0;
+    const size_t window = std::max<size_t>(1, workers * UA_PRINT_WINDOWCHUNKS);
+    std::vector<printChunk_t> slots(window);
+    std::vector<std::thread> threads;
+    std::atomic<size_t> nextChunk(0);
+    std::mutex mutex;
+    std::condition_variable chunkReady, chunkConsumed;
+    size_t consumed = 0; // chunks appended or written, guarded by mutex
+    UA_Boolean cancelled = false; // guarded by mutex
+    // members formatted by the workers are profiled below the open frames of the calling thread
+    const std::string profilePath = profileParentPath();
+    std::atomic<UA_UInt64> profileChildTime(0), profileAllocations(0);
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+
+    if (!data->data || data->data == UA_EMPTY_ARRAY_SENTINEL) {
+        retval |= UA_PrintContext_addString(ctx, "(");
+        retval |= UA_PrintContext_addString(ctx, dataType->typeName);
+        retval |= UA_PrintContext_addString(ctx, " [empty])");
+        return retval;
     }
-    case UA_DATATYPEKIND_SBYTE: {
-        *output = UA_STRING_ALLOC("signed byte");
-        break;
+    retval |= UA_PrintContext_addString(ctx, "(");
+    retval |= UA_PrintContext_addString(ctx, dataType->typeName);
+    retval |= UA_PrintContext_addString(ctx, "[");
+    retval |= printUInt32(ctx, (UA_UInt32)length);
+    retval |= UA_PrintContext_addString(ctx, "]) {");
+    if (sink)
+        retval |= writePrintContext(ctx, sink);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+    for (size_t i = 0; i < workers; i++) {
+        threads.push_back(std::thread([&]() {
+            const UA_Boolean profiled = profileAttach(profilePath);
+            for (size_t chunk = nextChunk.fetch_add(1); chunk < chunks; chunk = nextChunk.fetch_add(1)) {
+                printChunk_t* slot = &slots[chunk % window];
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    chunkConsumed.wait(lock, [&]() { return cancelled || chunk < consumed + window; });
+                    if (cancelled)
+                        break;
+                }
+                // the slot belongs to this worker until the chunk is ready
+                printArrayChunk(slot, data, printElement, chunk * UA_PRINT_CHUNKSIZE, ctx->depth + 1);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    slot->ready = true;
+                }
+                chunkReady.notify_all();
+            }
+            if (profiled)
+                profileDetach(&profileChildTime, &profileAllocations);
+        }));
+    }
+    for (size_t chunk = 0; chunk < chunks && retval == UA_STATUSCODE_GOOD; chunk++) {
+        printChunk_t* slot = &slots[chunk % window];
+        if (workers) {
+            std::unique_lock<std::mutex> lock(mutex);
+            chunkReady.wait(lock, [&]() { return slot->ready; });
+        }
+        else
+            printArrayChunk(slot, data, printElement, chunk * UA_PRINT_CHUNKSIZE, ctx->depth + 1);
+        retval |= slot->retval;
+        if (sink && retval == UA_STATUSCODE_GOOD)
+            retval = writePrintContext(&slot->ctx, sink);
+        else if (sink || retval != UA_STATUSCODE_GOOD)
+            clearPrintContext(&slot->ctx);
+        else
+            TAILQ_CONCAT(&ctx->outputs, &slot->ctx.outputs, next);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            slot->ready = false;
+            consumed++;
+            cancelled = retval != UA_STATUSCODE_GOOD;
+        }
+        chunkConsumed.notify_all();
     }
-    case UA_DATATYPEKIND_BYTE: {
+    for (std::thread& thread : threads)
+        thread.join();
+    profileAddWorkers(profileChildTime.load(), profileAllocations.load());
+    // chunks formatted ahead of a failed chunk
+    for (printChunk_t& slot : slots) {
+        if (slot.ready)
+            clearPrintContext(&slot.ctx);
+    }
+    retval |= UA_PrintContext_addNewlineTabs(ctx, ctx->depth);
+    retval |= UA_PrintContext_addString(ctx, "}");
+    return retval;
+}
+
+// subfunction of UA_PrintStructure and UA_PrintStructureToSink, prints a scalar or an array of a custom structure
+static UA_StatusCode printStructureVariant(UA_PrintContext* ctx, const UA_Variant* data, UA_OutputSink* sink) {
+    const UA_DataType* dataType = data->type;
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+
+    const UA_Boolean profiled = profileEnterType(dataType);
+    retval |= UA_PrintContext_addString(ctx, "{");
+    ctx->depth++;
+#ifdef UA_ENABLE_TYPEDESCRIPTION
+    retval |= UA_PrintContext_addNewlineTabs(ctx, ctx->depth);
+    retval |= UA_PrintContext_addName(ctx, "DataType");
+    retval |= UA_PrintContext_addString(ctx, dataType->typeName);
+    retval |= UA_PrintContext_addString(ctx, ",");
+#endif
+    retval |= UA_PrintContext_addNewlineTabs(ctx, ctx->depth);
+    retval |= UA_PrintContext_addName(ctx, "Value");
+    if (UA_Variant_isScalar(data))
+        retval |= printStructureElement(ctx, dataType, data->data);
+    else
+        retval |= printCustomArray(ctx, data, printStructureElement, sink);
+    ctx->depth--;
+    retval |= UA_PrintContext_addNewlineTabs(ctx, ctx->depth);
+    retval |= UA_PrintContext_addString(ctx, "}");
+    if (profiled)
+        profileLeave(UA_Variant_isScalar(data) ? UA_calcSizeBinary(data->data, dataType) : profileArraySize(data->data, data->arrayLength, dataType));
+    return retval;
+}
+
+// subfunction of UA_PrintUnion and UA_PrintUnionToSink, prints a scalar or an array of a custom union
+static UA_StatusCode printUnionVariant(UA_PrintContext* ctx, const UA_Variant* data, UA_OutputSink* sink) {
+    const UA_DataType* dataType = data->type;
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+
+    const UA_Boolean profiled = profileEnterType(dataType);
+    retval |= UA_PrintContext_addString(ctx, "{");
+    ctx->depth++;
+
+#ifdef UA_ENABLE_TYPEDESCRIPTION
+    retval |= UA_PrintContext_addNewlineTabs(ctx, ctx->depth);
+    retval |= UA_PrintContext_addName(ctx, "DataType");
+    retval |= UA_PrintContext_addString(ctx, dataType->typeName);
+    retval |= UA_PrintContext_addString(ctx, ",");
+#endif
+    retval |= UA_PrintContext_addNewlineTabs(ctx, ctx->depth);
+    if (UA_Variant_isScalar(data))
+        retval |= printUnionFields(ctx, dataType, data->data);
+    else {
+        retval |= UA_PrintContext_addName(ctx, "Value");
+        retval |= printCustomArray(ctx, data, printUnionElement, sink);
+    }
+    ctx->depth--;
+    retval |= UA_PrintContext_addNewlineTabs(ctx, ctx->depth);
+    retval |= UA_PrintContext_addString(ctx, "}");
+    if (profiled)
+        profileLeave(UA_Variant_isScalar(data) ? UA_calcSizeBinary(data->data, dataType) : profileArraySize(data->data, data->arrayLength, dataType));
+    return retval;
+}
+
+// copies the outputs of a print context into output and frees them
+static UA_StatusCode joinPrintContext(UA_PrintContext* ctx, UA_StatusCode retval, UA_String* output) {
+    /* Allocate memory for the output */
+    if (retval == UA_STATUSCODE_GOOD) {
+        size_t total = 0;
+        UA_PrintOutput* out;
+        TAILQ_FOREACH(out, &ctx->outputs, next)
+            total += out->length;
+        retval = UA_ByteString_allocBuffer((UA_String*)output, total);
+    }
+    /* Write the output */
+    if (retval == UA_STATUSCODE_GOOD) {
+        size_t pos = 0;
+        UA_PrintOutput* out;
+        TAILQ_FOREACH(out, &ctx->outputs, next) {
+            memcpy(&output->data[pos], out->data, out->length);
+            pos += out->length;
+        }
+    }
+    /* Free the context */
+    clearPrintContext(ctx);
+    return retval;
+}
+
+// prints variant data type STRUCTURE to UA_String
+// arrays are printed element by element, large arrays are formatted in parallel (see printCustomArray)
+UA_StatusCode UA_PrintStructure(const UA_Variant* data, UA_String* output) {
+    UA_PrintContext ctx;
+    UA_StatusCode retval;
+
+    if (!data) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintStructure: Parameter 1 (UA_Variant*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!output) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintStructure: Parameter 2 (UA_String*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    ctx = UA_PrintContext();
+    ctx.depth = 0;
+    TAILQ_INIT(&ctx.outputs);
+    UA_String_init(output);
+    if (!data->type) {
+        *output = UA_STRING_ALLOC("NullVariant");
+        return UA_STATUSCODE_GOOD;
+    }
+    retval = printStructureVariant(&ctx, data, 0x0);
+    return joinPrintContext(&ctx, retval, output);
+}
+
+// prints variant data type STRUCTURE to a sink like UA_PrintStructure
+// the output of arrays is streamed batch by batch, so arrays of any size are printed with bounded memory
+UA_StatusCode UA_PrintStructureToSink(const UA_Variant* data, UA_OutputSink* sink) {
+    UA_PrintContext ctx;
+    UA_StatusCode retval;
+
+    if (!data) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintStructureToSink: Parameter 1 (UA_Variant*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!sink || !sink->callback) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintStructureToSink: Parameter 2 (UA_OutputSink*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!data->type)
+        return UA_OutputSink_write(sink, "NullVariant", 11);
+    ctx = UA_PrintContext();
+    ctx.depth = 0;
+    TAILQ_INIT(&ctx.outputs);
+    retval = printStructureVariant(&ctx, data, sink);
+    if (retval == UA_STATUSCODE_GOOD)
+        return writePrintContext(&ctx, sink);
+    clearPrintContext(&ctx);
+    return retval;
+}
+
+// prints data type kind name to string
+void UA_PrintTypeKind(UA_UInt32 typeKind, UA_String* output) {
+    if (!output) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintTypeKind: Parameter 2 (UA_String*) invalid");
+        return;
+    }
+    switch (typeKind) {
+    case UA_DATATYPEKIND_BOOLEAN: {
+        *output = UA_STRING_ALLOC("boolean");
+        break;
+    }
+    case UA_DATATYPEKIND_SBYTE: {
+        *output = UA_STRING_ALLOC("signed byte");
+        break;
+    }
+    case UA_DATATYPEKIND_BYTE: {
         *output = UA_STRING_ALLOC("unsigned byte");
         break;
     }
@@ -1778,316 +2433,6179 @@ void UA_PrintTypeKind(UA_UInt32 typeKind, UA_String* output) {
     case  UA_DATATYPEKIND_OPTSTRUCT/* struct with optional fields */: {
         *output = UA_STRING_ALLOC("structure with optional fields");
         break;
-    }
-    case UA_DATATYPEKIND_UNION: {
-        *output = UA_STRING_ALLOC("union");
+    }
+    case UA_DATATYPEKIND_UNION: {
+        *output = UA_STRING_ALLOC("union");
+        break;
+    }
+    case UA_DATATYPEKIND_BITFIELDCLUSTER /* bitfields + padding */: {
+        *output = UA_STRING_ALLOC("bitfields + padding");
+        break;
+    }
+    default: {
+        *output = UA_STRING_ALLOC("unknown");
+    }
+    }
+}
+
+// prints variant data type UNION to UA_String
+// arrays are printed element by element, large arrays are formatted in parallel (see printCustomArray)
+UA_StatusCode UA_PrintUnion(const UA_Variant* data, UA_String* output) {
+    UA_PrintContext ctx;
+    UA_StatusCode retval;
+
+    if (!data) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintUnion: Parameter 1 (UA_Variant*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!output) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintUnion: Parameter 2 (UA_String*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    ctx = UA_PrintContext();
+    ctx.depth = 0;
+    TAILQ_INIT(&ctx.outputs);
+    UA_String_init(output);
+    if (!data->type) {
+        *output = UA_STRING_ALLOC("NullVariant");
+        return UA_STATUSCODE_GOOD;
+    }
+    retval = printUnionVariant(&ctx, data, 0x0);
+    return joinPrintContext(&ctx, retval, output);
+}
+
+// prints variant data type UNION to a sink like UA_PrintUnion, arrays are streamed (see UA_PrintStructureToSink)
+UA_StatusCode UA_PrintUnionToSink(const UA_Variant* data, UA_OutputSink* sink) {
+    UA_PrintContext ctx;
+    UA_StatusCode retval;
+
+    if (!data) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintUnionToSink: Parameter 1 (UA_Variant*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!sink || !sink->callback) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintUnionToSink: Parameter 2 (UA_OutputSink*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!data->type)
+        return UA_OutputSink_write(sink, "NullVariant", 11);
+    ctx = UA_PrintContext();
+    ctx.depth = 0;
+    TAILQ_INIT(&ctx.outputs);
+    retval = printUnionVariant(&ctx, data, sink);
+    if (retval == UA_STATUSCODE_GOOD)
+        return writePrintContext(&ctx, sink);
+    clearPrintContext(&ctx);
+    return retval;
+}
+
+// copies the cached data type attribute of a variable to dataTypeId (to be cleared by the caller)
+// the copy is taken under the lock, readers of UA_ReaderPool replace entries concurrently
+// returns UA_STATUSCODE_BADNOTFOUND (and a null node ID) if the variable is not cached
+static UA_StatusCode lookupDataTypeId(const UA_NodeId* nodeId, UA_NodeId* dataTypeId) {
+    std::lock_guard<std::mutex> lock(dataTypeIdCacheMutex);
+    dataTypeIdCacheIt_t cacheIt = dataTypeIdCache.find(*nodeId);
+    if (cacheIt == dataTypeIdCache.end()) {
+        UA_NodeId_init(dataTypeId);
+        return UA_STATUSCODE_BADNOTFOUND;
+    }
+    return UA_NodeId_copy(&cacheIt->second, dataTypeId);
+}
+
+// stores the data type attribute of a variable in the cache
+static void storeDataTypeId(const UA_NodeId* nodeId, const UA_NodeId* dataTypeId) {
+    std::lock_guard<std::mutex> lock(dataTypeIdCacheMutex);
+    dataTypeIdCacheIt_t cacheIt = dataTypeIdCache.find(*nodeId);
+    UA_NodeId key;
+    if (cacheIt != dataTypeIdCache.end()) {
+        if (UA_NodeId_equal(&cacheIt->second, dataTypeId))
+            return;
+        UA_NodeId_clear(&cacheIt->second);
+        UA_NodeId_copy(dataTypeId, &cacheIt->second);
+        return;
+    }
+    if (UA_NodeId_copy(nodeId, &key) != UA_STATUSCODE_GOOD)
+        return;
+    cacheIt = dataTypeIdCache.emplace(key, UA_NODEID_NULL).first;
+    UA_NodeId_copy(dataTypeId, &cacheIt->second);
+}
+
+// copies the data type attribute of a variable from the cache to dataTypeId (to be cleared by the caller)
+// on a cache miss the attribute is read once from the server and cached
+static UA_StatusCode resolveDataTypeId(UA_Client* client, const UA_NodeId* nodeId, UA_NodeId* dataTypeId) {
+    UA_StatusCode retval = lookupDataTypeId(nodeId, dataTypeId);
+    UA_UInt64 started;
+    metricsCount(retval == UA_STATUSCODE_GOOD ? UA_COUNTER_CACHEHITS : UA_COUNTER_CACHEMISSES, 1);
+    if (retval == UA_STATUSCODE_GOOD)
+        return retval;
+    started = metricsStart();
+    retval = UA_Client_readDataTypeAttribute(client, *nodeId, dataTypeId);
+    metricsRecord(UA_HISTOGRAM_READ, started);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+    storeDataTypeId(nodeId, dataTypeId);
+    return retval;
+}
+
+// removes a variable from the data type cache, 0x0 clears the whole cache
+// has to be called if the data type of a variable changed or the client is connected to another server
+// must not be called while values are printed in other threads
+void UA_DataTypeCache_invalidate(const UA_NodeId* nodeId) {
+    std::lock_guard<std::mutex> lock(dataTypeIdCacheMutex);
+    dataTypeIdCacheIt_t cacheIt;
+    if (nodeId) {
+        cacheIt = dataTypeIdCache.find(*nodeId);
+        if (cacheIt == dataTypeIdCache.end())
+            return;
+        // the key is cleared after the entry is removed, the hash of the container needs it
+        UA_NodeId key = cacheIt->first;
+        UA_NodeId_clear(&cacheIt->second);
+        dataTypeIdCache.erase(cacheIt);
+        UA_NodeId_clear(&key);
+        return;
+    }
+    for (cacheIt = dataTypeIdCache.begin(); cacheIt != dataTypeIdCache.end(); ++cacheIt) {
+        UA_NodeId_clear((UA_NodeId*)&cacheIt->first);
+        UA_NodeId_clear(&cacheIt->second);
+    }
+    dataTypeIdCache.clear();
+}
+
+// prints values of custom and base data types to UA_String
+// dataTypeId is the data type attribute of the variable (0x0 if unknown), enumerations need it to resolve the names
+static UA_StatusCode printValueOfDataType(const UA_NodeId* dataTypeId, UA_Variant* data, UA_String* output) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    // STRUCTURE / STRUCTURE WITH OPTINAL FIELDS / UNION / OPTION SET
+    if (data->type->typeKind == UA_DATATYPEKIND_STRUCTURE || data->type->typeKind == UA_DATATYPEKIND_OPTSTRUCT)
+        retval = UA_PrintStructure(data, output);
+    // ENUM
+    else if (UA_NodeId_equal(&data->type->typeId, &NS0ID_INT32) && !data->type->membersSize && !data->arrayLength) {
+        typePropIt_t typePropIt = dataTypeMap.end();
+        if (dataTypeId)
+            typePropIt = dataTypeMap.find(UA_NodeId_SDBMHash(dataTypeId));
+        if (typePropIt != dataTypeMap.end() && typePropIt->second.enumValuesSize)
+            retval = UA_PrintEnum(data, &typePropIt->second, output);
+        else
+            retval = UA_print(data, &UA_TYPES[UA_TYPES_VARIANT], output);
+    }
+    // UNION
+    else if (data->type->typeKind == UA_DATATYPEKIND_UNION)
+        retval = UA_PrintUnion(data, output);
+    // FALLBACK
+    else
+        retval = UA_print(data, &UA_TYPES[UA_TYPES_VARIANT], output);
+    return retval;
+}
+
+// prints values of custom and base data types to UA_String
+UA_StatusCode UA_PrintValue(UA_Client* client, UA_NodeId nodeId, UA_Variant* data, UA_String* output) {
+    if (!client) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_printValue: Client session invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (UA_NodeId_isNull(&nodeId)) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_printValue: Parameter 2 (UA_NodeId) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!data) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_printValue: Parameter 3 (UA_Variant*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!output) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_printValue: Parameter 4 (UA_String*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    // ENUM (the data type attribute of the node tells the enumeration)
+    UA_NodeId dataTypeId = UA_NODEID_NULL;
+    UA_Boolean hasDataTypeId = false;
+    if (UA_NodeId_equal(&data->type->typeId, &NS0ID_INT32) && !data->type->membersSize && !data->arrayLength)
+        hasDataTypeId = resolveDataTypeId(client, &nodeId, &dataTypeId) == UA_STATUSCODE_GOOD;
+    UA_UInt64 started = metricsStart();
+    UA_StatusCode retval = printValueOfDataType(hasDataTypeId ? &dataTypeId : 0x0, data, output);
+    metricsRecordPrint(started, hasDataTypeId ? &dataTypeId : 0x0, data);
+    UA_NodeId_clear(&dataTypeId);
+    return retval;
+}
+
+// returns the context information of a custom data type or 0x0 for unknown data types
+static customTypeProperties_t* findCustomTypeProperties(const UA_NodeId* typeId) {
+    typePropIt_t typePropIt;
+    if (!typeId)
+        return 0x0;
+    typePropIt = dataTypeMap.find(UA_NodeId_SDBMHash(typeId));
+    if (typePropIt == dataTypeMap.end())
+        return 0x0;
+    return &typePropIt->second;
+}
+
+// checks whether the data type has the memory layout of an option set (Value and ValidBits)
+static UA_Boolean isOptionSetLayout(const UA_DataType* dataType) {
+    return dataType->membersSize == 2 &&
+        UA_NodeId_equal(&dataType->members[0].memberType->typeId, &NS0ID_BYTESTRING) &&
+        UA_NodeId_equal(&dataType->members[1].memberType->typeId, &NS0ID_BYTESTRING);
+}
+
+// initializes a streaming output sink, the callback receives the buffered output
+void UA_OutputSink_init(UA_OutputSink* sink, UA_OutputSinkCallback callback, void* sinkContext) {
+    if (!sink) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_OutputSink_init: Parameter 1 (UA_OutputSink*) invalid");
+        return;
+    }
+    sink->callback = callback;
+    sink->sinkContext = sinkContext;
+    sink->length = 0;
+}
+
+// passes the buffered output of the sink to its callback
+UA_StatusCode UA_OutputSink_flush(UA_OutputSink* sink) {
+    UA_StatusCode retval;
+    if (!sink || !sink->callback) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_OutputSink_flush: Parameter 1 (UA_OutputSink*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!sink->length)
+        return UA_STATUSCODE_GOOD;
+    retval = sink->callback(sink->sinkContext, sink->buffer, sink->length);
+    sink->length = 0;
+    return retval;
+}
+
+// appends data to the buffer of the sink, blocks larger than the buffer are passed through
+UA_StatusCode UA_OutputSink_write(UA_OutputSink* sink, const void* data, size_t length) {
+    UA_StatusCode retval;
+    if (sink->length + length > UA_OUTPUTSINK_BUFFERSIZE) {
+        retval = UA_OutputSink_flush(sink);
+        if (retval != UA_STATUSCODE_GOOD)
+            return retval;
+        if (length > UA_OUTPUTSINK_BUFFERSIZE)
+            return sink->callback(sink->sinkContext, (const UA_Byte*)data, length);
+    }
+    memcpy(&sink->buffer[sink->length], data, length);
+    sink->length += length;
+    return UA_STATUSCODE_GOOD;
+}
+
+// sink callback writing to a file opened by the caller (sinkContext is a FILE*)
+UA_StatusCode UA_OutputSink_writeFile(void* sinkContext, const UA_Byte* data, size_t length) {
+    if (!sinkContext)
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    if (fwrite(data, 1, length, (FILE*)sinkContext) != length)
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
+static inline UA_StatusCode jsonWriteChar(UA_OutputSink* sink, char c) {
+    if (sink->length >= UA_OUTPUTSINK_BUFFERSIZE) {
+        UA_StatusCode retval = UA_OutputSink_flush(sink);
+        if (retval != UA_STATUSCODE_GOOD)
+            return retval;
+    }
+    sink->buffer[sink->length++] = (UA_Byte)c;
+    return UA_STATUSCODE_GOOD;
+}
+
+static inline UA_StatusCode jsonWriteRaw(UA_OutputSink* sink, const char* str) {
+    return UA_OutputSink_write(sink, str, strlen(str));
+}
+
+// writes the content of a JSON string (without quotes), control characters, quotes and backslashes are escaped
+static UA_StatusCode jsonWriteEscapedBody(UA_OutputSink* sink, const UA_Byte* data, size_t length) {
+    static const char hexDigits[] = "0123456789abcdef";
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    size_t begin = 0;
+    for (size_t i = 0; i < length && retval == UA_STATUSCODE_GOOD; i++) {
+        UA_Byte c = data[i];
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+        // write unescaped characters as one block
+        retval |= UA_OutputSink_write(sink, &data[begin], i - begin);
+        begin = i + 1;
+        switch (c) {
+        case '"': retval |= UA_OutputSink_write(sink, "\\\"", 2); break;
+        case '\\': retval |= UA_OutputSink_write(sink, "\\\\", 2); break;
+        case '\n': retval |= UA_OutputSink_write(sink, "\\n", 2); break;
+        case '\r': retval |= UA_OutputSink_write(sink, "\\r", 2); break;
+        case '\t': retval |= UA_OutputSink_write(sink, "\\t", 2); break;
+        default: {
+            char escaped[6] = { '\\', 'u', '0', '0', hexDigits[c >> 4], hexDigits[c & 0x0F] };
+            retval |= UA_OutputSink_write(sink, escaped, sizeof(escaped));
+        }
+        }
+    }
+    if (retval == UA_STATUSCODE_GOOD && begin < length)
+        retval = UA_OutputSink_write(sink, &data[begin], length - begin);
+    return retval;
+}
+
+// writes a quoted JSON string
+static UA_StatusCode jsonWriteEscaped(UA_OutputSink* sink, const UA_Byte* data, size_t length) {
+    UA_StatusCode retval;
+    retval = jsonWriteChar(sink, '"');
+    retval |= jsonWriteEscapedBody(sink, data, length);
+    retval |= jsonWriteChar(sink, '"');
+    return retval;
+}
+
+static UA_StatusCode jsonWriteString(UA_OutputSink* sink, const UA_String* str) {
+    if (!str->data)
+        return jsonWriteRaw(sink, "null");
+    if (str->data == UA_EMPTY_ARRAY_SENTINEL)
+        return UA_OutputSink_write(sink, "\"\"", 2);
+    return jsonWriteEscaped(sink, str->data, str->length);
+}
+
+// writes integers with std::to_chars (locale independent, no allocation)
+template <typename T>
+static UA_StatusCode jsonWriteInteger(UA_OutputSink* sink, T value) {
+    char out[24];
+    std::to_chars_result result = std::to_chars(out, out + sizeof(out), value);
+    return UA_OutputSink_write(sink, out, result.ptr - out);
+}
+
+// writes floating point numbers with the shortest representation that round-trips
+// NaN and infinity are not valid JSON numbers and are written as strings
+template <typename T>
+static UA_StatusCode jsonWriteFloat(UA_OutputSink* sink, T value) {
+    char out[32];
+    if (std::isnan(value))
+        return jsonWriteRaw(sink, "\"NaN\"");
+    if (std::isinf(value))
+        return jsonWriteRaw(sink, value < 0 ? "\"-Infinity\"" : "\"Infinity\"");
+    std::to_chars_result result = std::to_chars(out, out + sizeof(out), value);
+    return UA_OutputSink_write(sink, out, result.ptr - out);
+}
+
+// writes the content of a byte string as Base64 (without quotes)
+static UA_StatusCode jsonWriteBase64Body(UA_OutputSink* sink, const UA_Byte* data, size_t length) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    char out[4];
+    size_t i = 0;
+    for (; i + 2 < length && retval == UA_STATUSCODE_GOOD; i += 3) {
+        UA_UInt32 triple = ((UA_UInt32)data[i] << 16) | ((UA_UInt32)data[i + 1] << 8) | data[i + 2];
+        out[0] = alphabet[(triple >> 18) & 0x3F];
+        out[1] = alphabet[(triple >> 12) & 0x3F];
+        out[2] = alphabet[(triple >> 6) & 0x3F];
+        out[3] = alphabet[triple & 0x3F];
+        retval |= UA_OutputSink_write(sink, out, 4);
+    }
+    if (retval == UA_STATUSCODE_GOOD && i < length) {
+        UA_UInt32 triple = (UA_UInt32)data[i] << 16;
+        if (i + 1 < length)
+            triple |= (UA_UInt32)data[i + 1] << 8;
+        out[0] = alphabet[(triple >> 18) & 0x3F];
+        out[1] = alphabet[(triple >> 12) & 0x3F];
+        out[2] = i + 1 < length ? alphabet[(triple >> 6) & 0x3F] : '=';
+        out[3] = '=';
+        retval |= UA_OutputSink_write(sink, out, 4);
+    }
+    return retval;
+}
+
+static UA_StatusCode jsonWriteByteString(UA_OutputSink* sink, const UA_ByteString* bytes) {
+    UA_StatusCode retval;
+    if (!bytes->data)
+        return jsonWriteRaw(sink, "null");
+    retval = jsonWriteChar(sink, '"');
+    if (bytes->data != UA_EMPTY_ARRAY_SENTINEL)
+        retval |= jsonWriteBase64Body(sink, bytes->data, bytes->length);
+    retval |= jsonWriteChar(sink, '"');
+    return retval;
+}
+
+// writes fixed width hex digits (without quotes)
+static UA_StatusCode jsonWriteHex(UA_OutputSink* sink, UA_UInt64 value, UA_Byte digits) {
+    static const char hexDigits[] = "0123456789abcdef";
+    char out[16];
+    for (UA_Byte i = digits; i > 0; i--) {
+        out[i - 1] = hexDigits[value & 0x0F];
+        value >>= 4;
+    }
+    return UA_OutputSink_write(sink, out, digits);
+}
+
+// writes GUID as xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx (without quotes)
+static UA_StatusCode jsonWriteGuidBody(UA_OutputSink* sink, const UA_Guid* guid) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    retval |= jsonWriteHex(sink, guid->data1, 8);
+    retval |= jsonWriteChar(sink, '-');
+    retval |= jsonWriteHex(sink, guid->data2, 4);
+    retval |= jsonWriteChar(sink, '-');
+    retval |= jsonWriteHex(sink, guid->data3, 4);
+    retval |= jsonWriteChar(sink, '-');
+    for (UA_Byte i = 0; i < 8; i++) {
+        if (i == 2)
+            retval |= jsonWriteChar(sink, '-');
+        retval |= jsonWriteHex(sink, guid->data4[i], 2);
+    }
+    return retval;
+}
+
+// writes node ID in the OPC UA string notation, e.g. "ns=2;s=Demo.Static"
+static UA_StatusCode jsonWriteNodeId(UA_OutputSink* sink, const UA_NodeId* nodeId, const UA_String* namespaceUri, UA_UInt32 serverIndex) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    retval |= jsonWriteChar(sink, '"');
+    if (serverIndex) {
+        retval |= jsonWriteRaw(sink, "svr=");
+        retval |= jsonWriteInteger(sink, serverIndex);
+        retval |= jsonWriteChar(sink, ';');
+    }
+    if (namespaceUri && namespaceUri->length) {
+        retval |= jsonWriteRaw(sink, "nsu=");
+        retval |= jsonWriteEscapedBody(sink, namespaceUri->data, namespaceUri->length);
+        retval |= jsonWriteChar(sink, ';');
+    }
+    else if (nodeId->namespaceIndex) {
+        retval |= jsonWriteRaw(sink, "ns=");
+        retval |= jsonWriteInteger(sink, nodeId->namespaceIndex);
+        retval |= jsonWriteChar(sink, ';');
+    }
+    switch (nodeId->identifierType) {
+    case UA_NODEIDTYPE_NUMERIC:
+        retval |= jsonWriteRaw(sink, "i=");
+        retval |= jsonWriteInteger(sink, nodeId->identifier.numeric);
+        break;
+    case UA_NODEIDTYPE_STRING:
+        retval |= jsonWriteRaw(sink, "s=");
+        retval |= jsonWriteEscapedBody(sink, nodeId->identifier.string.data, nodeId->identifier.string.length);
+        break;
+    case UA_NODEIDTYPE_GUID:
+        retval |= jsonWriteRaw(sink, "g=");
+        retval |= jsonWriteGuidBody(sink, &nodeId->identifier.guid);
+        break;
+    case UA_NODEIDTYPE_BYTESTRING:
+        retval |= jsonWriteRaw(sink, "b=");
+        retval |= jsonWriteBase64Body(sink, nodeId->identifier.byteString.data, nodeId->identifier.byteString.length);
+        break;
+    }
+    retval |= jsonWriteChar(sink, '"');
+    return retval;
+}
+
+// writes date time as ISO 8601 string in UTC, e.g. "2021-06-01T12:00:00.000Z"
+static UA_StatusCode jsonWriteDateTime(UA_OutputSink* sink, UA_DateTime dateTime) {
+    UA_DateTimeStruct dts = UA_DateTime_toStruct(dateTime);
+    char out[26];
+    const UA_UInt16 fields[7] = { dts.year, dts.month, dts.day, dts.hour, dts.min, dts.sec, dts.milliSec };
+    const UA_Byte widths[7] = { 4, 2, 2, 2, 2, 2, 3 };
+    const char separators[7] = { '-', '-', 'T', ':', ':', '.', 'Z' };
+    size_t pos = 0;
+    out[pos++] = '"';
+    for (UA_Byte i = 0; i < 7; i++) {
+        UA_UInt16 value = fields[i];
+        for (UA_Byte j = widths[i]; j > 0; j--) {
+            out[pos + j - 1] = (char)('0' + value % 10);
+            value /= 10;
+        }
+        pos += widths[i];
+        out[pos++] = separators[i];
+    }
+    out[pos++] = '"';
+    return UA_OutputSink_write(sink, out, pos);
+}
+
+// writes the key of a JSON object member, a separator is written for all keys but the first one
+static UA_StatusCode jsonWriteKey(UA_OutputSink* sink, const char* key, UA_Boolean* first) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    if (!*first)
+        retval |= jsonWriteChar(sink, ',');
+    *first = false;
+    if (!key)
+        key = "???";
+    retval |= jsonWriteEscaped(sink, (const UA_Byte*)key, strlen(key));
+    retval |= jsonWriteChar(sink, ':');
+    return retval;
+}
+
+// writes the member name of a data type as key (index of the member if type descriptions are disabled)
+static UA_StatusCode jsonWriteMemberKey(UA_OutputSink* sink, const UA_DataTypeMember* dataTypeMember, size_t index, UA_Boolean* first) {
+#ifdef UA_ENABLE_TYPEDESCRIPTION
+    (void)index;
+    return jsonWriteKey(sink, dataTypeMember->memberName, first);
+#else
+    char key[24];
+    (void)dataTypeMember;
+    *std::to_chars(key, key + sizeof(key) - 1, index).ptr = '\0';
+    return jsonWriteKey(sink, key, first);
+#endif
+}
+
+static UA_StatusCode jsonEncodeType(UA_OutputSink* sink, const void* p, const UA_DataType* type);
+
+// writes an enumeration value as its name, undeclared values are written as number
+static UA_StatusCode jsonEncodeEnum(UA_OutputSink* sink, UA_Int32 value, const customTypeProperties_t* customTypeProperties) {
+    const UA_String* name = findEnumValueName(customTypeProperties, value);
+    if (!name)
+        return jsonWriteInteger(sink, value);
+    return jsonWriteString(sink, name);
+}
+
+static UA_StatusCode jsonEncodeArray(UA_OutputSink* sink, const void* p, size_t length, const UA_DataType* type) {
+    UA_StatusCode retval;
+    uintptr_t target = (uintptr_t)p;
+    if (!p)
+        return jsonWriteRaw(sink, "null");
+    retval = jsonWriteChar(sink, '[');
+    if (type->typeKind == UA_DATATYPEKIND_ENUM) {
+        // resolve enumeration names only once per array
+        const customTypeProperties_t* customTypeProperties = findCustomTypeProperties(&type->typeId);
+        for (size_t i = 0; i < length && retval == UA_STATUSCODE_GOOD; i++) {
+            if (i)
+                retval |= jsonWriteChar(sink, ',');
+            retval |= jsonEncodeEnum(sink, ((const UA_Int32*)p)[i], customTypeProperties);
+        }
+    }
+    else {
+        for (size_t i = 0; i < length && retval == UA_STATUSCODE_GOOD; i++) {
+            if (i)
+                retval |= jsonWriteChar(sink, ',');
+            retval |= jsonEncodeType(sink, (const void*)target, type);
+            target += type->memSize;
+        }
+    }
+    retval |= jsonWriteChar(sink, ']');
+    return retval;
+}
+
+// writes an option set as object of flags, e.g. {"Bit0":true,"Bit1":false}
+static UA_StatusCode jsonEncodeOptionSet(UA_OutputSink* sink, const void* p, const UA_DataType* type, const customTypeProperties_t* customTypeProperties) {
+    UA_StatusCode retval;
+    UA_Boolean first = true;
+    uintptr_t ptrs = (uintptr_t)p;
+    const UA_ByteString* value;
+    const UA_ByteString* validBits;
+    ptrs += type->members[0].padding;
+    value = (const UA_ByteString*)ptrs;
+    ptrs += sizeof(UA_ByteString) + type->members[1].padding;
+    validBits = (const UA_ByteString*)ptrs;
+    retval = jsonWriteChar(sink, '{');
+    for (size_t j = 0; j < customTypeProperties->optionBitsSize && retval == UA_STATUSCODE_GOOD; j++) {
+        const UA_String* name = getOptionBitName(customTypeProperties, j);
+        size_t byteIndex = j / 8;
+        UA_Byte mask = (UA_Byte)(0x01 << (j % 8));
+        UA_Boolean isSet = value->data && byteIndex < value->length && (value->data[byteIndex] & mask);
+        // missing valid bits mark all bits as valid
+        if (validBits->data && validBits->length)
+            isSet = isSet && byteIndex < validBits->length && (validBits->data[byteIndex] & mask);
+        if (!first)
+            retval |= jsonWriteChar(sink, ',');
+        first = false;
+        retval |= jsonWriteEscaped(sink, name->data, name->length);
+        retval |= jsonWriteChar(sink, ':');
+        retval |= jsonWriteRaw(sink, isSet ? "true" : "false");
+    }
+    retval |= jsonWriteChar(sink, '}');
+    return retval;
+}
+
+// writes structures and structures with optional fields as object, disabled optional fields are null
+static UA_StatusCode jsonEncodeStructure(UA_OutputSink* sink, const void* p, const UA_DataType* type) {
+    UA_StatusCode retval;
+    UA_Boolean first = true;
+    uintptr_t ptrs = (uintptr_t)p;
+    if (isOptionSetLayout(type)) {
+        const customTypeProperties_t* customTypeProperties = findCustomTypeProperties(&type->typeId);
+        if (customTypeProperties && isOptionSet(&customTypeProperties->subTypeOfId))
+            return jsonEncodeOptionSet(sink, p, type, customTypeProperties);
+    }
+    retval = jsonWriteChar(sink, '{');
+    for (size_t i = 0; i < type->membersSize && retval == UA_STATUSCODE_GOOD; i++) {
+        const UA_DataTypeMember* dataTypeMember = &type->members[i];
+        retval |= jsonWriteMemberKey(sink, dataTypeMember, i, &first);
+        ptrs += dataTypeMember->padding;
+        if (dataTypeMember->isArray) {
+            const size_t size = *((const size_t*)ptrs);
+            ptrs += sizeof(size_t);
+            retval |= jsonEncodeArray(sink, *(void* const*)ptrs, size, dataTypeMember->memberType);
+            ptrs += sizeof(void*);
+        }
+        else if (dataTypeMember->isOptional) {
+            if (*(void* const*)ptrs)
+                retval |= jsonEncodeType(sink, *(void* const*)ptrs, dataTypeMember->memberType);
+            else
+                retval |= jsonWriteRaw(sink, "null");
+            ptrs += sizeof(void*);
+        }
+        else {
+            retval |= jsonEncodeType(sink, (const void*)ptrs, dataTypeMember->memberType);
+            ptrs += dataTypeMember->memberType->memSize;
+        }
+    }
+    retval |= jsonWriteChar(sink, '}');
+    return retval;
+}
+
+// writes an union as tagged object, e.g. {"SwitchValue":2,"Name":"Field2","Value":42}
+static UA_StatusCode jsonEncodeUnion(UA_OutputSink* sink, const void* p, const UA_DataType* type) {
+    UA_StatusCode retval;
+    UA_Boolean first = true;
+    UA_UInt32 switchIndex = *(const UA_UInt32*)p;
+    retval = jsonWriteChar(sink, '{');
+    retval |= jsonWriteKey(sink, "SwitchValue", &first);
+    retval |= jsonWriteInteger(sink, switchIndex);
+    if (switchIndex > 0 && switchIndex <= type->membersSize) {
+        const UA_DataTypeMember* dataTypeMember = &type->members[switchIndex - 1];
+        uintptr_t ptrs = (uintptr_t)p + dataTypeMember->padding;
+#ifdef UA_ENABLE_TYPEDESCRIPTION
+        retval |= jsonWriteKey(sink, "Name", &first);
+        retval |= jsonWriteEscaped(sink, (const UA_Byte*)dataTypeMember->memberName, dataTypeMember->memberName ? strlen(dataTypeMember->memberName) : 0);
+#endif
+        retval |= jsonWriteKey(sink, "Value", &first);
+        if (dataTypeMember->isArray) {
+            const size_t size = *((const size_t*)ptrs);
+            ptrs += sizeof(size_t);
+            retval |= jsonEncodeArray(sink, *(void* const*)ptrs, size, dataTypeMember->memberType);
+        }
+        else
+            retval |= jsonEncodeType(sink, (const void*)ptrs, dataTypeMember->memberType);
+    }
+    retval |= jsonWriteChar(sink, '}');
+    return retval;
+}
+
+static UA_StatusCode jsonEncodeVariant(UA_OutputSink* sink, const UA_Variant* data) {
+    if (!data->type || !data->data)
+        return jsonWriteRaw(sink, "null");
+    if (UA_Variant_isScalar(data))
+        return jsonEncodeType(sink, data->data, data->type);
+    if (data->data == UA_EMPTY_ARRAY_SENTINEL)
+        return jsonWriteRaw(sink, "[]");
+    return jsonEncodeArray(sink, data->data, data->arrayLength, data->type);
+}
+
+// writes a single value of any built-in or custom data type
+static UA_StatusCode jsonEncodeType(UA_OutputSink* sink, const void* p, const UA_DataType* type) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    UA_Boolean first = true;
+    switch (type->typeKind) {
+    case UA_DATATYPEKIND_BOOLEAN:
+        return jsonWriteRaw(sink, *(const UA_Boolean*)p ? "true" : "false");
+    case UA_DATATYPEKIND_SBYTE:
+        return jsonWriteInteger(sink, *(const UA_SByte*)p);
+    case UA_DATATYPEKIND_BYTE:
+        return jsonWriteInteger(sink, *(const UA_Byte*)p);
+    case UA_DATATYPEKIND_INT16:
+        return jsonWriteInteger(sink, *(const UA_Int16*)p);
+    case UA_DATATYPEKIND_UINT16:
+        return jsonWriteInteger(sink, *(const UA_UInt16*)p);
+    case UA_DATATYPEKIND_INT32:
+        return jsonWriteInteger(sink, *(const UA_Int32*)p);
+    case UA_DATATYPEKIND_UINT32:
+    case UA_DATATYPEKIND_STATUSCODE:
+        return jsonWriteInteger(sink, *(const UA_UInt32*)p);
+    case UA_DATATYPEKIND_INT64:
+        return jsonWriteInteger(sink, *(const UA_Int64*)p);
+    case UA_DATATYPEKIND_UINT64:
+        return jsonWriteInteger(sink, *(const UA_UInt64*)p);
+    case UA_DATATYPEKIND_FLOAT:
+        return jsonWriteFloat(sink, *(const UA_Float*)p);
+    case UA_DATATYPEKIND_DOUBLE:
+        return jsonWriteFloat(sink, *(const UA_Double*)p);
+    case UA_DATATYPEKIND_STRING:
+    case UA_DATATYPEKIND_XMLELEMENT:
+        return jsonWriteString(sink, (const UA_String*)p);
+    case UA_DATATYPEKIND_BYTESTRING:
+        return jsonWriteByteString(sink, (const UA_ByteString*)p);
+    case UA_DATATYPEKIND_DATETIME:
+        return jsonWriteDateTime(sink, *(const UA_DateTime*)p);
+    case UA_DATATYPEKIND_GUID:
+        retval |= jsonWriteChar(sink, '"');
+        retval |= jsonWriteGuidBody(sink, (const UA_Guid*)p);
+        retval |= jsonWriteChar(sink, '"');
+        return retval;
+    case UA_DATATYPEKIND_NODEID:
+        return jsonWriteNodeId(sink, (const UA_NodeId*)p, 0x0, 0);
+    case UA_DATATYPEKIND_EXPANDEDNODEID: {
+        const UA_ExpandedNodeId* expandedNodeId = (const UA_ExpandedNodeId*)p;
+        return jsonWriteNodeId(sink, &expandedNodeId->nodeId, &expandedNodeId->namespaceUri, expandedNodeId->serverIndex);
+    }
+    case UA_DATATYPEKIND_QUALIFIEDNAME: {
+        const UA_QualifiedName* qualifiedName = (const UA_QualifiedName*)p;
+        retval |= jsonWriteChar(sink, '{');
+        retval |= jsonWriteKey(sink, "NamespaceIndex", &first);
+        retval |= jsonWriteInteger(sink, qualifiedName->namespaceIndex);
+        retval |= jsonWriteKey(sink, "Name", &first);
+        retval |= jsonWriteString(sink, &qualifiedName->name);
+        retval |= jsonWriteChar(sink, '}');
+        return retval;
+    }
+    case UA_DATATYPEKIND_LOCALIZEDTEXT: {
+        const UA_LocalizedText* localizedText = (const UA_LocalizedText*)p;
+        retval |= jsonWriteChar(sink, '{');
+        retval |= jsonWriteKey(sink, "Locale", &first);
+        retval |= jsonWriteString(sink, &localizedText->locale);
+        retval |= jsonWriteKey(sink, "Text", &first);
+        retval |= jsonWriteString(sink, &localizedText->text);
+        retval |= jsonWriteChar(sink, '}');
+        return retval;
+    }
+    case UA_DATATYPEKIND_EXTENSIONOBJECT: {
+        const UA_ExtensionObject* extObj = (const UA_ExtensionObject*)p;
+        if (extObj->encoding == UA_EXTENSIONOBJECT_DECODED || extObj->encoding == UA_EXTENSIONOBJECT_DECODED_NODELETE) {
+            if (!extObj->content.decoded.type || !extObj->content.decoded.data)
+                return jsonWriteRaw(sink, "null");
+            return jsonEncodeType(sink, extObj->content.decoded.data, extObj->content.decoded.type);
+        }
+        if (extObj->encoding == UA_EXTENSIONOBJECT_ENCODED_NOBODY)
+            return jsonWriteRaw(sink, "null");
+        // undecoded body, e.g. unknown data type
+        retval |= jsonWriteChar(sink, '{');
+        retval |= jsonWriteKey(sink, "TypeId", &first);
+        retval |= jsonWriteNodeId(sink, &extObj->content.encoded.typeId, 0x0, 0);
+        retval |= jsonWriteKey(sink, "Body", &first);
+        if (extObj->encoding == UA_EXTENSIONOBJECT_ENCODED_XML)
+            retval |= jsonWriteString(sink, &extObj->content.encoded.body);
+        else
+            retval |= jsonWriteByteString(sink, &extObj->content.encoded.body);
+        retval |= jsonWriteChar(sink, '}');
+        return retval;
+    }
+    case UA_DATATYPEKIND_DATAVALUE: {
+        const UA_DataValue* dataValue = (const UA_DataValue*)p;
+        retval |= jsonWriteChar(sink, '{');
+        if (dataValue->hasValue) {
+            retval |= jsonWriteKey(sink, "Value", &first);
+            retval |= jsonEncodeVariant(sink, &dataValue->value);
+        }
+        if (dataValue->hasStatus) {
+            retval |= jsonWriteKey(sink, "Status", &first);
+            retval |= jsonWriteInteger(sink, dataValue->status);
+        }
+        if (dataValue->hasSourceTimestamp) {
+            retval |= jsonWriteKey(sink, "SourceTimestamp", &first);
+            retval |= jsonWriteDateTime(sink, dataValue->sourceTimestamp);
+        }
+        if (dataValue->hasServerTimestamp) {
+            retval |= jsonWriteKey(sink, "ServerTimestamp", &first);
+            retval |= jsonWriteDateTime(sink, dataValue->serverTimestamp);
+        }
+        retval |= jsonWriteChar(sink, '}');
+        return retval;
+    }
+    case UA_DATATYPEKIND_VARIANT:
+        return jsonEncodeVariant(sink, (const UA_Variant*)p);
+    case UA_DATATYPEKIND_DIAGNOSTICINFO: {
+        const UA_DiagnosticInfo* diagnosticInfo = (const UA_DiagnosticInfo*)p;
+        retval |= jsonWriteChar(sink, '{');
+        if (diagnosticInfo->hasSymbolicId) {
+            retval |= jsonWriteKey(sink, "SymbolicId", &first);
+            retval |= jsonWriteInteger(sink, diagnosticInfo->symbolicId);
+        }
+        if (diagnosticInfo->hasAdditionalInfo) {
+            retval |= jsonWriteKey(sink, "AdditionalInfo", &first);
+            retval |= jsonWriteString(sink, &diagnosticInfo->additionalInfo);
+        }
+        if (diagnosticInfo->hasInnerStatusCode) {
+            retval |= jsonWriteKey(sink, "InnerStatusCode", &first);
+            retval |= jsonWriteInteger(sink, diagnosticInfo->innerStatusCode);
+        }
+        retval |= jsonWriteChar(sink, '}');
+        return retval;
+    }
+    case UA_DATATYPEKIND_ENUM:
+        return jsonEncodeEnum(sink, *(const UA_Int32*)p, findCustomTypeProperties(&type->typeId));
+    case UA_DATATYPEKIND_STRUCTURE:
+    case UA_DATATYPEKIND_OPTSTRUCT:
+        return jsonEncodeStructure(sink, p, type);
+    case UA_DATATYPEKIND_UNION:
+        return jsonEncodeUnion(sink, p, type);
+    default:
+        // decimal and bit field clusters are not supported
+        return jsonWriteRaw(sink, "null");
+    }
+}
+
+// writes a value of any built-in or custom data type as JSON to the sink
+// the caller is responsible to flush the sink
+UA_StatusCode UA_PrintJson(const void* p, const UA_DataType* type, UA_OutputSink* sink) {
+    if (!p) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintJson: Parameter 1 (void*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!type) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintJson: Parameter 2 (UA_DataType*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!sink || !sink->callback) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintJson: Parameter 3 (UA_OutputSink*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    return jsonEncodeType(sink, p, type);
+}
+
+// writes a variant as JSON, dataTypeId is the data type attribute of the variable (0x0 if unknown)
+// enumerations are transferred as Int32, the data type attribute tells the enumeration
+static UA_StatusCode jsonEncodeValueOfDataType(UA_OutputSink* sink, const UA_NodeId* dataTypeId, const UA_Variant* data) {
+    UA_StatusCode retval;
+    const customTypeProperties_t* customTypeProperties;
+    if (!dataTypeId || !data->type || !data->data || !UA_NodeId_equal(&data->type->typeId, &NS0ID_INT32))
+        return jsonEncodeVariant(sink, data);
+    customTypeProperties = findCustomTypeProperties(dataTypeId);
+    if (!customTypeProperties || !customTypeProperties->enumValuesSize)
+        return jsonEncodeVariant(sink, data);
+    if (UA_Variant_isScalar(data))
+        return jsonEncodeEnum(sink, *(const UA_Int32*)data->data, customTypeProperties);
+    retval = jsonWriteChar(sink, '[');
+    for (size_t i = 0; i < data->arrayLength && retval == UA_STATUSCODE_GOOD; i++) {
+        if (i)
+            retval |= jsonWriteChar(sink, ',');
+        retval |= jsonEncodeEnum(sink, ((const UA_Int32*)data->data)[i], customTypeProperties);
+    }
+    retval |= jsonWriteChar(sink, ']');
+    return retval;
+}
+
+// writes values of custom and base data types as JSON to the sink (streaming counterpart of UA_PrintValue)
+// structures are mapped to objects, unions to tagged objects, enumerations to names and option sets to flag objects
+// the caller is responsible to flush the sink
+UA_StatusCode UA_PrintValueJson(UA_Client* client, UA_NodeId nodeId, UA_Variant* data, UA_OutputSink* sink) {
+    if (!client) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintValueJson: Client session invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (UA_NodeId_isNull(&nodeId)) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintValueJson: Parameter 2 (UA_NodeId) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!data) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintValueJson: Parameter 3 (UA_Variant*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!sink || !sink->callback) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintValueJson: Parameter 4 (UA_OutputSink*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    const UA_Boolean isEnum = data->type && UA_NodeId_equal(&data->type->typeId, &NS0ID_INT32) && data->data;
+    UA_NodeId dataTypeId = UA_NODEID_NULL;
+    const UA_Boolean hasDataTypeId = isEnum && resolveDataTypeId(client, &nodeId, &dataTypeId) == UA_STATUSCODE_GOOD;
+    UA_StatusCode retval;
+    UA_UInt64 started = metricsStart();
+    if (isEnum)
+        retval = jsonEncodeValueOfDataType(sink, hasDataTypeId ? &dataTypeId : 0x0, data);
+    else
+        retval = jsonEncodeVariant(sink, data);
+    metricsRecordPrint(started, hasDataTypeId ? &dataTypeId : 0x0, data);
+    UA_NodeId_clear(&dataTypeId);
+    return retval;
+}
+
+// collects the scalar leaf fields of a structure including the leaves of embedded structures
+// optional fields, arrays, unions, option sets and unsupported built-in types are skipped
+static void collectScalarLeaves(const UA_DataType* type, const std::string& prefix, size_t baseOffset, std::vector<UA_Column>* columns) {
+    size_t offset = baseOffset;
+    for (size_t i = 0; i < type->membersSize; i++) {
+        const UA_DataTypeMember* dataTypeMember = &type->members[i];
+        const UA_DataType* memberType = dataTypeMember->memberType;
+        std::string name;
+#ifdef UA_ENABLE_TYPEDESCRIPTION
+        name = dataTypeMember->memberName ? dataTypeMember->memberName : "???";
+#else
+        name = std::to_string(i);
+#endif
+        if (!prefix.empty())
+            name = prefix + "." + name;
+        offset += dataTypeMember->padding;
+        if (dataTypeMember->isArray) {
+            offset += sizeof(size_t) + sizeof(void*);
+            continue;
+        }
+        if (dataTypeMember->isOptional) {
+            offset += sizeof(void*);
+            continue;
+        }
+        switch (memberType->typeKind) {
+        case UA_DATATYPEKIND_BOOLEAN:
+        case UA_DATATYPEKIND_SBYTE:
+        case UA_DATATYPEKIND_BYTE:
+        case UA_DATATYPEKIND_INT16:
+        case UA_DATATYPEKIND_UINT16:
+        case UA_DATATYPEKIND_INT32:
+        case UA_DATATYPEKIND_UINT32:
+        case UA_DATATYPEKIND_INT64:
+        case UA_DATATYPEKIND_UINT64:
+        case UA_DATATYPEKIND_FLOAT:
+        case UA_DATATYPEKIND_DOUBLE:
+        case UA_DATATYPEKIND_DATETIME:
+        case UA_DATATYPEKIND_STATUSCODE:
+        case UA_DATATYPEKIND_ENUM:
+        case UA_DATATYPEKIND_STRING:
+        case UA_DATATYPEKIND_XMLELEMENT:
+        case UA_DATATYPEKIND_BYTESTRING: {
+            UA_Column column;
+            column.name = name;
+            column.type = memberType;
+            column.offset = offset;
+            columns->push_back(column);
+            break;
+        }
+        case UA_DATATYPEKIND_STRUCTURE:
+            if (!isOptionSetLayout(memberType))
+                collectScalarLeaves(memberType, name, offset, columns);
+            break;
+        default:
+            UA_LOG_DEBUG(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "collectScalarLeaves: %s is not a scalar leaf field and is skipped", name.c_str());
+        }
+        offset += memberType->memSize;
+    }
+}
+
+// stride gather of a fixed width field into a contiguous column (vectorizable loop)
+template <typename T>
+static void gatherColumn(T* __restrict column, const UA_Byte* __restrict base, size_t stride, size_t length) {
+    for (size_t i = 0; i < length; i++)
+        memcpy(&column[i], base + i * stride, sizeof(T));
+}
+
+// stride gather of booleans into a bit-packed column
+static void gatherBooleanColumn(UA_Byte* __restrict column, const UA_Byte* __restrict base, size_t stride, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (base[i * stride])
+            column[i / 8] |= (UA_Byte)(0x01 << (i % 8));
+    }
+}
+
+// stride gather of date times as nanoseconds since the UNIX epoch
+static void gatherDateTimeColumn(UA_Int64* __restrict column, const UA_Byte* __restrict base, size_t stride, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        UA_DateTime dateTime;
+        memcpy(&dateTime, base + i * stride, sizeof(UA_DateTime));
+        column[i] = (dateTime - UA_DATETIME_UNIX_EPOCH) * 100;
+    }
+}
+
+// gathers strings into offsets and concatenated values, null strings are marked in the validity bitmap
+static UA_StatusCode gatherStringColumn(UA_Column* column, const UA_Byte* base, size_t stride, size_t length) {
+    size_t total = 0;
+    for (size_t i = 0; i < length; i++)
+        total += ((const UA_String*)(base + i * stride))->length;
+    if (total > INT32_MAX)
+        return UA_STATUSCODE_BADOUTOFRANGE;
+    column->values.resize(total);
+    column->offsets.resize(length + 1);
+    column->offsets[0] = 0;
+    column->nullCount = 0;
+    for (size_t i = 0; i < length; i++) {
+        const UA_String* str = (const UA_String*)(base + i * stride);
+        UA_Int32 begin = column->offsets[i];
+        if (!str->data) {
+            if (column->validity.empty())
+                column->validity.assign((length + 7) / 8, 0xFF);
+            column->validity[i / 8] &= (UA_Byte)~(0x01 << (i % 8));
+            column->nullCount++;
+        }
+        else if (str->length)
+            memcpy(&column->values[begin], str->data, str->length);
+        column->offsets[i + 1] = begin + (UA_Int32)str->length;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+// converts a variant holding N custom structures (scalar or array) into one contiguous typed column
+// per scalar leaf field, the column layout is compatible with the Apache Arrow columnar format
+UA_StatusCode UA_ColumnBatch_fromVariant(const UA_Variant* data, UA_ColumnBatch* batch) {
+    UA_StatusCode retval;
+    const UA_Byte* base;
+    size_t stride;
+
+    if (!data) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ColumnBatch_fromVariant: Parameter 1 (UA_Variant*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!batch) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ColumnBatch_fromVariant: Parameter 2 (UA_ColumnBatch*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!data->type || (data->type->typeKind != UA_DATATYPEKIND_STRUCTURE && data->type->typeKind != UA_DATATYPEKIND_OPTSTRUCT) || isOptionSetLayout(data->type)) {
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ColumnBatch_fromVariant: variant does not hold structures");
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+    }
+    retval = UA_STATUSCODE_GOOD;
+    batch->type = data->type;
+    batch->columns.clear();
+    batch->length = UA_Variant_isScalar(data) ? 1 : data->arrayLength;
+    if (data->data <= UA_EMPTY_ARRAY_SENTINEL)
+        batch->length = 0;
+    collectScalarLeaves(data->type, std::string(), 0, &batch->columns);
+    base = (const UA_Byte*)data->data;
+    stride = data->type->memSize;
+    for (UA_Column& column : batch->columns) {
+        const UA_Byte* columnBase = base + column.offset;
+        size_t length = batch->length;
+        column.nullCount = 0;
+        if (!length)
+            continue;
+        switch (column.type->typeKind) {
+        case UA_DATATYPEKIND_BOOLEAN:
+            column.values.assign((length + 7) / 8, 0x00);
+            gatherBooleanColumn(column.values.data(), columnBase, stride, length);
+            break;
+        case UA_DATATYPEKIND_SBYTE:
+        case UA_DATATYPEKIND_BYTE:
+            column.values.resize(length);
+            gatherColumn<UA_Byte>(column.values.data(), columnBase, stride, length);
+            break;
+        case UA_DATATYPEKIND_INT16:
+        case UA_DATATYPEKIND_UINT16:
+            column.values.resize(length * sizeof(UA_UInt16));
+            gatherColumn<UA_UInt16>((UA_UInt16*)column.values.data(), columnBase, stride, length);
+            break;
+        case UA_DATATYPEKIND_INT32:
+        case UA_DATATYPEKIND_UINT32:
+        case UA_DATATYPEKIND_STATUSCODE:
+        case UA_DATATYPEKIND_ENUM:
+        case UA_DATATYPEKIND_FLOAT:
+            column.values.resize(length * sizeof(UA_UInt32));
+            gatherColumn<UA_UInt32>((UA_UInt32*)column.values.data(), columnBase, stride, length);
+            break;
+        case UA_DATATYPEKIND_INT64:
+        case UA_DATATYPEKIND_UINT64:
+        case UA_DATATYPEKIND_DOUBLE:
+            column.values.resize(length * sizeof(UA_UInt64));
+            gatherColumn<UA_UInt64>((UA_UInt64*)column.values.data(), columnBase, stride, length);
+            break;
+        case UA_DATATYPEKIND_DATETIME:
+            column.values.resize(length * sizeof(UA_Int64));
+            gatherDateTimeColumn((UA_Int64*)column.values.data(), columnBase, stride, length);
+            break;
+        default:
+            retval |= gatherStringColumn(&column, columnBase, stride, length);
+        }
+    }
+    return retval;
+}
+
+// writes a field of a CSV file, text is quoted if necessary (RFC 4180)
+static UA_StatusCode csvWriteText(UA_OutputSink* sink, const UA_Byte* data, size_t length) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    size_t begin = 0;
+    UA_Boolean quote = false;
+    for (size_t i = 0; i < length && !quote; i++)
+        quote = data[i] == ',' || data[i] == '"' || data[i] == '\n' || data[i] == '\r';
+    if (!quote)
+        return UA_OutputSink_write(sink, data, length);
+    retval |= jsonWriteChar(sink, '"');
+    for (size_t i = 0; i < length; i++) {
+        if (data[i] != '"')
+            continue;
+        // double quotes are escaped by doubling
+        retval |= UA_OutputSink_write(sink, &data[begin], i + 1 - begin);
+        begin = i;
+    }
+    retval |= UA_OutputSink_write(sink, &data[begin], length - begin);
+    retval |= jsonWriteChar(sink, '"');
+    return retval;
+}
+
+// writes the column batch as CSV (one row per structure, one column per scalar leaf field)
+UA_StatusCode UA_ColumnBatch_writeCsv(const UA_ColumnBatch* batch, UA_OutputSink* sink, UA_Boolean withHeader) {
+    UA_StatusCode retval;
+    if (!batch) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ColumnBatch_writeCsv: Parameter 1 (UA_ColumnBatch*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!sink || !sink->callback) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ColumnBatch_writeCsv: Parameter 2 (UA_OutputSink*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    retval = UA_STATUSCODE_GOOD;
+    if (withHeader) {
+        for (size_t j = 0; j < batch->columns.size(); j++) {
+            if (j)
+                retval |= jsonWriteChar(sink, ',');
+            retval |= csvWriteText(sink, (const UA_Byte*)batch->columns[j].name.data(), batch->columns[j].name.length());
+        }
+        retval |= jsonWriteChar(sink, '\n');
+    }
+    for (size_t i = 0; i < batch->length && retval == UA_STATUSCODE_GOOD; i++) {
+        for (size_t j = 0; j < batch->columns.size(); j++) {
+            const UA_Column* column = &batch->columns[j];
+            const UA_Byte* values = column->values.data();
+            if (j)
+                retval |= jsonWriteChar(sink, ',');
+            switch (column->type->typeKind) {
+            case UA_DATATYPEKIND_BOOLEAN:
+                retval |= jsonWriteRaw(sink, values[i / 8] & (0x01 << (i % 8)) ? "true" : "false");
+                break;
+            case UA_DATATYPEKIND_SBYTE:
+                retval |= jsonWriteInteger(sink, ((const UA_SByte*)values)[i]);
+                break;
+            case UA_DATATYPEKIND_BYTE:
+                retval |= jsonWriteInteger(sink, values[i]);
+                break;
+            case UA_DATATYPEKIND_INT16:
+                retval |= jsonWriteInteger(sink, ((const UA_Int16*)values)[i]);
+                break;
+            case UA_DATATYPEKIND_UINT16:
+                retval |= jsonWriteInteger(sink, ((const UA_UInt16*)values)[i]);
+                break;
+            case UA_DATATYPEKIND_INT32:
+            case UA_DATATYPEKIND_ENUM:
+                retval |= jsonWriteInteger(sink, ((const UA_Int32*)values)[i]);
+                break;
+            case UA_DATATYPEKIND_UINT32:
+            case UA_DATATYPEKIND_STATUSCODE:
+                retval |= jsonWriteInteger(sink, ((const UA_UInt32*)values)[i]);
+                break;
+            case UA_DATATYPEKIND_INT64:
+                retval |= jsonWriteInteger(sink, ((const UA_Int64*)values)[i]);
+                break;
+            case UA_DATATYPEKIND_UINT64:
+                retval |= jsonWriteInteger(sink, ((const UA_UInt64*)values)[i]);
+                break;
+            case UA_DATATYPEKIND_FLOAT:
+                retval |= jsonWriteFloat(sink, ((const UA_Float*)values)[i]);
+                break;
+            case UA_DATATYPEKIND_DOUBLE:
+                retval |= jsonWriteFloat(sink, ((const UA_Double*)values)[i]);
+                break;
+            case UA_DATATYPEKIND_DATETIME:
+                retval |= jsonWriteDateTime(sink, ((const UA_Int64*)values)[i] / 100 + UA_DATETIME_UNIX_EPOCH);
+                break;
+            case UA_DATATYPEKIND_BYTESTRING:
+                if (column->validity.empty() || column->validity[i / 8] & (0x01 << (i % 8)))
+                    retval |= jsonWriteBase64Body(sink, &values[column->offsets[i]], column->offsets[i + 1] - column->offsets[i]);
+                break;
+            default:
+                // null strings are written as empty fields
+                if (column->validity.empty() || column->validity[i / 8] & (0x01 << (i % 8)))
+                    retval |= csvWriteText(sink, &values[column->offsets[i]], column->offsets[i + 1] - column->offsets[i]);
+            }
+        }
+        retval |= jsonWriteChar(sink, '\n');
+    }
+    return retval;
+}
+
+// returns the format string of the Arrow C data interface for the column type
+static const char* arrowFormat(const UA_DataType* type) {
+    switch (type->typeKind) {
+    case UA_DATATYPEKIND_BOOLEAN: return "b";
+    case UA_DATATYPEKIND_SBYTE: return "c";
+    case UA_DATATYPEKIND_BYTE: return "C";
+    case UA_DATATYPEKIND_INT16: return "s";
+    case UA_DATATYPEKIND_UINT16: return "S";
+    case UA_DATATYPEKIND_INT32:
+    case UA_DATATYPEKIND_ENUM: return "i";
+    case UA_DATATYPEKIND_UINT32:
+    case UA_DATATYPEKIND_STATUSCODE: return "I";
+    case UA_DATATYPEKIND_INT64: return "l";
+    case UA_DATATYPEKIND_UINT64: return "L";
+    case UA_DATATYPEKIND_FLOAT: return "f";
+    case UA_DATATYPEKIND_DOUBLE: return "g";
+    case UA_DATATYPEKIND_DATETIME: return "tsn:UTC";
+    case UA_DATATYPEKIND_BYTESTRING: return "z";
+    default: return "u";
+    }
+}
+
+// owner of the exported column batch and of the child structures of the Arrow C data interface
+typedef struct {
+    UA_ColumnBatch batch;
+    std::vector<struct ArrowSchema> childSchemas;
+    std::vector<struct ArrowSchema*> childSchemaPointers;
+    std::vector<struct ArrowArray> childArrays;
+    std::vector<struct ArrowArray*> childArrayPointers;
+    std::vector<const void*> buffers; // 3 buffers per column
+    const void* structBuffers[1];
+} arrowExport_t;
+
+static void arrowReleaseChildSchema(struct ArrowSchema* schema) {
+    schema->release = 0x0;
+}
+
+static void arrowReleaseChildArray(struct ArrowArray* array) {
+    array->release = 0x0;
+}
+
+static void arrowReleaseSchema(struct ArrowSchema* schema) {
+    arrowExport_t* exported = (arrowExport_t*)schema->private_data;
+    for (struct ArrowSchema& child : exported->childSchemas) {
+        if (child.release)
+            child.release(&child);
+    }
+    delete exported;
+    schema->release = 0x0;
+}
+
+static void arrowReleaseArray(struct ArrowArray* array) {
+    arrowExport_t* exported = (arrowExport_t*)array->private_data;
+    for (struct ArrowArray& child : exported->childArrays) {
+        if (child.release)
+            child.release(&child);
+    }
+    delete exported;
+    array->release = 0x0;
+}
+
+// exports the column batch as record batch of the Apache Arrow C data interface (zero-copy)
+// the content of the batch is moved, schema and array are released by their release callbacks
+UA_StatusCode UA_ColumnBatch_exportArrow(UA_ColumnBatch* batch, struct ArrowSchema* schema, struct ArrowArray* array) {
+    arrowExport_t* schemaOwner;
+    arrowExport_t* arrayOwner;
+    size_t columnsSize;
+
+    if (!batch) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ColumnBatch_exportArrow: Parameter 1 (UA_ColumnBatch*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!schema) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ColumnBatch_exportArrow: Parameter 2 (ArrowSchema*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!array) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ColumnBatch_exportArrow: Parameter 3 (ArrowArray*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    columnsSize = batch->columns.size();
+    // schema and array have independent lifetimes, the schema keeps its own copy of the column names
+    schemaOwner = new arrowExport_t();
+    arrayOwner = new arrowExport_t();
+    for (const UA_Column& column : batch->columns) {
+        UA_Column nameOnly;
+        nameOnly.name = column.name;
+        nameOnly.type = column.type;
+        schemaOwner->batch.columns.push_back(nameOnly);
+    }
+    arrayOwner->batch = std::move(*batch);
+    batch->columns.clear();
+    batch->length = 0;
+
+    schemaOwner->childSchemas.resize(columnsSize);
+    schemaOwner->childSchemaPointers.resize(columnsSize);
+    for (size_t j = 0; j < columnsSize; j++) {
+        struct ArrowSchema* child = &schemaOwner->childSchemas[j];
+        memset(child, 0x0, sizeof(struct ArrowSchema));
+        child->format = arrowFormat(schemaOwner->batch.columns[j].type);
+        child->name = schemaOwner->batch.columns[j].name.c_str();
+        child->flags = ARROW_FLAG_NULLABLE;
+        child->release = arrowReleaseChildSchema;
+        schemaOwner->childSchemaPointers[j] = child;
+    }
+    memset(schema, 0x0, sizeof(struct ArrowSchema));
+    schema->format = "+s";
+    schema->name = "";
+    schema->n_children = (int64_t)columnsSize;
+    schema->children = schemaOwner->childSchemaPointers.data();
+    schema->private_data = schemaOwner;
+    schema->release = arrowReleaseSchema;
+
+    arrayOwner->childArrays.resize(columnsSize);
+    arrayOwner->childArrayPointers.resize(columnsSize);
+    arrayOwner->buffers.resize(3 * columnsSize);
+    for (size_t j = 0; j < columnsSize; j++) {
+        const UA_Column* column = &arrayOwner->batch.columns[j];
+        struct ArrowArray* child = &arrayOwner->childArrays[j];
+        const void** buffers = &arrayOwner->buffers[3 * j];
+        memset(child, 0x0, sizeof(struct ArrowArray));
+        child->length = (int64_t)arrayOwner->batch.length;
+        child->null_count = (int64_t)column->nullCount;
+        const char* format = arrowFormat(column->type);
+        buffers[0] = column->validity.empty() ? 0x0 : column->validity.data();
+        if (format[0] != 'u' && format[0] != 'z') {
+            child->n_buffers = 2;
+            buffers[1] = column->values.data();
+        }
+        else {
+            // variable length column: validity, offsets, values
+            static const UA_Int32 emptyOffsets[1] = { 0 };
+            child->n_buffers = 3;
+            buffers[1] = column->offsets.empty() ? emptyOffsets : column->offsets.data();
+            buffers[2] = column->values.data();
+        }
+        child->buffers = buffers;
+        child->release = arrowReleaseChildArray;
+        arrayOwner->childArrayPointers[j] = child;
+    }
+    memset(array, 0x0, sizeof(struct ArrowArray));
+    arrayOwner->structBuffers[0] = 0x0;
+    array->length = (int64_t)arrayOwner->batch.length;
+    array->n_buffers = 1;
+    array->buffers = arrayOwner->structBuffers;
+    array->n_children = (int64_t)columnsSize;
+    array->children = arrayOwner->childArrayPointers.data();
+    array->private_data = arrayOwner;
+    array->release = arrowReleaseArray;
+    return UA_STATUSCODE_GOOD;
+}
+
+// reads an operation limit of the server, e.g. UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERREAD
+// returns 0 if the server has no limit or does not provide it
+static UA_UInt32 readOperationLimit(UA_Client* client, UA_UInt32 limitId) {
+    UA_Variant value;
+    UA_UInt32 limit = 0;
+    UA_UInt64 started = metricsStart();
+    UA_StatusCode retval;
+    UA_Variant_init(&value);
+    retval = UA_Client_readValueAttribute(client, UA_NODEID_NUMERIC(0, limitId), &value);
+    metricsRecord(UA_HISTOGRAM_READ, started);
+    if (retval == UA_STATUSCODE_GOOD && UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_UINT32]))
+        limit = *(const UA_UInt32*)value.data;
+    UA_Variant_clear(&value);
+    return limit;
+}
+
+// subfunction of readValuesChunked, sends one ReadRequest and checks the number of results
+static UA_StatusCode readValueIdsRequest(UA_Client* client, UA_ReadValueId* readValueIds, size_t readValueIdsSize, UA_TimestampsToReturn timestampsToReturn,
+                                         UA_ReadResponse* response) {
+    UA_ReadRequest request;
+    UA_StatusCode retval;
+    UA_ReadRequest_init(&request);
+    request.timestampsToReturn = timestampsToReturn;
+    request.nodesToRead = readValueIds;
+    request.nodesToReadSize = readValueIdsSize;
+    UA_UInt64 started = metricsStart();
+    *response = UA_Client_Service_read(client, request);
+    metricsRecordResponse(UA_HISTOGRAM_READ, started, response, &UA_TYPES[UA_TYPES_READRESPONSE]);
+    retval = response->responseHeader.serviceResult;
+    if (retval == UA_STATUSCODE_GOOD && response->resultsSize != readValueIdsSize)
+        retval = UA_STATUSCODE_BADUNEXPECTEDERROR;
+    return retval;
+}
+
+// subfunction of readValuesChunked for a limit of one read value ID per request:
+// reads the value and the data type attribute of one node with two requests and returns them as one response (like a larger limit)
+static UA_StatusCode readValueIdsSeparately(UA_Client* client, UA_ReadValueId* readValueIds, UA_ReadResponse* response) {
+    UA_ReadResponse dataTypeResponse;
+    UA_DataValue* results;
+    UA_StatusCode retval = readValueIdsRequest(client, &readValueIds[0], 1, UA_TIMESTAMPSTORETURN_BOTH, response);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+    retval = readValueIdsRequest(client, &readValueIds[1], 1, UA_TIMESTAMPSTORETURN_BOTH, &dataTypeResponse);
+    if (retval == UA_STATUSCODE_GOOD) {
+        results = (UA_DataValue*)UA_Array_new(2, &UA_TYPES[UA_TYPES_DATAVALUE]);
+        if (!results)
+            retval = UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    if (retval == UA_STATUSCODE_GOOD) {
+        // the results are moved, their arrays are freed without clearing them
+        results[0] = response->results[0];
+        results[1] = dataTypeResponse.results[0];
+        UA_free(response->results);
+        UA_free(dataTypeResponse.results);
+        dataTypeResponse.results = 0x0;
+        dataTypeResponse.resultsSize = 0;
+        response->results = results;
+        response->resultsSize = 2;
+    }
+    UA_ReadResponse_clear(&dataTypeResponse);
+    return retval;
+}
+
+// subfunction of UA_ReadValues and UA_DataTypeCache_prefill, reads value and data type attributes
+// with chunkSize read value IDs (two per node) per ReadRequest, the data types are stored in the data type cache
+// a chunkSize of 1 reads the value and the data type attribute of each node with separate requests
+// without values only the data type attributes are read (one read value ID per node, not recorded) and the callback is optional
+static UA_StatusCode readValuesChunked(UA_Client* client, const UA_NodeId* nodeIds, size_t nodeIdsSize, size_t chunkSize, UA_ReadValuesCallback callback, void* context,
+                                       UA_Boolean withValues = true) {
+    const size_t readValueIdsPerNode = withValues ? 2 : 1;
+    const size_t nodesPerRequest = std::max<size_t>(1, chunkSize / readValueIdsPerNode);
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    UA_ReadResponse response;
+    UA_DataValue noValue;
+    std::vector<UA_ReadValueId> readValueIds(readValueIdsPerNode * std::min(nodesPerRequest, nodeIdsSize));
+
+    for (size_t start = 0; start < nodeIdsSize && retval == UA_STATUSCODE_GOOD; start += nodesPerRequest) {
+        const size_t count = std::min(nodesPerRequest, nodeIdsSize - start);
+        for (size_t i = 0; i < count; i++) {
+            // shallow copies of the node IDs, the request is not cleared
+            UA_ReadValueId* readValueId = &readValueIds[readValueIdsPerNode * i];
+            if (withValues) {
+                UA_ReadValueId_init(readValueId);
+                readValueId->nodeId = nodeIds[start + i];
+                readValueId->attributeId = UA_ATTRIBUTEID_VALUE;
+                readValueId++;
+            }
+            UA_ReadValueId_init(readValueId);
+            readValueId->nodeId = nodeIds[start + i];
+            readValueId->attributeId = UA_ATTRIBUTEID_DATATYPE;
+        }
+        if (withValues && chunkSize < 2)
+            retval = readValueIdsSeparately(client, readValueIds.data(), &response);
+        else
+            retval = readValueIdsRequest(client, readValueIds.data(), readValueIdsPerNode * count,
+                                         withValues ? UA_TIMESTAMPSTORETURN_BOTH : UA_TIMESTAMPSTORETURN_NEITHER, &response);
+        // before the callback takes over the values
+        if (retval == UA_STATUSCODE_GOOD && withValues)
+            recordReadResponse(&nodeIds[start], count, &response);
+        for (size_t i = 0; i < count && retval == UA_STATUSCODE_GOOD; i++) {
+            const UA_DataValue* dataType = &response.results[readValueIdsPerNode * i + readValueIdsPerNode - 1];
+            const UA_NodeId* dataTypeId = 0x0;
+            if (dataType->hasValue && UA_Variant_hasScalarType(&dataType->value, &UA_TYPES[UA_TYPES_NODEID])) {
+                dataTypeId = (const UA_NodeId*)dataType->value.data;
+                storeDataTypeId(&nodeIds[start + i], dataTypeId);
+            }
+            if (!callback)
+                continue;
+            UA_DataValue_init(&noValue);
+            retval = callback(context, &nodeIds[start + i], dataTypeId, withValues ? &response.results[2 * i] : &noValue);
+        }
+        UA_ReadResponse_clear(&response);
+    }
+    return retval;
+}
+
+// returns the number of read value IDs per ReadRequest of UA_ReadValues (MaxNodesPerRead counts read value IDs, two per node)
+static size_t readValuesChunkSize(UA_Client* client) {
+    size_t chunkSize = readOperationLimit(client, UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERREAD);
+    // 0: no limit reported
+    if (!chunkSize)
+        return 2 * UA_READVALUES_MAXCHUNKSIZE;
+    return std::min<size_t>(chunkSize, 2 * UA_READVALUES_MAXCHUNKSIZE);
+}
+
+// reads the value and data type attributes of many nodes with as few ReadRequests as possible
+// the requests are chunked according to the operation limit MaxNodesPerRead of the server
+// the callback is called once per node in the order of nodeIds and may take over the content of value
+UA_StatusCode UA_ReadValues(UA_Client* client, const UA_NodeId* nodeIds, size_t nodeIdsSize, UA_ReadValuesCallback callback, void* context) {
+    UA_StatusCode retval;
+
+    if (!client) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReadValues: Client session invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!nodeIds && nodeIdsSize) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReadValues: Parameter 2 (const UA_NodeId*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!callback) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReadValues: Parameter 4 (UA_ReadValuesCallback) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!nodeIdsSize)
+        return UA_STATUSCODE_GOOD;
+    retval = readValuesChunked(client, nodeIds, nodeIdsSize, readValuesChunkSize(client), callback, context);
+    if (retval != UA_STATUSCODE_GOOD)
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReadValues: Could not read values (%s)", UA_StatusCode_name(retval));
+    return retval;
+}
+
+// reads the data type attributes of many variables with batched ReadRequests into the data type cache
+// afterwards UA_PrintValue and UA_PrintValueJson resolve enumerations of these variables without network access
+// (UA_ReadValues fills the cache as well)
+UA_StatusCode UA_DataTypeCache_prefill(UA_Client* client, const UA_NodeId* nodeIds, size_t nodeIdsSize) {
+    UA_StatusCode retval;
+
+    if (!client) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_DataTypeCache_prefill: Client session invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!nodeIds && nodeIdsSize) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_DataTypeCache_prefill: Parameter 2 (const UA_NodeId*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!nodeIdsSize)
+        return UA_STATUSCODE_GOOD;
+    // the cache is filled by readValuesChunked, no values are read
+    retval = readValuesChunked(client, nodeIds, nodeIdsSize, readValuesChunkSize(client), 0x0, 0x0, false);
+    if (retval != UA_STATUSCODE_GOOD)
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_DataTypeCache_prefill: Could not read data types (%s)", UA_StatusCode_name(retval));
+    return retval;
+}
+
+static const UA_UInt64 FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+static const UA_UInt64 FNV_PRIME = 0x100000001b3ULL;
+
+// FNV-1a hash of a byte range
+static UA_UInt64 hashBytes(UA_UInt64 hash, const void* data, size_t length) {
+    const UA_Byte* bytes = (const UA_Byte*)data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+// hash of a decoded value, the structure is walked like collectScalarLeaves
+// fields at the sorted offsets in skip (relative to the outermost structure) are left out
+// types with nested pointers other than strings and structures are hashed in binary encoding
+static UA_UInt64 hashValue(UA_UInt64 hash, const UA_Byte* p, const UA_DataType* type, const std::vector<size_t>* skip, size_t baseOffset) {
+    switch (type->typeKind) {
+    case UA_DATATYPEKIND_STRING:
+    case UA_DATATYPEKIND_BYTESTRING:
+    case UA_DATATYPEKIND_XMLELEMENT: {
+        const UA_String* str = (const UA_String*)p;
+        const UA_Byte isNull = !str->data;
+        hash = hashBytes(hash, &isNull, 1);
+        hash = hashBytes(hash, &str->length, sizeof(size_t));
+        return hashBytes(hash, str->data, str->length);
+    }
+    case UA_DATATYPEKIND_STRUCTURE:
+    case UA_DATATYPEKIND_OPTSTRUCT: {
+        size_t offset = 0;
+        for (size_t i = 0; i < type->membersSize; i++) {
+            const UA_DataTypeMember* dataTypeMember = &type->members[i];
+            const UA_DataType* memberType = dataTypeMember->memberType;
+            offset += dataTypeMember->padding;
+            if (dataTypeMember->isArray) {
+                const size_t length = *(const size_t*)(p + offset);
+                const UA_Byte* array = *(UA_Byte* const*)(p + offset + sizeof(size_t));
+                hash = hashBytes(hash, &length, sizeof(size_t));
+                for (size_t j = 0; array > UA_EMPTY_ARRAY_SENTINEL && j < length; j++)
+                    hash = hashValue(hash, array + j * memberType->memSize, memberType, 0x0, 0);
+                offset += sizeof(size_t) + sizeof(void*);
+                continue;
+            }
+            if (dataTypeMember->isOptional) {
+                const UA_Byte* member = *(UA_Byte* const*)(p + offset);
+                const UA_Byte isSet = member != 0x0;
+                hash = hashBytes(hash, &isSet, 1);
+                if (member)
+                    hash = hashValue(hash, member, memberType, 0x0, 0);
+                offset += sizeof(void*);
+                continue;
+            }
+            if (!skip || !std::binary_search(skip->begin(), skip->end(), baseOffset + offset))
+                hash = hashValue(hash, p + offset, memberType, skip, baseOffset + offset);
+            offset += memberType->memSize;
+        }
+        return hash;
+    }
+    default:
+        break;
+    }
+    if (type->pointerFree)
+        return hashBytes(hash, p, type->memSize);
+    UA_ByteString encoded;
+    UA_ByteString_init(&encoded);
+    UA_StatusCode retval = UA_encodeBinary(p, type, &encoded);
+    hash = hashBytes(hash, &retval, sizeof(UA_StatusCode));
+    hash = hashBytes(hash, encoded.data, encoded.length);
+    UA_ByteString_clear(&encoded);
+    return hash;
+}
+
+// value of a numeric leaf field, false for other types
+static UA_Boolean leafToDouble(const UA_Byte* p, const UA_DataType* type, UA_Double* value) {
+    switch (type->typeKind) {
+    case UA_DATATYPEKIND_SBYTE: *value = *(const UA_SByte*)p; return true;
+    case UA_DATATYPEKIND_BYTE: *value = *(const UA_Byte*)p; return true;
+    case UA_DATATYPEKIND_INT16: *value = *(const UA_Int16*)p; return true;
+    case UA_DATATYPEKIND_UINT16: *value = *(const UA_UInt16*)p; return true;
+    case UA_DATATYPEKIND_INT32: *value = *(const UA_Int32*)p; return true;
+    case UA_DATATYPEKIND_UINT32: *value = *(const UA_UInt32*)p; return true;
+    case UA_DATATYPEKIND_INT64: *value = (UA_Double)*(const UA_Int64*)p; return true;
+    case UA_DATATYPEKIND_UINT64: *value = (UA_Double)*(const UA_UInt64*)p; return true;
+    case UA_DATATYPEKIND_FLOAT: *value = *(const UA_Float*)p; return true;
+    case UA_DATATYPEKIND_DOUBLE: *value = *(const UA_Double*)p; return true;
+    default: return false;
+    }
+}
+
+// finds the deadband of a field, deadbands of the node take precedence over deadbands of all nodes
+static const UA_Deadband* findDeadband(const UA_ChangeFilter* filter, const UA_NodeId* nodeId, const std::string& field, size_t* index) {
+    const UA_Deadband* found = 0x0;
+    for (size_t i = 0; i < filter->deadbands.size(); i++) {
+        const UA_Deadband* deadband = &filter->deadbands[i];
+        if (deadband->field != field)
+            continue;
+        if (UA_NodeId_equal(&deadband->nodeId, nodeId)) {
+            *index = i;
+            return deadband;
+        }
+        if (!found && UA_NodeId_isNull(&deadband->nodeId)) {
+            *index = i;
+            found = deadband;
+        }
+    }
+    return found;
+}
+
+// resolves the deadband fields of a node for the type of its value
+static void resolveDeadbandLeaves(const UA_ChangeFilter* filter, const UA_NodeId* nodeId, UA_LastValue* lastValue, const UA_DataType* type) {
+    std::vector<UA_Column> columns;
+    UA_DeadbandLeaf leaf;
+
+    lastValue->type = type;
+    lastValue->resolved = true;
+    lastValue->leaves.clear();
+    lastValue->skipOffsets.clear();
+    if (!type || filter->deadbands.empty())
+        return;
+    if ((type->typeKind == UA_DATATYPEKIND_STRUCTURE || type->typeKind == UA_DATATYPEKIND_OPTSTRUCT) && !isOptionSetLayout(type))
+        collectScalarLeaves(type, std::string(), 0, &columns);
+    else {
+        UA_Column column;
+        column.type = type;
+        column.offset = 0;
+        columns.push_back(column);
+    }
+    for (const UA_Column& column : columns) {
+        if (!findDeadband(filter, nodeId, column.name, &leaf.deadband))
+            continue;
+        if (column.type->typeKind < UA_DATATYPEKIND_SBYTE || column.type->typeKind > UA_DATATYPEKIND_DOUBLE) {
+            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ChangeFilter_check: deadband field \"%s\" is not numeric and is ignored", column.name.c_str());
+            continue;
+        }
+        leaf.offset = column.offset;
+        leaf.type = column.type;
+        lastValue->leaves.push_back(leaf);
+        lastValue->skipOffsets.push_back(column.offset);
+    }
+    std::sort(lastValue->skipOffsets.begin(), lastValue->skipOffsets.end());
+}
+
+// checks whether a deadband is exceeded, without absolute and percent deadband every change counts
+static UA_Boolean deadbandExceeded(const UA_Deadband* deadband, UA_Double lastValue, UA_Double value) {
+    UA_Double difference;
+    if (std::isnan(lastValue) || std::isnan(value))
+        return std::isnan(lastValue) != std::isnan(value);
+    difference = std::fabs(value - lastValue);
+    if (deadband->absolute <= 0.0 && deadband->percent <= 0.0)
+        return difference != 0.0;
+    return (deadband->absolute > 0.0 && difference > deadband->absolute) || (deadband->percent > 0.0 && difference > deadband->percent / 100.0 * std::fabs(lastValue));
+}
+
+void UA_ChangeFilter_init(UA_ChangeFilter* filter) {
+    if (!filter)
+        return;
+    filter->deadbands.clear();
+    filter->lastValues.clear();
+    filter->changed = 0;
+    filter->unchanged = 0;
+}
+
+// adds a deadband for a numeric field (see UA_Deadband), nodeId 0x0 applies the deadband to all nodes
+// values of existing nodes are reported once more, because their deadband fields change
+UA_StatusCode UA_ChangeFilter_addDeadband(UA_ChangeFilter* filter, const UA_NodeId* nodeId, const char* field, UA_Double absolute, UA_Double percent) {
+    UA_Deadband deadband;
+    if (!filter) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ChangeFilter_addDeadband: Parameter 1 (UA_ChangeFilter*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!field) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ChangeFilter_addDeadband: Parameter 3 (const char*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (absolute < 0.0 || percent < 0.0) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ChangeFilter_addDeadband: negative deadband");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    UA_NodeId_init(&deadband.nodeId);
+    if (nodeId)
+        UA_NodeId_copy(nodeId, &deadband.nodeId);
+    deadband.field = field;
+    deadband.absolute = absolute;
+    deadband.percent = percent;
+    filter->deadbands.push_back(deadband);
+    for (std::pair<const UA_NodeId, UA_LastValue>& lastValue : filter->lastValues)
+        lastValue.second.resolved = false;
+    return UA_STATUSCODE_GOOD;
+}
+
+// returns true if the value of the node changed since it was reported last and stores it as reported value
+// the status code and the value are compared by a hash of the decoded value, numeric fields with a deadband
+// are compared with the last reported value instead (timestamps are not compared)
+// unchanged values can be skipped before they are printed, the filter is not thread-safe
+UA_Boolean UA_ChangeFilter_check(UA_ChangeFilter* filter, const UA_NodeId* nodeId, const UA_DataValue* value) {
+    UA_Boolean changed = false;
+    const UA_DataType* type;
+    const UA_Byte* data;
+    std::vector<UA_Double> leafValues;
+    UA_StatusCode status;
+    UA_UInt64 hash;
+    size_t elements;
+
+    if (!filter) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ChangeFilter_check: Parameter 1 (UA_ChangeFilter*) invalid");
+        return true;
+    }
+    if (!nodeId || UA_NodeId_isNull(nodeId)) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ChangeFilter_check: Parameter 2 (const UA_NodeId*) invalid");
+        return true;
+    }
+    if (!value) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ChangeFilter_check: Parameter 3 (const UA_DataValue*) invalid");
+        return true;
+    }
+    lastValueIt_t lastValueIt = filter->lastValues.find(*nodeId);
+    // new nodes are reported
+    if (lastValueIt == filter->lastValues.end()) {
+        UA_NodeId key;
+        if (UA_NodeId_copy(nodeId, &key) != UA_STATUSCODE_GOOD)
+            return true;
+        lastValueIt = filter->lastValues.emplace(key, UA_LastValue()).first;
+        changed = true;
+    }
+    UA_LastValue& lastValue = lastValueIt->second;
+    type = value->hasValue ? value->value.type : 0x0;
+    data = type ? (const UA_Byte*)value->value.data : 0x0;
+    if (!lastValue.resolved || lastValue.type != type) {
+        resolveDeadbandLeaves(filter, nodeId, &lastValue, type);
+        changed = true;
+    }
+    status = value->hasStatus ? value->status : UA_STATUSCODE_GOOD;
+    hash = hashBytes(FNV_OFFSET_BASIS, &status, sizeof(UA_StatusCode));
+    elements = 0;
+    if (data > UA_EMPTY_ARRAY_SENTINEL) {
+        elements = UA_Variant_isScalar(&value->value) ? 1 : value->value.arrayLength;
+        hash = hashBytes(hash, &value->value.arrayLength, sizeof(size_t));
+        hash = hashBytes(hash, value->value.arrayDimensions, value->value.arrayDimensionsSize * sizeof(UA_UInt32));
+        // a value of a built-in type with deadband is compared by the deadband only
+        if (lastValue.skipOffsets.empty() || type->typeKind == UA_DATATYPEKIND_STRUCTURE || type->typeKind == UA_DATATYPEKIND_OPTSTRUCT) {
+            for (size_t i = 0; i < elements; i++)
+                hash = hashValue(hash, data + i * type->memSize, type, &lastValue.skipOffsets, 0);
+        }
+    }
+    leafValues.resize(elements * lastValue.leaves.size());
+    for (size_t i = 0; i < elements; i++) {
+        for (size_t j = 0; j < lastValue.leaves.size(); j++)
+            leafToDouble(data + i * type->memSize + lastValue.leaves[j].offset, lastValue.leaves[j].type, &leafValues[i * lastValue.leaves.size() + j]);
+    }
+    if (!changed)
+        changed = hash != lastValue.hash || leafValues.size() != lastValue.leafValues.size();
+    for (size_t i = 0; !changed && i < leafValues.size(); i++)
+        changed = deadbandExceeded(&filter->deadbands[lastValue.leaves[i % lastValue.leaves.size()].deadband], lastValue.leafValues[i], leafValues[i]);
+    if (!changed) {
+        filter->unchanged++;
+        return false;
+    }
+    lastValue.hash = hash;
+    lastValue.leafValues.swap(leafValues);
+    filter->changed++;
+    return true;
+}
+
+// frees deadbands and last values
+void UA_ChangeFilter_clear(UA_ChangeFilter* filter) {
+    if (!filter)
+        return;
+    for (UA_Deadband& deadband : filter->deadbands)
+        UA_NodeId_clear(&deadband.nodeId);
+    for (std::pair<const UA_NodeId, UA_LastValue>& lastValue : filter->lastValues)
+        UA_NodeId_clear((UA_NodeId*)&lastValue.first);
+    UA_ChangeFilter_init(filter);
+}
+
+typedef struct {
+    UA_OutputSink* sink;
+    UA_PrintFormat format;
+    UA_ChangeFilter* filter;
+} readAndPrintContext_t;
+
+// callback of UA_ReadAndPrintValues, writes node ID and value (or status code if the value is not available)
+static UA_StatusCode readAndPrintValue(void* context, const UA_NodeId* nodeId, const UA_NodeId* dataTypeId, UA_DataValue* value) {
+    const readAndPrintContext_t* printContext = (const readAndPrintContext_t*)context;
+    UA_OutputSink* sink = printContext->sink;
+    const UA_Boolean hasValue = value->hasValue && value->value.type;
+    UA_StatusCode retval;
+    UA_String out;
+
+    if (printContext->filter && !UA_ChangeFilter_check(printContext->filter, nodeId, value))
+        return UA_STATUSCODE_GOOD;
+    if (printContext->format == UA_PRINTFORMAT_JSON) {
+        // one JSON object per line
+        retval = jsonWriteRaw(sink, "{\"NodeId\":");
+        retval |= jsonWriteNodeId(sink, nodeId, 0x0, 0);
+        if (value->hasStatus && value->status != UA_STATUSCODE_GOOD) {
+            retval |= jsonWriteRaw(sink, ",\"StatusCode\":");
+            retval |= jsonWriteEscaped(sink, (const UA_Byte*)UA_StatusCode_name(value->status), strlen(UA_StatusCode_name(value->status)));
+        }
+        if (hasValue) {
+            retval |= jsonWriteRaw(sink, ",\"Value\":");
+            UA_UInt64 started = metricsStart();
+            retval |= jsonEncodeValueOfDataType(sink, dataTypeId, &value->value);
+            metricsRecordPrint(started, dataTypeId, &value->value);
+        }
+        retval |= UA_OutputSink_write(sink, "}\n", 2);
+        return retval;
+    }
+    retval = UA_print(nodeId, &UA_TYPES[UA_TYPES_NODEID], &out);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+    retval = UA_OutputSink_write(sink, out.data, out.length);
+    retval |= UA_OutputSink_write(sink, "\n", 1);
+    UA_String_clear(&out);
+    if (!hasValue) {
+        const char* statusName = UA_StatusCode_name(value->hasStatus ? value->status : UA_STATUSCODE_BADNODATA);
+        retval |= UA_OutputSink_write(sink, statusName, strlen(statusName));
+        retval |= UA_OutputSink_write(sink, "\n", 1);
+        return retval;
+    }
+    UA_UInt64 started = metricsStart();
+    if (printValueOfDataType(dataTypeId, &value->value, &out) != UA_STATUSCODE_GOOD) {
+        UA_print(nodeId, &UA_TYPES[UA_TYPES_NODEID], &out);
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Could not print data of %.*s", (UA_UInt16)out.length, out.data);
+        UA_String_clear(&out);
+        return retval;
+    }
+    metricsRecordPrint(started, dataTypeId, &value->value);
+    retval |= UA_OutputSink_write(sink, out.data, out.length);
+    retval |= UA_OutputSink_write(sink, "\n", 1);
+    UA_String_clear(&out);
+    return retval;
+}
+
+// reads and prints the values of many nodes with batched ReadRequests (see UA_ReadValues)
+// UA_PRINTFORMAT_TEXT writes node ID and value (like UA_PrintValue) line by line
+// UA_PRINTFORMAT_JSON writes one object {"NodeId":..,"StatusCode":..,"Value":..} per line
+// with filter (optional) only changed values are printed (see UA_ChangeFilter_check)
+// the caller is responsible to flush the sink
+UA_StatusCode UA_ReadAndPrintValues(UA_Client* client, const UA_NodeId* nodeIds, size_t nodeIdsSize, UA_PrintFormat format, UA_OutputSink* sink,
+                                    UA_ChangeFilter* filter) {
+    readAndPrintContext_t context;
+    if (!sink || !sink->callback) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReadAndPrintValues: Parameter 5 (UA_OutputSink*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    context.sink = sink;
+    context.format = format;
+    context.filter = filter;
+    return UA_ReadValues(client, nodeIds, nodeIdsSize, readAndPrintValue, &context);
+}
+
+// data change callback of UA_Monitor, the value is taken over and collected until the end of UA_Monitor_iterate
+static void monitorDataChange(UA_Client* client, UA_UInt32 subId, void* subContext, UA_UInt32 monId, void* monContext, UA_DataValue* value) {
+    UA_Monitor* monitor = (UA_Monitor*)subContext;
+    const UA_MonitorItem* item = &monitor->items[(size_t)(uintptr_t)monContext];
+    UA_MonitoredValue monitoredValue;
+    monitoredValue.nodeId = &item->nodeId;
+    monitoredValue.dataTypeId = UA_NodeId_isNull(&item->dataTypeId) ? 0x0 : &item->dataTypeId;
+    monitoredValue.value = *value;
+    UA_DataValue_init(value);
+    monitor->values.push_back(monitoredValue);
+}
+
+// creates one subscription with monitored items for all nodes
+// the items are created in chunks according to the operation limit MaxMonitoredItemsPerCall of the server
+// the data types are read in advance, so the values can be printed without network access (see UA_DataTypeCache_prefill)
+// monitor must not be moved until UA_Monitor_delete, items which could not be created keep their status code in monitor->items
+UA_StatusCode UA_Monitor_create(UA_Client* client, const UA_NodeId* nodeIds, size_t nodeIdsSize, UA_Double samplingInterval, UA_Double publishingInterval,
+                                UA_MonitorCallback callback, void* context, UA_Monitor* monitor) {
+    UA_StatusCode retval;
+    UA_CreateSubscriptionRequest subRequest;
+    UA_CreateSubscriptionResponse subResponse;
+    UA_CreateMonitoredItemsRequest request;
+    UA_CreateMonitoredItemsResponse response;
+    std::vector<UA_MonitoredItemCreateRequest> itemRequests;
+    std::vector<void*> contexts;
+    std::vector<UA_Client_DataChangeNotificationCallback> callbacks;
+    size_t chunkSize;
+    size_t failed = 0;
+
+    if (!client) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Monitor_create: Client session invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!nodeIds && nodeIdsSize) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Monitor_create: Parameter 2 (const UA_NodeId*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!callback) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Monitor_create: Parameter 6 (UA_MonitorCallback) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!monitor) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Monitor_create: Parameter 8 (UA_Monitor*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    monitor->client = client;
+    monitor->subscriptionId = 0;
+    monitor->callback = callback;
+    monitor->context = context;
+    monitor->items.clear();
+    monitor->values.clear();
+    // enumerations are transferred as Int32, the data type tells the enumeration
+    UA_DataTypeCache_prefill(client, nodeIds, nodeIdsSize);
+    monitor->items.resize(nodeIdsSize);
+    for (size_t i = 0; i < nodeIdsSize; i++) {
+        UA_NodeId_copy(&nodeIds[i], &monitor->items[i].nodeId);
+        // not cached: null node ID
+        lookupDataTypeId(&nodeIds[i], &monitor->items[i].dataTypeId);
+        monitor->items[i].monitoredItemId = 0;
+        monitor->items[i].statusCode = UA_STATUSCODE_BADNOTHINGTODO;
+    }
+    subRequest = UA_CreateSubscriptionRequest_default();
+    subRequest.requestedPublishingInterval = publishingInterval;
+    subRequest.maxNotificationsPerPublish = 0; // no limit, all changes of a publishing interval in one notification
+    subResponse = UA_Client_Subscriptions_create(client, subRequest, monitor, 0x0, 0x0);
+    retval = subResponse.responseHeader.serviceResult;
+    if (retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Monitor_create: Could not create subscription (%s)", UA_StatusCode_name(retval));
+        UA_CreateSubscriptionResponse_clear(&subResponse);
+        return retval;
+    }
+    monitor->subscriptionId = subResponse.subscriptionId;
+    UA_CreateSubscriptionResponse_clear(&subResponse);
+    chunkSize = readOperationLimit(client, UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXMONITOREDITEMSPERCALL);
+    if (!chunkSize || chunkSize > UA_MONITOR_MAXCHUNKSIZE)
+        chunkSize = UA_MONITOR_MAXCHUNKSIZE;
+    for (size_t start = 0; start < nodeIdsSize && retval == UA_STATUSCODE_GOOD; start += chunkSize) {
+        const size_t count = std::min(chunkSize, nodeIdsSize - start);
+        itemRequests.resize(count);
+        contexts.resize(count);
+        callbacks.assign(count, monitorDataChange);
+        for (size_t i = 0; i < count; i++) {
+            // shallow copies of the node IDs, the request is not cleared
+            itemRequests[i] = UA_MonitoredItemCreateRequest_default(monitor->items[start + i].nodeId);
+            itemRequests[i].requestedParameters.samplingInterval = samplingInterval;
+            contexts[i] = (void*)(uintptr_t)(start + i);
+        }
+        UA_CreateMonitoredItemsRequest_init(&request);
+        request.subscriptionId = monitor->subscriptionId;
+        request.timestampsToReturn = UA_TIMESTAMPSTORETURN_BOTH;
+        request.itemsToCreate = itemRequests.data();
+        request.itemsToCreateSize = count;
+        response = UA_Client_MonitoredItems_createDataChanges(client, request, contexts.data(), callbacks.data(), 0x0);
+        retval = response.responseHeader.serviceResult;
+        if (retval == UA_STATUSCODE_GOOD && response.resultsSize != count)
+            retval = UA_STATUSCODE_BADUNEXPECTEDERROR;
+        for (size_t i = 0; i < count && retval == UA_STATUSCODE_GOOD; i++) {
+            monitor->items[start + i].statusCode = response.results[i].statusCode;
+            monitor->items[start + i].monitoredItemId = response.results[i].monitoredItemId;
+            if (response.results[i].statusCode != UA_STATUSCODE_GOOD)
+                failed++;
+        }
+        UA_CreateMonitoredItemsResponse_clear(&response);
+    }
+    if (retval != UA_STATUSCODE_GOOD)
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Monitor_create: Could not create monitored items (%s)", UA_StatusCode_name(retval));
+    else if (failed)
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Monitor_create: %u of %u monitored items could not be created", (UA_UInt32)failed, (UA_UInt32)nodeIdsSize);
+    return retval;
+}
+
+// processes the client (publish responses) for at most timeout ms and passes all received values as one batch to the callback
+// the callback may take over the content of the values, the remaining content is cleared afterwards
+UA_StatusCode UA_Monitor_iterate(UA_Monitor* monitor, UA_UInt32 timeout) {
+    UA_StatusCode retval;
+    if (!monitor || !monitor->client) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Monitor_iterate: Parameter 1 (UA_Monitor*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    retval = UA_Client_run_iterate(monitor->client, timeout);
+    if (monitor->values.empty())
+        return retval;
+    recordMonitoredValues(monitor);
+    retval |= monitor->callback(monitor->context, monitor->values.data(), monitor->values.size());
+    for (UA_MonitoredValue& monitoredValue : monitor->values)
+        UA_DataValue_clear(&monitoredValue.value);
+    monitor->values.clear();
+    return retval;
+}
+
+// deletes the subscription (and with it all monitored items) and frees the memory of the monitor
+UA_StatusCode UA_Monitor_delete(UA_Monitor* monitor) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    if (!monitor) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Monitor_delete: Parameter 1 (UA_Monitor*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (monitor->client && monitor->subscriptionId)
+        retval = UA_Client_Subscriptions_deleteSingle(monitor->client, monitor->subscriptionId);
+    for (UA_MonitorItem& item : monitor->items) {
+        UA_NodeId_clear(&item.nodeId);
+        UA_NodeId_clear(&item.dataTypeId);
+    }
+    for (UA_MonitoredValue& monitoredValue : monitor->values)
+        UA_DataValue_clear(&monitoredValue.value);
+    monitor->items.clear();
+    monitor->values.clear();
+    monitor->subscriptionId = 0;
+    return retval;
+}
+
+// subfunction of the poller, puts an item into the slot of the timer wheel
+static void pollerSchedule(UA_Poller* poller, size_t itemIndex, UA_UInt64 dueTick) {
+    UA_PollEntry entry;
+    entry.item = itemIndex;
+    entry.dueTick = dueTick;
+    poller->items[itemIndex].dueTick = dueTick;
+    poller->wheel[dueTick % UA_POLLER_WHEELSIZE].push_back(entry);
+}
+
+// initializes a client-side poller, tickInterval (ms) is the resolution of the timer wheel
+// the callback gets the values like the callback of UA_ReadValues
+UA_StatusCode UA_Poller_init(UA_Poller* poller, UA_Client* client, UA_UInt32 tickInterval, UA_ReadValuesCallback callback, void* context) {
+    if (!poller) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Poller_init: Parameter 1 (UA_Poller*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!client) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Poller_init: Client session invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!tickInterval) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Poller_init: Parameter 3 (UA_UInt32) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!callback) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Poller_init: Parameter 4 (UA_ReadValuesCallback) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    poller->client = client;
+    poller->tickInterval = tickInterval;
+    poller->callback = callback;
+    poller->context = context;
+    poller->chunkSize = readValuesChunkSize(client);
+    poller->startTime = UA_DateTime_nowMonotonic();
+    poller->currentTick = 0;
+    poller->items.clear();
+    poller->wheel.assign(UA_POLLER_WHEELSIZE, std::vector<UA_PollEntry>());
+    poller->dueNodeIds.clear();
+    poller->reads = 0;
+    poller->lateTicks = 0;
+    poller->overruns = 0;
+    poller->skippedSamples = 0;
+    poller->lastReadDuration = 0;
+    return UA_STATUSCODE_GOOD;
+}
+
+// adds a node to the poller, the sampling interval (ms) is rounded up to a multiple of the tick interval
+// nodes with the same sampling interval are due in the same tick and read together (rate group)
+UA_StatusCode UA_Poller_add(UA_Poller* poller, const UA_NodeId* nodeId, UA_UInt32 samplingInterval) {
+    UA_PollItem item;
+    if (!poller || !poller->client) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Poller_add: Parameter 1 (UA_Poller*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!nodeId || UA_NodeId_isNull(nodeId)) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Poller_add: Parameter 2 (const UA_NodeId*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    UA_NodeId_copy(nodeId, &item.nodeId);
+    item.intervalTicks = std::max<UA_UInt32>(1, (samplingInterval + poller->tickInterval - 1) / poller->tickInterval);
+    poller->items.push_back(item);
+    // the phase is aligned to the interval, so all nodes of a rate group are due in the same tick
+    pollerSchedule(poller, poller->items.size() - 1, (poller->currentTick / item.intervalTicks + 1) * item.intervalTicks);
+    return UA_STATUSCODE_GOOD;
+}
+
+// processes the due ticks of the timer wheel, all nodes due are read with one batched read (see UA_ReadValues)
+// if no tick is due, the client is processed until the next tick but at most timeout ms
+// if the server is slow (ticks passed during the read), samples are skipped instead of queued (backpressure)
+UA_StatusCode UA_Poller_iterate(UA_Poller* poller, UA_UInt32 timeout) {
+    UA_StatusCode retval;
+    UA_DateTime now;
+    UA_DateTime readStart;
+    UA_UInt64 targetTick;
+    UA_UInt64 afterTick;
+    UA_DateTime tickDuration;
+    std::vector<size_t> dueItems;
+
+    if (!poller || !poller->client) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Poller_iterate: Parameter 1 (UA_Poller*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    tickDuration = (UA_DateTime)poller->tickInterval * UA_DATETIME_MSEC;
+    now = UA_DateTime_nowMonotonic();
+    targetTick = (UA_UInt64)((now - poller->startTime) / tickDuration);
+    if (targetTick <= poller->currentTick) {
+        const UA_DateTime wait = poller->startTime + (UA_DateTime)(poller->currentTick + 1) * tickDuration - now;
+        return UA_Client_run_iterate(poller->client, std::min<UA_UInt32>(timeout, (UA_UInt32)(wait / UA_DATETIME_MSEC)));
+    }
+    poller->lateTicks += targetTick - poller->currentTick - 1;
+    // collect the due items of all ticks passed, every slot is visited only once
+    for (UA_UInt64 tick = poller->currentTick + 1; tick <= targetTick && tick <= poller->currentTick + UA_POLLER_WHEELSIZE; tick++) {
+        std::vector<UA_PollEntry>& slot = poller->wheel[tick % UA_POLLER_WHEELSIZE];
+        for (size_t i = 0; i < slot.size();) {
+            if (slot[i].dueTick > targetTick) {
+                i++;
+                continue;
+            }
+            dueItems.push_back(slot[i].item);
+            slot[i] = slot.back();
+            slot.pop_back();
+        }
+    }
+    poller->currentTick = targetTick;
+    if (dueItems.empty())
+        return UA_STATUSCODE_GOOD;
+    // shallow copies of the node IDs
+    poller->dueNodeIds.clear();
+    for (size_t item : dueItems)
+        poller->dueNodeIds.push_back(poller->items[item].nodeId);
+    readStart = UA_DateTime_nowMonotonic();
+    retval = readValuesChunked(poller->client, poller->dueNodeIds.data(), poller->dueNodeIds.size(), poller->chunkSize, poller->callback, poller->context);
+    now = UA_DateTime_nowMonotonic();
+    poller->reads++;
+    poller->lastReadDuration = (now - readStart) / UA_DATETIME_MSEC;
+    afterTick = (UA_UInt64)((now - poller->startTime) / tickDuration);
+    if (afterTick > targetTick)
+        poller->overruns++;
+    // reschedule, samples which are already overdue after the read are skipped
+    for (size_t item : dueItems) {
+        const UA_UInt64 intervalTicks = poller->items[item].intervalTicks;
+        UA_UInt64 dueTick = poller->items[item].dueTick + intervalTicks;
+        if (dueTick <= afterTick) {
+            const UA_UInt64 skipped = (afterTick - dueTick) / intervalTicks + 1;
+            poller->skippedSamples += skipped;
+            dueTick += skipped * intervalTicks;
+        }
+        pollerSchedule(poller, item, dueTick);
+    }
+    if (retval != UA_STATUSCODE_GOOD)
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Poller_iterate: Could not read %u values (%s)", (UA_UInt32)dueItems.size(), UA_StatusCode_name(retval));
+    return retval;
+}
+
+// frees the memory of the poller
+void UA_Poller_clear(UA_Poller* poller) {
+    if (!poller)
+        return;
+    for (UA_PollItem& item : poller->items)
+        UA_NodeId_clear(&item.nodeId);
+    poller->items.clear();
+    poller->wheel.clear();
+    poller->dueNodeIds.clear();
+    poller->client = 0x0;
+}
+
+// creates a client with the default configuration (UA_ClientFactory of the reconnect manager)
+UA_Client* UA_ClientFactory_default(void* factoryContext) {
+    UA_Client* client = UA_Client_new();
+    if (client)
+        UA_ClientConfig_setDefault(UA_Client_getConfig(client));
+    return client;
+}
+
+// returns true for status codes of a lost connection or session
+static UA_Boolean isConnectionError(UA_StatusCode statusCode) {
+    switch (statusCode) {
+    case UA_STATUSCODE_BADCONNECTIONCLOSED:
+    case UA_STATUSCODE_BADSECURECHANNELCLOSED:
+    case UA_STATUSCODE_BADSECURECHANNELIDINVALID:
+    case UA_STATUSCODE_BADSESSIONCLOSED:
+    case UA_STATUSCODE_BADSESSIONIDINVALID:
+    case UA_STATUSCODE_BADSERVERNOTCONNECTED:
+    case UA_STATUSCODE_BADCOMMUNICATIONERROR:
+    case UA_STATUSCODE_BADNOTCONNECTED:
+    case UA_STATUSCODE_BADDISCONNECT:
+    case UA_STATUSCODE_BADSHUTDOWN:
+    case UA_STATUSCODE_BADTIMEOUT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// reads a fingerprint of the type model of the server (NamespaceArray and BuildInfo) with one ReadRequest
+// a server with the same namespaces and the same build provides the same custom data types
+static UA_StatusCode readTypeModelFingerprint(UA_Client* client, UA_UInt32* fingerprint) {
+    UA_StatusCode retval;
+    UA_ReadRequest request;
+    UA_ReadResponse response;
+    UA_ReadValueId readValueIds[2];
+    UA_UInt32 hash = 0;
+
+    UA_ReadValueId_init(&readValueIds[0]);
+    readValueIds[0].nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_NAMESPACEARRAY);
+    readValueIds[0].attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_ReadValueId_init(&readValueIds[1]);
+    readValueIds[1].nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_BUILDINFO);
+    readValueIds[1].attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_ReadRequest_init(&request);
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+    request.nodesToRead = readValueIds;
+    request.nodesToReadSize = 2;
+    UA_UInt64 started = metricsStart();
+    response = UA_Client_Service_read(client, request);
+    metricsRecordResponse(UA_HISTOGRAM_READ, started, &response, &UA_TYPES[UA_TYPES_READRESPONSE]);
+    retval = response.responseHeader.serviceResult;
+    if (retval == UA_STATUSCODE_GOOD && (response.resultsSize != 2 || !response.results[0].hasValue ||
+        !UA_Variant_hasArrayType(&response.results[0].value, &UA_TYPES[UA_TYPES_STRING])))
+        retval = UA_STATUSCODE_BADUNEXPECTEDERROR;
+    if (retval == UA_STATUSCODE_GOOD) {
+        const UA_String* namespaces = (const UA_String*)response.results[0].value.data;
+        for (size_t i = 0; i < response.results[0].value.arrayLength; i++)
+            hash = UA_ByteString_SDBMHash(hash, namespaces[i].data, namespaces[i].length);
+        // BuildInfo is optional
+        if (response.results[1].hasValue && UA_Variant_hasScalarType(&response.results[1].value, &UA_TYPES[UA_TYPES_BUILDINFO])) {
+            const UA_BuildInfo* buildInfo = (const UA_BuildInfo*)response.results[1].value.data;
+            hash = UA_ByteString_SDBMHash(hash, buildInfo->productUri.data, buildInfo->productUri.length);
+            hash = UA_ByteString_SDBMHash(hash, buildInfo->softwareVersion.data, buildInfo->softwareVersion.length);
+            hash = UA_ByteString_SDBMHash(hash, buildInfo->buildNumber.data, buildInfo->buildNumber.length);
+            hash = UA_ByteString_SDBMHash(hash, (const UA_Byte*)&buildInfo->buildDate, sizeof(UA_DateTime));
+        }
+        *fingerprint = hash;
+    }
+    UA_ReadResponse_clear(&response);
+    return retval;
+}
+
+// initializes the reconnect manager, connects to the server and initializes the custom data types (full discovery)
+UA_StatusCode UA_ReconnectManager_init(UA_ReconnectManager* manager, const char* endpointUrl, UA_ClientFactory factory, void* factoryContext,
+                                       UA_UInt32 initialDelay, UA_UInt32 maxDelay) {
+    UA_StatusCode retval;
+    if (!manager) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReconnectManager_init: Parameter 1 (UA_ReconnectManager*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!endpointUrl) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReconnectManager_init: Parameter 2 (const char*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    manager->endpointUrl = endpointUrl;
+    manager->factory = factory ? factory : UA_ClientFactory_default;
+    manager->factoryContext = factoryContext;
+    manager->initialDelay = std::max<UA_UInt32>(1, initialDelay);
+    manager->maxDelay = std::max(manager->initialDelay, maxDelay);
+    manager->delay = manager->initialDelay;
+    manager->nextAttempt = 0;
+    manager->attempts = 0;
+    manager->connected = false;
+    manager->fingerprint = 0;
+    manager->queue.clear();
+    manager->client = manager->factory(manager->factoryContext);
+    if (!manager->client) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReconnectManager_init: Could not create client");
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    retval = UA_Client_connect(manager->client, endpointUrl);
+    if (retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReconnectManager_init: Could not connect to %s (%s)", endpointUrl, UA_StatusCode_name(retval));
+        return retval;
+    }
+    retval = initializeCustomDataTypes(manager->client);
+    if (retval != UA_STATUSCODE_GOOD)
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReconnectManager_init: Could not initialize custom data types (%s)", UA_StatusCode_name(retval));
+    retval = readTypeModelFingerprint(manager->client, &manager->fingerprint);
+    if (retval != UA_STATUSCODE_GOOD)
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReconnectManager_init: Could not read type model fingerprint (%s)", UA_StatusCode_name(retval));
+    manager->connected = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+// subfunction of UA_ReconnectManager_iterate, restores the connection
+// 1. re-activation of the existing session (the client still has the session)
+// 2. new session with a new client
+// the registry is reattached if the fingerprint matches, otherwise the custom data types are initialized again
+static UA_StatusCode reconnect(UA_ReconnectManager* manager) {
+    UA_StatusCode retval;
+    UA_UInt32 fingerprint;
+
+    retval = UA_STATUSCODE_BADNOTCONNECTED;
+    if (manager->client) {
+        // close the broken SecureChannel, the session is kept and re-activated by UA_Client_connect
+        UA_Client_disconnectSecureChannel(manager->client);
+        retval = UA_Client_connect(manager->client, manager->endpointUrl.c_str());
+    }
+    if (retval != UA_STATUSCODE_GOOD) {
+        if (manager->client) {
+            UA_Client_disconnect(manager->client);
+            UA_Client_delete(manager->client);
+        }
+        manager->client = manager->factory(manager->factoryContext);
+        if (!manager->client)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        UA_Client_getConfig(manager->client)->customDataTypes = customDataTypes;
+        retval = UA_Client_connect(manager->client, manager->endpointUrl.c_str());
+        if (retval != UA_STATUSCODE_GOOD)
+            return retval;
+    }
+    retval = readTypeModelFingerprint(manager->client, &fingerprint);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+    if (fingerprint == manager->fingerprint) {
+        UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReconnectManager: Reconnected to %s, custom data types reattached", manager->endpointUrl.c_str());
+        return UA_STATUSCODE_GOOD;
+    }
+    // the type model of the server changed
+    UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReconnectManager: Type model of %s changed, custom data types are initialized again", manager->endpointUrl.c_str());
+    UA_Client_getConfig(manager->client)->customDataTypes = 0x0;
+    UA_DataTypeCache_invalidate(0x0);
+    clearCustomDataTypes();
+    retval = initializeCustomDataTypes(manager->client);
+    if (retval != UA_STATUSCODE_GOOD)
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReconnectManager: Could not initialize custom data types (%s)", UA_StatusCode_name(retval));
+    manager->fingerprint = fingerprint;
+    return UA_STATUSCODE_GOOD;
+}
+
+typedef struct {
+    UA_ReadValuesCallback callback;
+    void* context;
+    size_t delivered;
+} reconnectReadContext_t;
+
+// callback of UA_ReconnectManager_read, counts the delivered values to queue only the remaining nodes
+static UA_StatusCode reconnectReadValue(void* context, const UA_NodeId* nodeId, const UA_NodeId* dataTypeId, UA_DataValue* value) {
+    reconnectReadContext_t* readContext = (reconnectReadContext_t*)context;
+    UA_StatusCode retval = readContext->callback(readContext->context, nodeId, dataTypeId, value);
+    if (retval == UA_STATUSCODE_GOOD)
+        readContext->delivered++;
+    return retval;
+}
+
+// subfunction of the reconnect manager, reads the nodes or queues the (remaining) nodes if the connection is lost
+static UA_StatusCode reconnectRead(UA_ReconnectManager* manager, const UA_NodeId* nodeIds, size_t nodeIdsSize, UA_ReadValuesCallback callback, void* context) {
+    UA_StatusCode retval;
+    reconnectReadContext_t readContext;
+    UA_QueuedRead queuedRead;
+
+    readContext.callback = callback;
+    readContext.context = context;
+    readContext.delivered = 0;
+    retval = UA_STATUSCODE_BADNOTCONNECTED;
+    if (manager->connected) {
+        retval = UA_ReadValues(manager->client, nodeIds, nodeIdsSize, reconnectReadValue, &readContext);
+        if (retval == UA_STATUSCODE_GOOD || !isConnectionError(retval))
+            return retval;
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReconnectManager: Connection to %s lost (%s)", manager->endpointUrl.c_str(), UA_StatusCode_name(retval));
+        manager->connected = false;
+        manager->delay = manager->initialDelay;
+        manager->nextAttempt = 0;
+    }
+    queuedRead.callback = callback;
+    queuedRead.context = context;
+    queuedRead.nodeIds.resize(nodeIdsSize - readContext.delivered);
+    for (size_t i = readContext.delivered; i < nodeIdsSize; i++)
+        UA_NodeId_copy(&nodeIds[i], &queuedRead.nodeIds[i - readContext.delivered]);
+    manager->queue.push_back(queuedRead);
+    return UA_STATUSCODE_GOODCOMPLETESASYNCHRONOUSLY;
+}
+
+// reads values (see UA_ReadValues), if the connection is lost the read is queued and executed after the reconnection
+// returns UA_STATUSCODE_GOODCOMPLETESASYNCHRONOUSLY for queued reads
+UA_StatusCode UA_ReconnectManager_read(UA_ReconnectManager* manager, const UA_NodeId* nodeIds, size_t nodeIdsSize, UA_ReadValuesCallback callback, void* context) {
+    if (!manager || !manager->factory) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReconnectManager_read: Parameter 1 (UA_ReconnectManager*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!nodeIds && nodeIdsSize) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReconnectManager_read: Parameter 2 (const UA_NodeId*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!callback) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReconnectManager_read: Parameter 4 (UA_ReadValuesCallback) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    // keep the order of the reads
+    if (!manager->queue.empty() && manager->connected)
+        UA_ReconnectManager_iterate(manager, 0);
+    if (!manager->queue.empty()) {
+        UA_QueuedRead queuedRead;
+        queuedRead.callback = callback;
+        queuedRead.context = context;
+        queuedRead.nodeIds.resize(nodeIdsSize);
+        for (size_t i = 0; i < nodeIdsSize; i++)
+            UA_NodeId_copy(&nodeIds[i], &queuedRead.nodeIds[i]);
+        manager->queue.push_back(queuedRead);
+        return UA_STATUSCODE_GOODCOMPLETESASYNCHRONOUSLY;
+    }
+    return reconnectRead(manager, nodeIds, nodeIdsSize, callback, context);
+}
+
+// processes the client for at most timeout ms, reconnects with exponential backoff if the connection is lost
+// and executes the queued reads after the reconnection
+UA_StatusCode UA_ReconnectManager_iterate(UA_ReconnectManager* manager, UA_UInt32 timeout) {
+    UA_StatusCode retval;
+    UA_DateTime now;
+
+    if (!manager || !manager->factory) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReconnectManager_iterate: Parameter 1 (UA_ReconnectManager*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!manager->connected) {
+        now = UA_DateTime_nowMonotonic();
+        if (now < manager->nextAttempt) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(std::min<UA_DateTime>(timeout, (manager->nextAttempt - now) / UA_DATETIME_MSEC)));
+            return UA_STATUSCODE_BADNOTCONNECTED;
+        }
+        manager->attempts++;
+        retval = reconnect(manager);
+        if (retval != UA_STATUSCODE_GOOD) {
+            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReconnectManager: Reconnection to %s failed, next attempt in %u ms (%s)",
+                           manager->endpointUrl.c_str(), manager->delay, UA_StatusCode_name(retval));
+            manager->nextAttempt = UA_DateTime_nowMonotonic() + (UA_DateTime)manager->delay * UA_DATETIME_MSEC;
+            manager->delay = std::min(manager->delay * 2, manager->maxDelay);
+            return retval;
+        }
+        manager->connected = true;
+        manager->delay = manager->initialDelay;
+    }
+    // execute queued reads in order, a read which fails again stays in the queue
+    while (!manager->queue.empty() && manager->connected) {
+        UA_QueuedRead queuedRead = manager->queue.front();
+        manager->queue.pop_front();
+        reconnectRead(manager, queuedRead.nodeIds.data(), queuedRead.nodeIds.size(), queuedRead.callback, queuedRead.context);
+        for (UA_NodeId& nodeId : queuedRead.nodeIds)
+            UA_NodeId_clear(&nodeId);
+        if (!manager->connected) {
+            // the remaining nodes were queued at the end, move them to the front
+            manager->queue.push_front(manager->queue.back());
+            manager->queue.pop_back();
+            return UA_STATUSCODE_BADNOTCONNECTED;
+        }
+    }
+    retval = UA_Client_run_iterate(manager->client, timeout);
+    if (isConnectionError(retval)) {
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReconnectManager: Connection to %s lost (%s)", manager->endpointUrl.c_str(), UA_StatusCode_name(retval));
+        manager->connected = false;
+        manager->delay = manager->initialDelay;
+        manager->nextAttempt = 0;
+    }
+    return retval;
+}
+
+// disconnects and deletes the client, queued reads are discarded
+void UA_ReconnectManager_clear(UA_ReconnectManager* manager) {
+    if (!manager)
+        return;
+    for (UA_QueuedRead& queuedRead : manager->queue) {
+        for (UA_NodeId& nodeId : queuedRead.nodeIds)
+            UA_NodeId_clear(&nodeId);
+    }
+    manager->queue.clear();
+    if (manager->client) {
+        UA_Client_disconnect(manager->client);
+        UA_Client_delete(manager->client);
+        manager->client = 0x0;
+    }
+    manager->connected = false;
+}
+
+// opens several sessions to the same server, all clients share the custom data types (initializeCustomDataTypes has to be called before)
+UA_StatusCode UA_ReaderPool_init(UA_ReaderPool* pool, const char* endpointUrl, size_t sessions, UA_ClientFactory factory, void* factoryContext) {
+    UA_StatusCode retval;
+    UA_Client* client;
+    if (!pool) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReaderPool_init: Parameter 1 (UA_ReaderPool*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!endpointUrl) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReaderPool_init: Parameter 2 (const char*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!sessions) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReaderPool_init: Parameter 3 (size_t) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!factory)
+        factory = UA_ClientFactory_default;
+    pool->clients.clear();
+    pool->chunkSize = 2 * UA_READVALUES_MAXCHUNKSIZE;
+    for (size_t i = 0; i < sessions; i++) {
+        client = factory(factoryContext);
+        if (!client) {
+            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReaderPool_init: Could not create client");
+            UA_ReaderPool_clear(pool);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        // the registry is not modified while the pool reads
+        UA_Client_getConfig(client)->customDataTypes = customDataTypes;
+        retval = UA_Client_connect(client, endpointUrl);
+        if (retval != UA_STATUSCODE_GOOD) {
+            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReaderPool_init: Could not open session %u to %s (%s)", (UA_UInt32)i + 1, endpointUrl, UA_StatusCode_name(retval));
+            UA_Client_delete(client);
+            UA_ReaderPool_clear(pool);
+            return retval;
+        }
+        pool->clients.push_back(client);
+    }
+    pool->chunkSize = readValuesChunkSize(pool->clients[0]);
+    return UA_STATUSCODE_GOOD;
+}
+
+typedef struct {
+    const UA_NodeId* nodeIds; // first node of the shard
+    std::vector<UA_DataValue> values;
+    std::vector<UA_NodeId> dataTypeIds;
+    size_t delivered;
+    UA_StatusCode retval;
+} readerShard_t;
+
+// callback of the readers, the values are taken over into the shard
+static UA_StatusCode readerPoolCollect(void* context, const UA_NodeId* nodeId, const UA_NodeId* dataTypeId, UA_DataValue* value) {
+    readerShard_t* shard = (readerShard_t*)context;
+    const size_t index = nodeId - shard->nodeIds;
+    shard->values[index] = *value;
+    UA_DataValue_init(value);
+    if (dataTypeId)
+        UA_NodeId_copy(dataTypeId, &shard->dataTypeIds[index]);
+    shard->delivered = index + 1;
+    return UA_STATUSCODE_GOOD;
+}
+
+// reads the values of the nodes in parallel, the node list is split into one contiguous shard per session
+// the callback is called in the calling thread once per node in the order of nodeIds (like UA_ReadValues)
+// nodes of a shard which could not be read get the status code of the failed read
+UA_StatusCode UA_ReaderPool_read(UA_ReaderPool* pool, const UA_NodeId* nodeIds, size_t nodeIdsSize, UA_ReadValuesCallback callback, void* context) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    std::vector<readerShard_t> shards;
+    std::vector<std::thread> readers;
+    size_t shardSize;
+    UA_Boolean callbackFailed = false;
+
+    if (!pool || pool->clients.empty()) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReaderPool_read: Parameter 1 (UA_ReaderPool*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!nodeIds && nodeIdsSize) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReaderPool_read: Parameter 2 (const UA_NodeId*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!callback) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReaderPool_read: Parameter 4 (UA_ReadValuesCallback) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!nodeIdsSize)
+        return UA_STATUSCODE_GOOD;
+    shardSize = (nodeIdsSize + pool->clients.size() - 1) / pool->clients.size();
+    shards.resize((nodeIdsSize + shardSize - 1) / shardSize);
+    for (size_t i = 0; i < shards.size(); i++) {
+        readerShard_t* shard = &shards[i];
+        const size_t count = std::min(shardSize, nodeIdsSize - i * shardSize);
+        shard->nodeIds = &nodeIds[i * shardSize];
+        shard->values.resize(count);
+        shard->dataTypeIds.resize(count);
+        for (size_t j = 0; j < count; j++) {
+            UA_DataValue_init(&shard->values[j]);
+            UA_NodeId_init(&shard->dataTypeIds[j]);
+        }
+        shard->delivered = 0;
+        shard->retval = UA_STATUSCODE_GOOD;
+    }
+    // every session is used by one thread only
+    for (size_t i = 0; i < shards.size(); i++) {
+        readers.push_back(std::thread([pool, &shards, i]() {
+            readerShard_t* shard = &shards[i];
+            shard->retval = readValuesChunked(pool->clients[i], shard->nodeIds, shard->values.size(), pool->chunkSize, readerPoolCollect, shard);
+        }));
+    }
+    // merge in input order, a shard is passed on as soon as its reader is finished
+    // if the callback fails, the remaining values are discarded
+    for (size_t i = 0; i < shards.size(); i++) {
+        readerShard_t* shard = &shards[i];
+        readers[i].join();
+        if (shard->retval != UA_STATUSCODE_GOOD) {
+            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_ReaderPool_read: Session %u could not read %u values (%s)",
+                           (UA_UInt32)i + 1, (UA_UInt32)(shard->values.size() - shard->delivered), UA_StatusCode_name(shard->retval));
+            if (retval == UA_STATUSCODE_GOOD)
+                retval = shard->retval;
+        }
+        for (size_t j = 0; j < shard->values.size(); j++) {
+            if (j >= shard->delivered) {
+                shard->values[j].hasStatus = true;
+                shard->values[j].status = shard->retval;
+            }
+            if (!callbackFailed && callback(context, &shard->nodeIds[j], UA_NodeId_isNull(&shard->dataTypeIds[j]) ? 0x0 : &shard->dataTypeIds[j], &shard->values[j]) != UA_STATUSCODE_GOOD) {
+                callbackFailed = true;
+                retval = UA_STATUSCODE_BADUNEXPECTEDERROR;
+            }
+            UA_DataValue_clear(&shard->values[j]);
+            UA_NodeId_clear(&shard->dataTypeIds[j]);
+        }
+    }
+    return retval;
+}
+
+// disconnects and deletes all sessions of the pool
+void UA_ReaderPool_clear(UA_ReaderPool* pool) {
+    if (!pool)
+        return;
+    for (UA_Client* client : pool->clients) {
+        UA_Client_disconnect(client);
+        UA_Client_delete(client);
+    }
+    pool->clients.clear();
+}
+
+// result of the reads of one custom data type node
+typedef struct {
+    customTypeProperties_t customTypeProperties;
+    std::string browseName;
+    UA_Boolean valid; // node class, references and browse name could be read
+    UA_StatusCode retval;
+} customTypeEntry_t;
+
+// calls worker(worker index, first index, end index) for contiguous shards of size elements
+// with one worker the calling thread processes all elements, otherwise each shard gets its own thread
+static void forEachShard(size_t workers, size_t size, const std::function<void(size_t, size_t, size_t)>& worker) {
+    std::vector<std::thread> threads;
+    size_t shardSize;
+
+    if (!size)
+        return;
+    if (workers > size)
+        workers = size;
+    if (workers <= 1) {
+        worker(0, 0, size);
+        return;
+    }
+    shardSize = (size + workers - 1) / workers;
+    for (size_t i = 0; i * shardSize < size; i++)
+        threads.push_back(std::thread(worker, i, i * shardSize, std::min(size, (i + 1) * shardSize)));
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+// opens the additional sessions of the parallel type discovery at the same time
+// sessions which can not be opened are skipped, the discovery continues with the remaining ones
+static void openDiscoverySessions(const UA_DiscoveryConfig* discoveryConfig, std::vector<UA_Client*>* clients) {
+    const UA_ClientFactory factory = discoveryConfig->factory ? discoveryConfig->factory : UA_ClientFactory_default;
+    std::vector<UA_Client*> sessions(discoveryConfig->sessions, (UA_Client*)0x0);
+
+    if (!discoveryConfig->endpointUrl) {
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "scan4BaseDataTypes: No endpoint URL for the discovery sessions, scanning with one session");
+        return;
+    }
+    forEachShard(sessions.size(), sessions.size(), [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            UA_Client* client = factory(discoveryConfig->factoryContext);
+            if (!client)
+                continue;
+            UA_StatusCode retval = UA_Client_connect(client, discoveryConfig->endpointUrl);
+            if (retval != UA_STATUSCODE_GOOD) {
+                UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "scan4BaseDataTypes: Could not open discovery session %u (%s)", (UA_UInt32)i + 1, UA_StatusCode_name(retval));
+                UA_Client_delete(client);
+                continue;
+            }
+            sessions[i] = client;
+        }
+    });
+    for (UA_Client* client : sessions) {
+        if (client)
+            clients->push_back(client);
+    }
+}
+
+// subfunction of scan4BaseDataTypes, reads node class, references, browse name and properties of a custom data type node
+static void readCustomTypeProperties(UA_Client* client, const UA_NodeId* id, customTypeEntry_t* entry) {
+    customTypeProperties_t& customTypeProperties = entry->customTypeProperties;
+    std::string& csBrowseName = entry->browseName;
+    UA_BrowseResponse bResp;
+    UA_NodeClass nodeClass;
+    UA_QualifiedName browseName;
+    UA_StatusCode retval;
+    UA_String out;
+    traceSpan_t span("discovery", "readCustomTypeProperties");
+
+    if (span.active())
+        span.detail = traceNodeId(id);
+    entry->valid = false;
+    UA_UInt64 started = metricsStart();
+    UA_Int64 traced = traceBegin();
+    retval = UA_Client_readNodeClassAttribute(client, *id, &nodeClass);
+    metricsRecord(UA_HISTOGRAM_READ, started);
+    traceEnd(traced, "network", "Read NodeClass");
+    if (retval != UA_STATUSCODE_GOOD) {
+        UA_print(id, &UA_TYPES[UA_TYPES_NODEID], &out);
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "scan4BaseDataTypes: Could not read \"NodeClassAttribute\" for %.*s. (%s)", (UA_UInt16)out.length, out.data, UA_StatusCode_name(retval));
+        UA_String_clear(&out);
+        entry->retval = retval;
+        return;
+    }
+    // retrieve node id references
+    retval |= browseNodeId(client, *id, &bResp);
+    if (retval != UA_STATUSCODE_GOOD) {
+        UA_print(id, &UA_TYPES[UA_TYPES_NODEID], &out);
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "scan4BaseDataTypes: Could not browse %.*s. (%s)", (UA_UInt16)out.length, out.data, UA_StatusCode_name(retval));
+        UA_String_clear(&out);
+        entry->retval = retval;
+        return;
+    }
+    // the link between node tree and dictionary is the BrowseName
+    started = metricsStart();
+    traced = traceBegin();
+    retval = UA_Client_readBrowseNameAttribute(client, *id, &browseName);
+    metricsRecord(UA_HISTOGRAM_READ, started);
+    traceEnd(traced, "network", "Read BrowseName");
+    if (retval != UA_STATUSCODE_GOOD) {
+        UA_print(id, &UA_TYPES[UA_TYPES_NODEID], &out);
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "scan4BaseDataTypes: Could not read \"BrowseNameAttribute\" for %.*s. (%s)", (UA_UInt16)out.length, out.data, UA_StatusCode_name(retval));
+        UA_String_clear(&out);
+        UA_BrowseResponse_clear(&bResp);
+        entry->retval = retval;
+        return;
+    }
+    customTypePropertiesInit(&customTypeProperties, id);
+    csBrowseName = std::string((char*)browseName.name.data, browseName.name.length);
+    UA_QualifiedName_clear(&browseName);
+    if (span.active())
+        span.detail = csBrowseName + " (" + span.detail + ")";
+#ifdef UA_ENABLE_TYPEDESCRIPTION
+    customTypeProperties.dataType.typeName = internRegistryName(csBrowseName.c_str());
+#endif
+    for (UA_UInt16 i = 0; i < bResp.resultsSize; i++) {
+        // check data type reference first and save type in customTypeProperties
+        for (UA_UInt16 j = 0; j < bResp.results[i].referencesSize; j++) {
+            if (!UA_NodeId_equal(&bResp.results[i].references[j].referenceTypeId, &NS0ID_HASSUBTYPE))
+                continue;
+            UA_NodeId_copy(&bResp.results[i].references[j].nodeId.nodeId, &customTypeProperties.subTypeOfId);
+            getSubTypeProperties(&customTypeProperties.subTypeOfId, &customTypeProperties);
+        } // end for(UA_UInt16 j = 0; j < bResp.results[i].referencesSize; j++)
+        // check other references
+        for (UA_UInt16 j = 0; j < bResp.results[i].referencesSize; j++) {
+            // check for binary encoding node ID
+            if (UA_NodeId_equal(&bResp.results[i].references[j].referenceTypeId, &NS0ID_HASENCODING))
+                UA_NodeId_copy(&bResp.results[i].references[j].nodeId.nodeId, &customTypeProperties.dataType.binaryEncodingId);
+            // referenced properties check
+            else if (UA_NodeId_equal(&bResp.results[i].references[j].referenceTypeId, &NS0ID_HASPROPERTY)) {
+                UA_Variant outValue;
+                started = metricsStart();
+                traced = traceBegin();
+                retval = UA_Client_readValueAttribute(client, bResp.results[i].references[j].nodeId.nodeId, &outValue);
+                metricsRecord(UA_HISTOGRAM_READ, started);
+                traceEnd(traced, "network", "Read property");
+                // collect structure and enumeration properties of custom data type
+                if (retval == UA_STATUSCODE_GOOD && !UA_Variant_isScalar(&outValue)) {
+                    if (outValue.type->typeId.identifier.numeric == UA_NS0ID_LOCALIZEDTEXT) {
+                        // EnumStrings (values 0, 1, ...) or OptionSetValues (names of bit 0, 1, ...)
+                        UA_LocalizedText* data = (UA_LocalizedText*)outValue.data;
+                        std::vector<UA_UInt32> names;
+                        for (UA_UInt32 i = 0; i < (UA_UInt32)outValue.arrayLength; i++)
+                            names.push_back(internRegistryString((const char*)data[i].text.data, data[i].text.length));
+                        if (customTypeProperties.dataType.typeKind == UA_DATATYPEKIND_ENUM) {
+                            std::vector<UA_Int64> values(names.size());
+                            for (UA_UInt32 i = 0; i < (UA_UInt32)values.size(); i++)
+                                values[i] = i;
+                            setEnumValues(&customTypeProperties, values, names);
+                        }
+                        else
+                            setOptionBits(&customTypeProperties, names);
+                    } // end if(outValue.type->typeId.identifier.numeric == UA_NS0ID_LOCALIZEDTEXT)
+                    else if (outValue.type->typeKind == UA_DATATYPEKIND_EXTENSIONOBJECT) {
+                        if (!UA_Variant_isScalar(&outValue)) {
+                            std::vector<UA_Int64> values;
+                            std::vector<UA_UInt32> names;
+                            for (UA_UInt32 i = 0; i < (UA_UInt32)outValue.arrayLength; i++) {
+                                if (((UA_ExtensionObject*)outValue.data)[i].encoding == UA_EXTENSIONOBJECT_DECODED) {
+                                    const UA_DataType* dataType = ((UA_ExtensionObject*)outValue.data)[i].content.decoded.type;
+                                    UA_ExtensionObject* extObj = &((UA_ExtensionObject*)outValue.data)[i];
+                                    if (extObj->encoding == UA_EXTENSIONOBJECT_DECODED && dataType->typeKind == UA_DATATYPEKIND_STRUCTURE) {// && dataType->typeIndex == UA_TYPES_ENUMVALUETYPE) {
+                                        UA_EnumValueType* enumValue = (UA_EnumValueType*)extObj->content.decoded.data;
+                                        values.push_back(enumValue->value);
+                                        names.push_back(internRegistryString((const char*)enumValue->displayName.text.data, enumValue->displayName.text.length));
+                                    }
+                                }
+                            }
+                            // EnumValues
+                            if (!values.empty())
+                                setEnumValues(&customTypeProperties, values, names);
+                        } // if(!UA_Variant_isScalar(&outValue))
+                    } // end else if(outValue.type->typeKind == UA_DATATYPEKIND_EXTENSIONOBJECT)
+                    UA_Variant_clear(&outValue);
+                } // end if(retval == UA_STATUSCODE_GOOD && !UA_Variant_isScalar(&outValue))
+            } // end else if(UA_NodeId_equal(&bResp.results[i].references[j].referenceTypeId, &NS0ID_HASPROPERTY))
+        } // end for(UA_UInt16 j = 0; j < bResp.results[i].referencesSize; j++)
+    } // end for(UA_UInt16 i = 0; i < bResp.resultsSize; i++)
+    UA_BrowseResponse_clear(&bResp);
+    entry->valid = true;
+    entry->retval = retval;
+}
+
+// splits a component "Name" or "Name[Index]" of a member path, returns false for an invalid index
+static UA_Boolean splitPathComponent(const std::string& component, std::string* name, size_t* index, UA_Boolean* hasIndex) {
+    const size_t bracket = component.find('[');
+    *hasIndex = false;
+    *index = 0;
+    *name = component;
+    if (component.empty() || component.back() != ']' || bracket == std::string::npos)
+        return true;
+    const char* first = component.data() + bracket + 1;
+    const char* last = component.data() + component.length() - 1;
+    std::from_chars_result result = std::from_chars(first, last, *index);
+    if (result.ec != std::errc() || result.ptr != last || first == last)
+        return false;
+    *name = component.substr(0, bracket);
+    *hasIndex = true;
+    return true;
+}
+
+// compares a component of a member path with the name of the member with index i
+// (the member index without UA_ENABLE_TYPEDESCRIPTION, like collectScalarLeaves)
+static UA_Boolean isMemberName(const UA_DataTypeMember* dataTypeMember, size_t i, const std::string& name) {
+#ifdef UA_ENABLE_TYPEDESCRIPTION
+    return dataTypeMember->memberName && name == dataTypeMember->memberName;
+#else
+    (void)dataTypeMember;
+    return name == std::to_string(i);
+#endif
+}
+
+// appends a step of a field path, offsets of consecutive embedded structure members are added up
+static void addFieldStep(UA_FieldPath* fieldPath, UA_FieldStepKind kind, size_t offset, size_t index, size_t elementSize) {
+    UA_FieldStep step;
+    if (kind == UA_FIELDSTEP_OFFSET && !fieldPath->steps.empty() && fieldPath->steps.back().kind == UA_FIELDSTEP_OFFSET) {
+        fieldPath->steps.back().offset += offset;
+        return;
+    }
+    step.kind = kind;
+    step.offset = offset;
+    step.index = index;
+    step.elementSize = elementSize;
+    fieldPath->steps.push_back(step);
+}
+
+// compiles a member path of a structure or union type, e.g. "Motor.Status.Speed" or "Axis[2].Position", into a chain of steps
+// the member names are the names of collectScalarLeaves (member indices without UA_ENABLE_TYPEDESCRIPTION), "" is the value itself
+// array members need an element index, optional members and union members are checked when the path is evaluated
+UA_StatusCode UA_FieldPath_compile(const UA_DataType* type, const char* path, UA_FieldPath* fieldPath) {
+    std::string component;
+    std::string name;
+    size_t index;
+    UA_Boolean hasIndex;
+
+    if (!type) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_FieldPath_compile: Parameter 1 (const UA_DataType*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!path) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_FieldPath_compile: Parameter 2 (const char*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!fieldPath) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_FieldPath_compile: Parameter 3 (UA_FieldPath*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    fieldPath->rootType = type;
+    fieldPath->type = type;
+    fieldPath->steps.clear();
+    std::istringstream components(path);
+    while (*path && std::getline(components, component, '.')) {
+        const UA_DataType* currentType = fieldPath->type;
+        const UA_DataTypeMember* dataTypeMember = 0x0;
+        size_t offset = 0;
+        size_t i;
+
+        if (!splitPathComponent(component, &name, &index, &hasIndex)) {
+            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_FieldPath_compile: invalid index in \"%s\"", component.c_str());
+            return UA_STATUSCODE_BADINDEXRANGEINVALID;
+        }
+        if (currentType->typeKind != UA_DATATYPEKIND_STRUCTURE && currentType->typeKind != UA_DATATYPEKIND_OPTSTRUCT && currentType->typeKind != UA_DATATYPEKIND_UNION) {
+            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_FieldPath_compile: \"%s\" is not a member of a structure", component.c_str());
+            return UA_STATUSCODE_BADTYPEMISMATCH;
+        }
+        // find the member and its offset (like UA_PrintStructure)
+        for (i = 0; i < currentType->membersSize; i++) {
+            const UA_DataTypeMember* member = &currentType->members[i];
+            const UA_Boolean found = isMemberName(member, i, name);
+            if (currentType->typeKind == UA_DATATYPEKIND_UNION)
+                offset = member->padding;
+            else
+                offset += member->padding;
+            if (found) {
+                dataTypeMember = member;
+                break;
+            }
+            if (member->isArray)
+                offset += sizeof(size_t) + sizeof(void*);
+            else if (member->isOptional)
+                offset += sizeof(void*);
+            else
+                offset += member->memberType->memSize;
+        }
+        if (!dataTypeMember) {
+            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_FieldPath_compile: member \"%s\" not found", name.c_str());
+            return UA_STATUSCODE_BADNOTFOUND;
+        }
+        if (dataTypeMember->isArray != hasIndex) {
+            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_FieldPath_compile: \"%s\" %s", component.c_str(), hasIndex ? "is not an array" : "needs an array index");
+            return UA_STATUSCODE_BADINDEXRANGEINVALID;
+        }
+        if (currentType->typeKind == UA_DATATYPEKIND_UNION)
+            addFieldStep(fieldPath, UA_FIELDSTEP_UNION, 0, i + 1, 0);
+        if (dataTypeMember->isArray)
+            addFieldStep(fieldPath, UA_FIELDSTEP_ARRAY, offset, index, dataTypeMember->memberType->memSize);
+        else if (dataTypeMember->isOptional)
+            addFieldStep(fieldPath, UA_FIELDSTEP_POINTER, offset, 0, 0);
+        else
+            addFieldStep(fieldPath, UA_FIELDSTEP_OFFSET, offset, 0, 0);
+        fieldPath->type = dataTypeMember->memberType;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+// evaluates a compiled field path for the value with the given index (0 for scalars) without copying
+// field points into the memory of data and is valid as long as data is not changed
+UA_StatusCode UA_FieldPath_get(const UA_FieldPath* fieldPath, const UA_Variant* data, size_t index, const void** field) {
+    const UA_Byte* p;
+    if (!fieldPath || !fieldPath->rootType) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_FieldPath_get: Parameter 1 (const UA_FieldPath*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!data) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_FieldPath_get: Parameter 2 (const UA_Variant*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!field) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_FieldPath_get: Parameter 4 (const void**) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (data->type != fieldPath->rootType)
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+    if (data->data <= UA_EMPTY_ARRAY_SENTINEL)
+        return UA_STATUSCODE_BADNODATA;
+    if (index >= (UA_Variant_isScalar(data) ? 1 : data->arrayLength))
+        return UA_STATUSCODE_BADINDEXRANGENODATA;
+    p = (const UA_Byte*)data->data + index * data->type->memSize;
+    for (const UA_FieldStep& step : fieldPath->steps) {
+        switch (step.kind) {
+        case UA_FIELDSTEP_OFFSET:
+            p += step.offset;
+            break;
+        case UA_FIELDSTEP_POINTER:
+            p = *(UA_Byte* const*)(p + step.offset);
+            if (!p)
+                return UA_STATUSCODE_BADNODATA; // optional field not set
+            break;
+        case UA_FIELDSTEP_ARRAY: {
+            const size_t length = *(const size_t*)(p + step.offset);
+            const UA_Byte* array = *(UA_Byte* const*)(p + step.offset + sizeof(size_t));
+            if (step.index >= length || array <= UA_EMPTY_ARRAY_SENTINEL)
+                return UA_STATUSCODE_BADINDEXRANGENODATA;
+            p = array + step.index * step.elementSize;
+            break;
+        }
+        case UA_FIELDSTEP_UNION:
+            if (*(const UA_UInt32*)p != step.index)
+                return UA_STATUSCODE_BADNODATA; // other union member selected
+            p += step.offset;
+            break;
+        }
+    }
+    *field = p;
+    return UA_STATUSCODE_GOOD;
+}
+
+// evaluates a compiled field path of a numeric field and converts the value to double
+UA_StatusCode UA_FieldPath_getDouble(const UA_FieldPath* fieldPath, const UA_Variant* data, size_t index, UA_Double* value) {
+    const void* field;
+    UA_StatusCode retval;
+    if (!value) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_FieldPath_getDouble: Parameter 4 (UA_Double*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    retval = UA_FieldPath_get(fieldPath, data, index, &field);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+    return leafToDouble((const UA_Byte*)field, fieldPath->type, value) ? UA_STATUSCODE_GOOD : UA_STATUSCODE_BADTYPEMISMATCH;
+}
+
+// size of a value in binary encoding, 0 for values of variable size
+static size_t encodedFixedSize(const UA_DataType* type) {
+    size_t size = 0;
+    switch (type->typeKind) {
+    case UA_DATATYPEKIND_BOOLEAN:
+    case UA_DATATYPEKIND_SBYTE:
+    case UA_DATATYPEKIND_BYTE:
+        return 1;
+    case UA_DATATYPEKIND_INT16:
+    case UA_DATATYPEKIND_UINT16:
+        return 2;
+    case UA_DATATYPEKIND_INT32:
+    case UA_DATATYPEKIND_UINT32:
+    case UA_DATATYPEKIND_FLOAT:
+    case UA_DATATYPEKIND_STATUSCODE:
+    case UA_DATATYPEKIND_ENUM:
+        return 4;
+    case UA_DATATYPEKIND_INT64:
+    case UA_DATATYPEKIND_UINT64:
+    case UA_DATATYPEKIND_DOUBLE:
+    case UA_DATATYPEKIND_DATETIME:
+        return 8;
+    case UA_DATATYPEKIND_GUID:
+        return 16;
+    case UA_DATATYPEKIND_STRUCTURE:
+        for (size_t i = 0; i < type->membersSize; i++) {
+            const size_t memberSize = type->members[i].isArray ? 0 : encodedFixedSize(type->members[i].memberType);
+            if (!memberSize)
+                return 0;
+            size += memberSize;
+        }
+        return size;
+    default:
+        return 0;
+    }
+}
+
+// value of length bytes in little endian byte order (binary encoding)
+static UA_UInt64 readLittleEndian(const UA_Byte* data, size_t length) {
+    UA_UInt64 value = 0;
+    for (size_t i = length; i > 0; i--)
+        value = (value << 8) | data[i - 1];
+    return value;
+}
+
+static UA_StatusCode skipEncodedBytes(const UA_ByteString* body, size_t* position, size_t length) {
+    if (length > body->length - *position)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    *position += length;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode readEncodedUInt32(const UA_ByteString* body, size_t* position, UA_UInt32* value) {
+    if (body->length - *position < 4)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    *value = (UA_UInt32)readLittleEndian(&body->data[*position], 4);
+    *position += 4;
+    return UA_STATUSCODE_GOOD;
+}
+
+// skips a string or byte string (length -1 is a null string)
+static UA_StatusCode skipEncodedString(const UA_ByteString* body, size_t* position) {
+    UA_UInt32 length;
+    UA_StatusCode retval = readEncodedUInt32(body, position, &length);
+    if (retval != UA_STATUSCODE_GOOD || (UA_Int32)length <= 0)
+        return retval;
+    return skipEncodedBytes(body, position, length);
+}
+
+static UA_StatusCode skipEncodedArray(const UA_ByteString* body, size_t* position, const UA_DataType* type);
+
+// skips one binary encoded value without decoding it
+static UA_StatusCode skipEncodedValue(const UA_ByteString* body, size_t* position, const UA_DataType* type) {
+    const size_t fixedSize = encodedFixedSize(type);
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    UA_UInt32 mask;
+    UA_Byte encoding;
+
+    if (fixedSize)
+        return skipEncodedBytes(body, position, fixedSize);
+    switch (type->typeKind) {
+    case UA_DATATYPEKIND_STRING:
+    case UA_DATATYPEKIND_BYTESTRING:
+    case UA_DATATYPEKIND_XMLELEMENT:
+        return skipEncodedString(body, position);
+    case UA_DATATYPEKIND_NODEID:
+    case UA_DATATYPEKIND_EXPANDEDNODEID:
+        if (*position >= body->length)
+            return UA_STATUSCODE_BADDECODINGERROR;
+        encoding = body->data[(*position)++];
+        switch (encoding & 0x0F) {
+        case 0: // two byte
+            retval = skipEncodedBytes(body, position, 1);
+            break;
+        case 1: // four byte
+            retval = skipEncodedBytes(body, position, 3);
+            break;
+        case 2: // numeric
+            retval = skipEncodedBytes(body, position, 6);
+            break;
+        case 3: // string
+        case 5: // byte string
+            retval = skipEncodedBytes(body, position, 2);
+            retval |= skipEncodedString(body, position);
+            break;
+        case 4: // guid
+            retval = skipEncodedBytes(body, position, 18);
+            break;
+        default:
+            return UA_STATUSCODE_BADDECODINGERROR;
+        }
+        if (retval == UA_STATUSCODE_GOOD && type->typeKind == UA_DATATYPEKIND_EXPANDEDNODEID) {
+            if (encoding & 0x80) // namespace URI
+                retval = skipEncodedString(body, position);
+            if (retval == UA_STATUSCODE_GOOD && (encoding & 0x40)) // server index
+                retval = skipEncodedBytes(body, position, 4);
+        }
+        return retval;
+    case UA_DATATYPEKIND_QUALIFIEDNAME:
+        retval = skipEncodedBytes(body, position, 2);
+        return retval == UA_STATUSCODE_GOOD ? skipEncodedString(body, position) : retval;
+    case UA_DATATYPEKIND_LOCALIZEDTEXT:
+        if (*position >= body->length)
+            return UA_STATUSCODE_BADDECODINGERROR;
+        encoding = body->data[(*position)++];
+        if (encoding & 0x01) // locale
+            retval = skipEncodedString(body, position);
+        if (retval == UA_STATUSCODE_GOOD && (encoding & 0x02)) // text
+            retval = skipEncodedString(body, position);
+        return retval;
+    case UA_DATATYPEKIND_EXTENSIONOBJECT:
+        retval = skipEncodedValue(body, position, &UA_TYPES[UA_TYPES_NODEID]);
+        if (retval != UA_STATUSCODE_GOOD || *position >= body->length)
+            return UA_STATUSCODE_BADDECODINGERROR;
+        encoding = body->data[(*position)++];
+        return encoding ? skipEncodedString(body, position) : UA_STATUSCODE_GOOD;
+    case UA_DATATYPEKIND_STRUCTURE:
+    case UA_DATATYPEKIND_OPTSTRUCT: {
+        size_t optionalBit = 0;
+        mask = 0;
+        if (type->typeKind == UA_DATATYPEKIND_OPTSTRUCT)
+            retval = readEncodedUInt32(body, position, &mask);
+        for (size_t i = 0; i < type->membersSize && retval == UA_STATUSCODE_GOOD; i++) {
+            const UA_DataTypeMember* dataTypeMember = &type->members[i];
+            if (dataTypeMember->isOptional && !(mask & (0x01u << optionalBit++)))
+                continue;
+            if (dataTypeMember->isArray)
+                retval = skipEncodedArray(body, position, dataTypeMember->memberType);
+            else
+                retval = skipEncodedValue(body, position, dataTypeMember->memberType);
+        }
+        return retval;
+    }
+    case UA_DATATYPEKIND_UNION: {
+        retval = readEncodedUInt32(body, position, &mask);
+        if (retval != UA_STATUSCODE_GOOD || !mask)
+            return retval;
+        if (mask > type->membersSize)
+            return UA_STATUSCODE_BADDECODINGERROR;
+        const UA_DataTypeMember* dataTypeMember = &type->members[mask - 1];
+        if (dataTypeMember->isArray)
+            return skipEncodedArray(body, position, dataTypeMember->memberType);
+        return skipEncodedValue(body, position, dataTypeMember->memberType);
+    }
+    default:
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "skipEncodedValue: Skipping of %s values is not supported", type->typeName);
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+    }
+}
+
+// skips an encoded array (length -1 is a null array), arrays of fixed size values are skipped at once
+static UA_StatusCode skipEncodedArray(const UA_ByteString* body, size_t* position, const UA_DataType* type) {
+    const size_t fixedSize = encodedFixedSize(type);
+    UA_StatusCode retval;
+    UA_UInt32 length;
+
+    retval = readEncodedUInt32(body, position, &length);
+    if (retval != UA_STATUSCODE_GOOD || (UA_Int32)length <= 0)
+        return retval;
+    if (fixedSize) {
+        if (length > (body->length - *position) / fixedSize)
+            return UA_STATUSCODE_BADDECODINGERROR;
+        return skipEncodedBytes(body, position, length * fixedSize);
+    }
+    for (UA_UInt32 i = 0; i < length && retval == UA_STATUSCODE_GOOD; i++)
+        retval = skipEncodedValue(body, position, type);
+    return retval;
+}
+
+// appends a step of an encoded field path, consecutive fixed size members are skipped at once
+static void addEncodedStep(UA_EncodedFieldPath* encodedFieldPath, UA_EncodedStepKind kind, size_t size, const UA_DataType* type, UA_Boolean isArray, size_t index) {
+    UA_EncodedStep step;
+    if (kind == UA_ENCODEDSTEP_SKIP && !encodedFieldPath->steps.empty() && encodedFieldPath->steps.back().kind == UA_ENCODEDSTEP_SKIP) {
+        encodedFieldPath->steps.back().size += size;
+        return;
+    }
+    step.kind = kind;
+    step.size = size;
+    step.type = type;
+    step.isArray = isArray;
+    step.index = index;
+    encodedFieldPath->steps.push_back(step);
+}
+
+// compiles a member path (see UA_FieldPath_compile) into skip rules for the binary encoding of type
+// fixed size members in front of the field are skipped at once, members of variable size are skipped when the path is evaluated
+UA_StatusCode UA_EncodedFieldPath_compile(const UA_DataType* type, const char* path, UA_EncodedFieldPath* encodedFieldPath) {
+    std::string component;
+    std::string name;
+    size_t index;
+    UA_Boolean hasIndex;
+
+    if (!type) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_EncodedFieldPath_compile: Parameter 1 (const UA_DataType*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!path) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_EncodedFieldPath_compile: Parameter 2 (const char*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!encodedFieldPath) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_EncodedFieldPath_compile: Parameter 3 (UA_EncodedFieldPath*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    encodedFieldPath->rootType = type;
+    encodedFieldPath->type = type;
+    encodedFieldPath->steps.clear();
+    std::istringstream components(path);
+    while (*path && std::getline(components, component, '.')) {
+        const UA_DataType* currentType = encodedFieldPath->type;
+        const UA_DataTypeMember* dataTypeMember;
+        size_t optionalBit = 0;
+        size_t i;
+
+        if (!splitPathComponent(component, &name, &index, &hasIndex)) {
+            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_EncodedFieldPath_compile: invalid index in \"%s\"", component.c_str());
+            return UA_STATUSCODE_BADINDEXRANGEINVALID;
+        }
+        if (currentType->typeKind != UA_DATATYPEKIND_STRUCTURE && currentType->typeKind != UA_DATATYPEKIND_OPTSTRUCT && currentType->typeKind != UA_DATATYPEKIND_UNION) {
+            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_EncodedFieldPath_compile: \"%s\" is not a member of a structure", component.c_str());
+            return UA_STATUSCODE_BADTYPEMISMATCH;
+        }
+        for (i = 0; i < currentType->membersSize && !isMemberName(&currentType->members[i], i, name); i++)
+            ;
+        if (i == currentType->membersSize) {
+            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_EncodedFieldPath_compile: member \"%s\" not found", name.c_str());
+            return UA_STATUSCODE_BADNOTFOUND;
+        }
+        dataTypeMember = &currentType->members[i];
+        if (dataTypeMember->isArray != hasIndex) {
+            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_EncodedFieldPath_compile: \"%s\" %s", component.c_str(), hasIndex ? "is not an array" : "needs an array index");
+            return UA_STATUSCODE_BADINDEXRANGEINVALID;
+        }
+        if (currentType->typeKind == UA_DATATYPEKIND_UNION)
+            addEncodedStep(encodedFieldPath, UA_ENCODEDSTEP_UNION, 0, 0x0, false, i + 1);
+        else {
+            if (currentType->typeKind == UA_DATATYPEKIND_OPTSTRUCT)
+                addEncodedStep(encodedFieldPath, UA_ENCODEDSTEP_MASK, 0, 0x0, false, 0);
+            // skip rules of the members in front of the field
+            for (size_t j = 0; j <= i; j++) {
+                const UA_DataTypeMember* member = &currentType->members[j];
+                const size_t fixedSize = member->isArray ? 0 : encodedFixedSize(member->memberType);
+                if (member->isOptional && optionalBit >= 32) {
+                    UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_EncodedFieldPath_compile: more than 32 optional fields are not supported");
+                    return UA_STATUSCODE_BADNOTSUPPORTED;
+                }
+                if (j == i) {
+                    if (member->isOptional)
+                        addEncodedStep(encodedFieldPath, UA_ENCODEDSTEP_OPTIONAL, 0, 0x0, false, optionalBit);
+                    break;
+                }
+                if (member->isOptional)
+                    addEncodedStep(encodedFieldPath, UA_ENCODEDSTEP_SKIPOPTIONAL, fixedSize, member->memberType, member->isArray, optionalBit++);
+                else if (fixedSize)
+                    addEncodedStep(encodedFieldPath, UA_ENCODEDSTEP_SKIP, fixedSize, 0x0, false, 0);
+                else
+                    addEncodedStep(encodedFieldPath, UA_ENCODEDSTEP_SKIPVALUE, 0, member->memberType, member->isArray, 0);
+            }
+        }
+        if (dataTypeMember->isArray)
+            addEncodedStep(encodedFieldPath, UA_ENCODEDSTEP_ARRAY, encodedFixedSize(dataTypeMember->memberType), dataTypeMember->memberType, true, index);
+        encodedFieldPath->type = dataTypeMember->memberType;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+// evaluates the skip rules of an encoded field path, position is the offset of the field in the body
+static UA_StatusCode evaluateEncodedFieldPath(const UA_EncodedFieldPath* encodedFieldPath, const UA_ExtensionObject* extensionObject, const UA_ByteString** body, size_t* position) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    UA_UInt32 mask = 0;
+    UA_UInt32 value;
+
+    if (!encodedFieldPath || !encodedFieldPath->rootType) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_EncodedFieldPath_get: Parameter 1 (const UA_EncodedFieldPath*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!extensionObject) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_EncodedFieldPath_get: Parameter 2 (const UA_ExtensionObject*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    // only binary encoded bodies of the compiled type (decoded values: see UA_FieldPath_get)
+    if (extensionObject->encoding != UA_EXTENSIONOBJECT_ENCODED_BYTESTRING)
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+    if (!UA_NodeId_isNull(&encodedFieldPath->rootType->binaryEncodingId) && !UA_NodeId_equal(&extensionObject->content.encoded.typeId, &encodedFieldPath->rootType->binaryEncodingId))
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+    *body = &extensionObject->content.encoded.body;
+    *position = 0;
+    for (const UA_EncodedStep& step : encodedFieldPath->steps) {
+        switch (step.kind) {
+        case UA_ENCODEDSTEP_SKIP:
+            retval = skipEncodedBytes(*body, position, step.size);
+            break;
+        case UA_ENCODEDSTEP_SKIPVALUE:
+            retval = step.isArray ? skipEncodedArray(*body, position, step.type) : skipEncodedValue(*body, position, step.type);
+            break;
+        case UA_ENCODEDSTEP_MASK:
+            retval = readEncodedUInt32(*body, position, &mask);
+            break;
+        case UA_ENCODEDSTEP_SKIPOPTIONAL:
+            if (!(mask & (0x01u << step.index)))
+                break;
+            if (step.size)
+                retval = skipEncodedBytes(*body, position, step.size);
+            else
+                retval = step.isArray ? skipEncodedArray(*body, position, step.type) : skipEncodedValue(*body, position, step.type);
+            break;
+        case UA_ENCODEDSTEP_OPTIONAL:
+            if (!(mask & (0x01u << step.index)))
+                return UA_STATUSCODE_BADNODATA; // optional field not set
+            break;
+        case UA_ENCODEDSTEP_ARRAY:
+            retval = readEncodedUInt32(*body, position, &value);
+            if (retval != UA_STATUSCODE_GOOD)
+                break;
+            if ((UA_Int32)value <= 0 || step.index >= value)
+                return UA_STATUSCODE_BADINDEXRANGENODATA;
+            if (step.size)
+                retval = skipEncodedBytes(*body, position, step.index * step.size);
+            for (size_t i = 0; !step.size && i < step.index && retval == UA_STATUSCODE_GOOD; i++)
+                retval = skipEncodedValue(*body, position, step.type);
+            break;
+        case UA_ENCODEDSTEP_UNION:
+            retval = readEncodedUInt32(*body, position, &value);
+            if (retval == UA_STATUSCODE_GOOD && value != step.index)
+                return UA_STATUSCODE_BADNODATA; // other union member selected
+            break;
+        }
+        if (retval != UA_STATUSCODE_GOOD)
+            return retval;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+// evaluates a compiled encoded field path for the binary encoded body of an ExtensionObject without decoding the body
+// field points to the binary encoding of the field in the body
+UA_StatusCode UA_EncodedFieldPath_get(const UA_EncodedFieldPath* encodedFieldPath, const UA_ExtensionObject* extensionObject, const UA_Byte** field) {
+    const UA_ByteString* body;
+    size_t position;
+    UA_StatusCode retval;
+    if (!field) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_EncodedFieldPath_get: Parameter 3 (const UA_Byte**) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    retval = evaluateEncodedFieldPath(encodedFieldPath, extensionObject, &body, &position);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+    if (position >= body->length)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    *field = &body->data[position];
+    return UA_STATUSCODE_GOOD;
+}
+
+// decodes a numeric field of an encoded body as double
+UA_StatusCode UA_EncodedFieldPath_getDouble(const UA_EncodedFieldPath* encodedFieldPath, const UA_ExtensionObject* extensionObject, UA_Double* value) {
+    const UA_ByteString* body;
+    const UA_Byte* field;
+    size_t position;
+    size_t size;
+    UA_StatusCode retval;
+    UA_UInt64 bits;
+
+    if (!value) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_EncodedFieldPath_getDouble: Parameter 3 (UA_Double*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    retval = evaluateEncodedFieldPath(encodedFieldPath, extensionObject, &body, &position);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+    if (encodedFieldPath->type->typeKind < UA_DATATYPEKIND_SBYTE || encodedFieldPath->type->typeKind > UA_DATATYPEKIND_DOUBLE)
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+    size = encodedFixedSize(encodedFieldPath->type);
+    if (size > body->length - position)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    field = &body->data[position];
+    bits = readLittleEndian(field, size);
+    switch (encodedFieldPath->type->typeKind) {
+    case UA_DATATYPEKIND_SBYTE: *value = (UA_SByte)bits; break;
+    case UA_DATATYPEKIND_INT16: *value = (UA_Int16)bits; break;
+    case UA_DATATYPEKIND_INT32: *value = (UA_Int32)bits; break;
+    case UA_DATATYPEKIND_INT64: *value = (UA_Double)(UA_Int64)bits; break;
+    case UA_DATATYPEKIND_FLOAT: {
+        UA_UInt32 floatBits = (UA_UInt32)bits;
+        UA_Float f;
+        memcpy(&f, &floatBits, sizeof(UA_Float));
+        *value = f;
+        break;
+    }
+    case UA_DATATYPEKIND_DOUBLE:
+        memcpy(value, &bits, sizeof(UA_Double));
+        break;
+    default: // unsigned integers
+        *value = (UA_Double)bits;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+// returns a string field of an encoded body without copying, value points into the body and must not be cleared
+UA_StatusCode UA_EncodedFieldPath_getString(const UA_EncodedFieldPath* encodedFieldPath, const UA_ExtensionObject* extensionObject, UA_String* value) {
+    const UA_ByteString* body;
+    size_t position;
+    UA_StatusCode retval;
+    UA_UInt32 length;
+
+    if (!value) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_EncodedFieldPath_getString: Parameter 3 (UA_String*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    retval = evaluateEncodedFieldPath(encodedFieldPath, extensionObject, &body, &position);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+    if (encodedFieldPath->type->typeKind != UA_DATATYPEKIND_STRING && encodedFieldPath->type->typeKind != UA_DATATYPEKIND_BYTESTRING &&
+        encodedFieldPath->type->typeKind != UA_DATATYPEKIND_XMLELEMENT)
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+    retval = readEncodedUInt32(body, &position, &length);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+    UA_String_init(value);
+    if ((UA_Int32)length < 0)
+        return UA_STATUSCODE_GOOD; // null string
+    if (length > body->length - position)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    value->length = length;
+    value->data = length ? &body->data[position] : (UA_Byte*)UA_EMPTY_ARRAY_SENTINEL;
+    return UA_STATUSCODE_GOOD;
+}
+
+// checks a field description of a native structure (see UA_BIND_BEGIN) against the custom data type typeId
+// and compiles the conversion of the bound fields, members without field are not converted
+// if the native structure has the memory layout of the decoded structure, values can be used without copying (see UA_Binding_cast)
+UA_StatusCode UA_Binding_init(UA_Binding* binding, const UA_NodeId* typeId, const UA_BindField* fields, size_t fieldsSize, size_t nativeSize) {
+    customTypeProperties_t* customTypeProperties;
+    const UA_DataType* type;
+    std::vector<UA_Boolean> bound(fieldsSize, false);
+    UA_BindConversion conversion;
+    size_t offset = 0;
+
+    if (!binding) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Binding_init: Parameter 1 (UA_Binding*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!typeId) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Binding_init: Parameter 2 (const UA_NodeId*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!fields && fieldsSize) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Binding_init: Parameter 3 (const UA_BindField*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    binding->type = 0x0;
+    binding->nativeSize = nativeSize;
+    binding->zeroCopy = false;
+    binding->conversions.clear();
+    customTypeProperties = findCustomTypeProperties(typeId);
+    if (!customTypeProperties) {
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Binding_init: unknown custom data type");
+        return UA_STATUSCODE_BADNOTFOUND;
+    }
+    type = &customTypeProperties->dataType;
+    if (type->typeKind != UA_DATATYPEKIND_STRUCTURE && type->typeKind != UA_DATATYPEKIND_OPTSTRUCT) {
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Binding_init: custom data type is not a structure");
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+    }
+    binding->zeroCopy = nativeSize == type->memSize && fieldsSize == type->membersSize;
+    // walk the members like UA_PrintStructure
+    for (size_t i = 0; i < type->membersSize; i++) {
+        const UA_DataTypeMember* dataTypeMember = &type->members[i];
+        const UA_DataType* memberType = dataTypeMember->memberType;
+        const UA_BindField* field = 0x0;
+        size_t memberSize;
+
+        offset += dataTypeMember->padding;
+        if (dataTypeMember->isArray)
+            memberSize = sizeof(size_t) + sizeof(void*);
+        else if (dataTypeMember->isOptional)
+            memberSize = sizeof(void*);
+        else
+            memberSize = memberType->memSize;
+        for (size_t j = 0; j < fieldsSize && !field; j++) {
+            if (fields[j].name && isMemberName(dataTypeMember, i, fields[j].name)) {
+                field = &fields[j];
+                bound[j] = true;
+            }
+        }
+        if (!field) {
+            binding->zeroCopy = false;
+            offset += memberSize;
+            continue;
+        }
+        if (dataTypeMember->isOptional) {
+            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Binding_init: optional member %s can not be bound", field->name);
+            return UA_STATUSCODE_BADNOTSUPPORTED;
+        }
+        if (field->isArray != dataTypeMember->isArray || field->size != memberSize || field->offset + field->size > nativeSize ||
+            (field->typeIndex != UA_BIND_ANYTYPE && (field->typeIndex >= UA_TYPES_COUNT || &UA_TYPES[field->typeIndex] != memberType))) {
+            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Binding_init: field %s does not match the member type %s", field->name, memberType->typeName);
+            return UA_STATUSCODE_BADTYPEMISMATCH;
+        }
+        if (field->offset != offset)
+            binding->zeroCopy = false;
+        conversion.nativeOffset = field->offset;
+        conversion.memberOffset = offset;
+        conversion.size = !dataTypeMember->isArray && memberType->pointerFree ? memberSize : 0;
+        conversion.memberType = memberType;
+        conversion.isArray = dataTypeMember->isArray;
+        // pointer free members which are adjacent in both structures are copied at once
+        if (conversion.size && !binding->conversions.empty()) {
+            UA_BindConversion* previous = &binding->conversions.back();
+            if (previous->size && previous->nativeOffset + previous->size == conversion.nativeOffset && previous->memberOffset + previous->size == conversion.memberOffset) {
+                previous->size += conversion.size;
+                offset += memberSize;
+                continue;
+            }
+        }
+        binding->conversions.push_back(conversion);
+        offset += memberSize;
+    }
+    for (size_t j = 0; j < fieldsSize; j++) {
+        if (!bound[j]) {
+            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Binding_init: member %s not found", fields[j].name ? fields[j].name : "(null)");
+            return UA_STATUSCODE_BADNOTFOUND;
+        }
+    }
+    binding->type = type;
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Binding_init: %s bound %s", type->typeName,
+                binding->zeroCopy ? "without copying" : "with conversion");
+    return UA_STATUSCODE_GOOD;
+}
+
+// copies the bound fields of the value with the given index (0 for scalars) into the native structure
+// other fields of the native structure are not changed
+UA_StatusCode UA_Binding_copyValue(const UA_Binding* binding, const UA_Variant* data, size_t index, void* value) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    const UA_Byte* src;
+    UA_Byte* dst = (UA_Byte*)value;
+
+    if (!binding || !binding->type) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Binding_copyValue: Parameter 1 (const UA_Binding*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!data) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Binding_copyValue: Parameter 2 (const UA_Variant*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!value) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Binding_copyValue: Parameter 4 (void*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (data->type != binding->type)
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+    if (data->data <= UA_EMPTY_ARRAY_SENTINEL)
+        return UA_STATUSCODE_BADNODATA;
+    if (index >= (UA_Variant_isScalar(data) ? 1 : data->arrayLength))
+        return UA_STATUSCODE_BADINDEXRANGENODATA;
+    src = (const UA_Byte*)data->data + index * binding->type->memSize;
+    // fields with heap memory are initialized first, so they can be cleared if a copy fails
+    for (const UA_BindConversion& conversion : binding->conversions) {
+        if (!conversion.size)
+            memset(dst + conversion.nativeOffset, 0x0, conversion.isArray ? sizeof(size_t) + sizeof(void*) : conversion.memberType->memSize);
+    }
+    for (const UA_BindConversion& conversion : binding->conversions) {
+        if (conversion.size)
+            memcpy(dst + conversion.nativeOffset, src + conversion.memberOffset, conversion.size);
+        else if (conversion.isArray) {
+            const size_t length = *(const size_t*)(src + conversion.memberOffset);
+            void* array = 0x0;
+            retval |= UA_Array_copy(*(void* const*)(src + conversion.memberOffset + sizeof(size_t)), length, &array, conversion.memberType);
+            if (array) {
+                *(size_t*)(dst + conversion.nativeOffset) = length;
+                *(void**)(dst + conversion.nativeOffset + sizeof(size_t)) = array;
+            }
+        }
+        else
+            retval |= UA_copy(src + conversion.memberOffset, dst + conversion.nativeOffset, conversion.memberType);
+    }
+    if (retval != UA_STATUSCODE_GOOD)
+        UA_Binding_clearValue(binding, value);
+    return retval;
+}
+
+// frees the fields with heap memory of a native structure filled by UA_Binding_copyValue / UA_Binding_get
+void UA_Binding_clearValue(const UA_Binding* binding, void* value) {
+    UA_Byte* dst = (UA_Byte*)value;
+    if (!binding || !value)
+        return;
+    for (const UA_BindConversion& conversion : binding->conversions) {
+        if (conversion.size)
+            continue;
+        if (conversion.isArray) {
+            UA_Array_delete(*(void**)(dst + conversion.nativeOffset + sizeof(size_t)), *(size_t*)(dst + conversion.nativeOffset), conversion.memberType);
+            memset(dst + conversion.nativeOffset, 0x0, sizeof(size_t) + sizeof(void*));
+        }
+        else
+            UA_clear(dst + conversion.nativeOffset, conversion.memberType);
+    }
+}
+
+// checks a value of a custom data type against the registry before it is encoded
+// enumerations have to be declared, union switch fields have to select a member and option sets may only set declared bits
+static UA_StatusCode checkEncodableValue(const UA_Byte* p, const UA_DataType* type) {
+    const customTypeProperties_t* customTypeProperties = findCustomTypeProperties(&type->typeId);
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    size_t offset = 0;
+
+    switch (type->typeKind) {
+    case UA_DATATYPEKIND_ENUM:
+        if (customTypeProperties && customTypeProperties->enumValuesSize && !findEnumValueName(customTypeProperties, *(const UA_Int32*)p)) {
+            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_EncodeValue: %d is not a value of %s", *(const UA_Int32*)p, type->typeName);
+            return UA_STATUSCODE_BADOUTOFRANGE;
+        }
+        return UA_STATUSCODE_GOOD;
+    case UA_DATATYPEKIND_UNION: {
+        const UA_UInt32 switchField = *(const UA_UInt32*)p;
+        const UA_DataTypeMember* dataTypeMember;
+        if (switchField > type->membersSize) {
+            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_EncodeValue: switch field %u of %s out of range", switchField, type->typeName);
+            return UA_STATUSCODE_BADOUTOFRANGE;
+        }
+        if (!switchField)
+            return UA_STATUSCODE_GOOD;
+        dataTypeMember = &type->members[switchField - 1];
+        p += dataTypeMember->padding;
+        if (!dataTypeMember->isArray)
+            return checkEncodableValue(p, dataTypeMember->memberType);
+        for (size_t i = 0; i < *(const size_t*)p && retval == UA_STATUSCODE_GOOD; i++)
+            retval = checkEncodableValue(*(UA_Byte* const*)(p + sizeof(size_t)) + i * dataTypeMember->memberType->memSize, dataTypeMember->memberType);
+        return retval;
+    }
+    case UA_DATATYPEKIND_STRUCTURE:
+    case UA_DATATYPEKIND_OPTSTRUCT:
+        break;
+    default:
+        return UA_STATUSCODE_GOOD;
+    }
+    if (customTypeProperties && isOptionSetLayout(type) && customTypeProperties->optionBitsSize) {
+        const UA_ByteString* value = (const UA_ByteString*)(p + type->members[0].padding);
+        const UA_ByteString* validBits = (const UA_ByteString*)(p + type->members[0].padding + sizeof(UA_ByteString) + type->members[1].padding);
+        const size_t bits = customTypeProperties->optionBitsSize;
+        if (validBits->length && validBits->length != value->length) {
+            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_EncodeValue: ValidBits and Value of %s differ in length", type->typeName);
+            return UA_STATUSCODE_BADENCODINGERROR;
+        }
+        for (size_t i = bits; i < 8 * value->length; i++) {
+            if (value->data[i / 8] & (0x01 << (i % 8))) {
+                UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_EncodeValue: bit %u of %s is not declared", (UA_UInt32)i, type->typeName);
+                return UA_STATUSCODE_BADOUTOFRANGE;
+            }
+        }
+        return UA_STATUSCODE_GOOD;
+    }
+    for (size_t i = 0; i < type->membersSize && retval == UA_STATUSCODE_GOOD; i++) {
+        const UA_DataTypeMember* dataTypeMember = &type->members[i];
+        const UA_DataType* memberType = dataTypeMember->memberType;
+        offset += dataTypeMember->padding;
+        if (dataTypeMember->isArray) {
+            const UA_Byte* array = *(UA_Byte* const*)(p + offset + sizeof(size_t));
+            for (size_t j = 0; j < *(const size_t*)(p + offset) && retval == UA_STATUSCODE_GOOD; j++)
+                retval = checkEncodableValue(array + j * memberType->memSize, memberType);
+            offset += sizeof(size_t) + sizeof(void*);
+        }
+        else if (dataTypeMember->isOptional) {
+            // the encoding mask is derived from the pointers of the optional fields
+            const UA_Byte* optional = *(UA_Byte* const*)(p + offset);
+            if (optional)
+                retval = checkEncodableValue(optional, memberType);
+            offset += sizeof(void*);
+        }
+        else {
+            retval = checkEncodableValue(p + offset, memberType);
+            offset += memberType->memSize;
+        }
+    }
+    return retval;
+}
+
+// encodes a value of a custom data type (structure, structure with optional fields, union, enumeration, option set)
+// into an ExtensionObject with binary body, e.g. to write it with UA_WriteValues
+// enumerations have no binary encoding, their ExtensionObject holds the decoded Int32 which UA_WriteValues writes as Int32
+UA_StatusCode UA_EncodeValue(const void* p, const UA_DataType* type, UA_ExtensionObject* extensionObject) {
+    UA_StatusCode retval;
+
+    if (!p) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_EncodeValue: Parameter 1 (const void*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!type) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_EncodeValue: Parameter 2 (const UA_DataType*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!extensionObject) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_EncodeValue: Parameter 3 (UA_ExtensionObject*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    UA_ExtensionObject_init(extensionObject);
+    if (type->typeKind == UA_DATATYPEKIND_ENUM) {
+        UA_Int32* value;
+        retval = checkEncodableValue((const UA_Byte*)p, type);
+        if (retval != UA_STATUSCODE_GOOD)
+            return retval;
+        value = (UA_Int32*)UA_new(&UA_TYPES[UA_TYPES_INT32]);
+        if (!value)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        *value = *(const UA_Int32*)p;
+        extensionObject->encoding = UA_EXTENSIONOBJECT_DECODED;
+        extensionObject->content.decoded.type = &UA_TYPES[UA_TYPES_INT32];
+        extensionObject->content.decoded.data = value;
+        return UA_STATUSCODE_GOOD;
+    }
+    if (UA_NodeId_isNull(&type->binaryEncodingId)) {
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_EncodeValue: %s has no binary encoding", type->typeName);
+        return UA_STATUSCODE_BADENCODINGERROR;
+    }
+    retval = checkEncodableValue((const UA_Byte*)p, type);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+    retval = UA_encodeBinary(p, type, &extensionObject->content.encoded.body);
+    if (retval == UA_STATUSCODE_GOOD)
+        retval = UA_NodeId_copy(&type->binaryEncodingId, &extensionObject->content.encoded.typeId);
+    if (retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_EncodeValue: Could not encode %s (%s)", type->typeName, UA_StatusCode_name(retval));
+        UA_ExtensionObject_clear(extensionObject);
+        return retval;
+    }
+    extensionObject->encoding = UA_EXTENSIONOBJECT_ENCODED_BYTESTRING;
+    return UA_STATUSCODE_GOOD;
+}
+
+// resizes a byte string of an option set, new bytes are set to fill
+static UA_StatusCode resizeOptionSetBytes(UA_ByteString* bytes, size_t length, UA_Byte fill) {
+    UA_ByteString resized;
+    UA_StatusCode retval;
+    if (bytes->length >= length)
+        return UA_STATUSCODE_GOOD;
+    retval = UA_ByteString_allocBuffer(&resized, length);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+    if (bytes->length)
+        memcpy(resized.data, bytes->data, bytes->length);
+    memset(resized.data + bytes->length, fill, length - bytes->length);
+    UA_ByteString_clear(bytes);
+    *bytes = resized;
+    return UA_STATUSCODE_GOOD;
+}
+
+// sets or clears the bit of an option set field by name and marks it as valid (ValidBits)
+// Value and ValidBits are extended to all declared bits, missing valid bits stay valid (see UA_PrintJson)
+UA_StatusCode UA_OptionSet_setBit(void* p, const UA_DataType* type, const char* name, UA_Boolean isSet) {
+    customTypeProperties_t* customTypeProperties;
+    UA_ByteString* value;
+    UA_ByteString* validBits;
+    size_t bit = 0;
+    size_t bytes;
+    UA_Byte mask;
+    UA_StatusCode retval;
+
+    if (!p) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_OptionSet_setBit: Parameter 1 (void*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!type) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_OptionSet_setBit: Parameter 2 (const UA_DataType*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!name) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_OptionSet_setBit: Parameter 3 (const char*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    customTypeProperties = findCustomTypeProperties(&type->typeId);
+    if (!customTypeProperties || !isOptionSetLayout(type) || !customTypeProperties->optionBitsSize) {
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_OptionSet_setBit: %s is not an option set", type->typeName);
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+    }
+    for (; bit < customTypeProperties->optionBitsSize; bit++) {
+        const UA_String* fieldName = getOptionBitName(customTypeProperties, bit);
+        if (fieldName->length == strlen(name) && !strncmp((const char*)fieldName->data, name, fieldName->length))
+            break;
+    }
+    if (bit == customTypeProperties->optionBitsSize) {
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_OptionSet_setBit: %s is not a field of %s", name, type->typeName);
+        return UA_STATUSCODE_BADNOTFOUND;
+    }
+    value = (UA_ByteString*)((UA_Byte*)p + type->members[0].padding);
+    validBits = (UA_ByteString*)((UA_Byte*)p + type->members[0].padding + sizeof(UA_ByteString) + type->members[1].padding);
+    bytes = (customTypeProperties->optionBitsSize + 7) / 8;
+    retval = resizeOptionSetBytes(validBits, bytes, validBits->length ? 0x0 : 0xFF);
+    retval |= resizeOptionSetBytes(value, bytes, 0x0);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+    mask = (UA_Byte)(0x01 << (bit % 8));
+    if (isSet)
+        value->data[bit / 8] |= mask;
+    else
+        value->data[bit / 8] &= (UA_Byte)~mask;
+    validBits->data[bit / 8] |= mask;
+    // undeclared bits of the last byte are never valid
+    if (customTypeProperties->optionBitsSize % 8)
+        validBits->data[bytes - 1] &= (UA_Byte)((0x01 << (customTypeProperties->optionBitsSize % 8)) - 1);
+    return UA_STATUSCODE_GOOD;
+}
+
+// stores value in little endian byte order (binary encoding)
+static void writeLittleEndian(UA_Byte* data, UA_UInt64 value, size_t length) {
+    for (size_t i = 0; i < length; i++)
+        data[i] = (UA_Byte)(value >> (8 * i));
+}
+
+// binary encoding of a value with fixed encoded size (see encodedFixedSize)
+static void encodeFixedValue(UA_Byte* data, const UA_Byte* p, const UA_DataType* type) {
+    switch (type->typeKind) {
+    case UA_DATATYPEKIND_BOOLEAN:
+        data[0] = *(const UA_Boolean*)p ? 1 : 0;
+        return;
+    case UA_DATATYPEKIND_GUID: {
+        const UA_Guid* guid = (const UA_Guid*)p;
+        writeLittleEndian(data, guid->data1, 4);
+        writeLittleEndian(data + 4, guid->data2, 2);
+        writeLittleEndian(data + 6, guid->data3, 2);
+        memcpy(data + 8, guid->data4, 8);
+        return;
+    }
+    case UA_DATATYPEKIND_STRUCTURE:
+        for (size_t i = 0; i < type->membersSize; i++) {
+            p += type->members[i].padding;
+            encodeFixedValue(data, p, type->members[i].memberType);
+            data += encodedFixedSize(type->members[i].memberType);
+            p += type->members[i].memberType->memSize;
+        }
+        return;
+    default:
+        break;
+    }
+    // integers, floating point numbers, status codes, enumerations and date times
+    switch (encodedFixedSize(type)) {
+    case 1:
+        data[0] = *p;
+        break;
+    case 2: {
+        UA_UInt16 value;
+        memcpy(&value, p, 2);
+        writeLittleEndian(data, value, 2);
+        break;
+    }
+    case 4: {
+        UA_UInt32 value;
+        memcpy(&value, p, 4);
+        writeLittleEndian(data, value, 4);
+        break;
+    }
+    case 8: {
+        UA_UInt64 value;
+        memcpy(&value, p, 8);
+        writeLittleEndian(data, value, 8);
+        break;
+    }
+    }
+}
+
+// encodes p as template for repeated writes of the custom data type type
+UA_StatusCode UA_WriteTemplate_init(UA_WriteTemplate* writeTemplate, const void* p, const UA_DataType* type) {
+    if (!writeTemplate) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_WriteTemplate_init: Parameter 1 (UA_WriteTemplate*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    writeTemplate->type = type;
+    writeTemplate->fields.clear();
+    return UA_EncodeValue(p, type, &writeTemplate->encoded);
+}
+
+// registers a fixed size field of the template (member path, see UA_EncodedFieldPath_compile)
+// fieldIndex receives the index for UA_WriteTemplate_setField
+// fields of variable size (strings, arrays) and optional fields which are not set can not be patched
+UA_StatusCode UA_WriteTemplate_addField(UA_WriteTemplate* writeTemplate, const char* path, size_t* fieldIndex) {
+    UA_EncodedFieldPath encodedFieldPath;
+    UA_TemplateField templateField;
+    const UA_Byte* field;
+    UA_StatusCode retval;
+
+    if (!writeTemplate || !writeTemplate->type) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_WriteTemplate_addField: Parameter 1 (UA_WriteTemplate*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!fieldIndex) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_WriteTemplate_addField: Parameter 3 (size_t*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    retval = UA_EncodedFieldPath_compile(writeTemplate->type, path, &encodedFieldPath);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+    if (!encodedFixedSize(encodedFieldPath.type)) {
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_WriteTemplate_addField: \"%s\" has no fixed size", path);
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+    }
+    if (writeTemplate->encoded.encoding == UA_EXTENSIONOBJECT_DECODED) {
+        // enumeration (decoded Int32, see UA_EncodeValue), the only field is the value itself (empty path)
+        templateField.position = 0;
+    }
+    else {
+        retval = UA_EncodedFieldPath_get(&encodedFieldPath, &writeTemplate->encoded, &field);
+        if (retval != UA_STATUSCODE_GOOD)
+            return retval;
+        templateField.position = (size_t)(field - writeTemplate->encoded.content.encoded.body.data);
+    }
+    templateField.type = encodedFieldPath.type;
+    *fieldIndex = writeTemplate->fields.size();
+    writeTemplate->fields.push_back(templateField);
+    return UA_STATUSCODE_GOOD;
+}
+
+// patches the value of a field (memory layout of its type) into the encoded body of the template
+UA_StatusCode UA_WriteTemplate_setField(UA_WriteTemplate* writeTemplate, size_t fieldIndex, const void* value) {
+    if (!writeTemplate) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_WriteTemplate_setField: Parameter 1 (UA_WriteTemplate*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (fieldIndex >= writeTemplate->fields.size()) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_WriteTemplate_setField: Parameter 2 (size_t) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!value) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_WriteTemplate_setField: Parameter 3 (const void*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    const UA_TemplateField* templateField = &writeTemplate->fields[fieldIndex];
+    if (writeTemplate->encoded.encoding == UA_EXTENSIONOBJECT_DECODED) {
+        // enumeration values are checked against the registry like in UA_EncodeValue
+        UA_StatusCode retval = checkEncodableValue((const UA_Byte*)value, templateField->type);
+        if (retval != UA_STATUSCODE_GOOD)
+            return retval;
+        *(UA_Int32*)writeTemplate->encoded.content.decoded.data = *(const UA_Int32*)value;
+        return UA_STATUSCODE_GOOD;
+    }
+    encodeFixedValue(writeTemplate->encoded.content.encoded.body.data + templateField->position, (const UA_Byte*)value, templateField->type);
+    return UA_STATUSCODE_GOOD;
+}
+
+// copies the current encoded body of the template, e.g. one ExtensionObject per struct of a recipe
+UA_StatusCode UA_WriteTemplate_instantiate(const UA_WriteTemplate* writeTemplate, UA_ExtensionObject* extensionObject) {
+    if (!writeTemplate || !writeTemplate->type) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_WriteTemplate_instantiate: Parameter 1 (const UA_WriteTemplate*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!extensionObject) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_WriteTemplate_instantiate: Parameter 2 (UA_ExtensionObject*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    return UA_ExtensionObject_copy(&writeTemplate->encoded, extensionObject);
+}
+
+void UA_WriteTemplate_clear(UA_WriteTemplate* writeTemplate) {
+    if (!writeTemplate)
+        return;
+    UA_ExtensionObject_clear(&writeTemplate->encoded);
+    writeTemplate->fields.clear();
+    writeTemplate->type = 0x0;
+}
+
+// subfunction of UA_WriteValues, variant receives a shallow copy of value, enumerations are written as Int32:
+// values of custom enumeration types are checked against the registry and ExtensionObjects with a decoded Int32 (UA_EncodeValue) are unwrapped
+static UA_StatusCode prepareWriteValue(const UA_Variant* value, UA_Variant* variant) {
+    *variant = *value;
+    if (!value->type)
+        return UA_STATUSCODE_GOOD;
+    if (value->type == &UA_TYPES[UA_TYPES_EXTENSIONOBJECT] && UA_Variant_isScalar(value)) {
+        const UA_ExtensionObject* extensionObject = (const UA_ExtensionObject*)value->data;
+        if (extensionObject->encoding >= UA_EXTENSIONOBJECT_DECODED && extensionObject->content.decoded.type == &UA_TYPES[UA_TYPES_INT32])
+            UA_Variant_setScalar(variant, extensionObject->content.decoded.data, &UA_TYPES[UA_TYPES_INT32]);
+        return UA_STATUSCODE_GOOD;
+    }
+    if (value->type->typeKind == UA_DATATYPEKIND_ENUM && findCustomTypeProperties(&value->type->typeId)) {
+        const size_t length = UA_Variant_isScalar(value) ? 1 : value->arrayLength;
+        for (size_t i = 0; i < length; i++) {
+            UA_StatusCode retval = checkEncodableValue((const UA_Byte*)value->data + i * sizeof(UA_Int32), value->type);
+            if (retval != UA_STATUSCODE_GOOD)
+                return retval;
+        }
+        variant->type = &UA_TYPES[UA_TYPES_INT32];
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+// writes the value attributes of many nodes with as few WriteRequests as possible
+// the requests are chunked according to the operation limit MaxNodesPerWrite of the server
+// custom data types are encoded by the client (customDataTypes) or passed as ExtensionObject (UA_EncodeValue, UA_WriteTemplate)
+// enumerations are written as Int32, values which are not declared in the registry are not written and get BADOUTOFRANGE
+// results receives one status code per node (optional), nodes of a failed request get the status code of the request
+UA_StatusCode UA_WriteValues(UA_Client* client, const UA_NodeId* nodeIds, const UA_Variant* values, size_t nodeIdsSize, UA_StatusCode* results) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    UA_WriteRequest request;
+    UA_WriteResponse response;
+    size_t chunkSize;
+
+    if (!client) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_WriteValues: Client session invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!nodeIds && nodeIdsSize) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_WriteValues: Parameter 2 (const UA_NodeId*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!values && nodeIdsSize) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_WriteValues: Parameter 3 (const UA_Variant*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!nodeIdsSize)
+        return UA_STATUSCODE_GOOD;
+    chunkSize = readOperationLimit(client, UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERWRITE);
+    if (!chunkSize || chunkSize > UA_WRITEVALUES_MAXCHUNKSIZE)
+        chunkSize = UA_WRITEVALUES_MAXCHUNKSIZE;
+    std::vector<UA_WriteValue> writeValues(std::min(chunkSize, nodeIdsSize));
+    std::vector<size_t> writeIndexes(writeValues.size());
+    for (size_t start = 0; start < nodeIdsSize; start += chunkSize) {
+        const size_t count = std::min(chunkSize, nodeIdsSize - start);
+        size_t writeCount = 0;
+        for (size_t i = 0; i < count; i++) {
+            // shallow copies of node IDs and values, the request is not cleared
+            UA_WriteValue* writeValue = &writeValues[writeCount];
+            UA_WriteValue_init(writeValue);
+            UA_StatusCode status = prepareWriteValue(&values[start + i], &writeValue->value.value);
+            if (status != UA_STATUSCODE_GOOD) {
+                if (results)
+                    results[start + i] = status;
+                continue;
+            }
+            writeValue->nodeId = nodeIds[start + i];
+            writeValue->attributeId = UA_ATTRIBUTEID_VALUE;
+            writeValue->value.hasValue = true;
+            writeIndexes[writeCount++] = start + i;
+        }
+        if (!writeCount)
+            continue;
+        UA_WriteRequest_init(&request);
+        request.nodesToWrite = writeValues.data();
+        request.nodesToWriteSize = writeCount;
+        response = UA_Client_Service_write(client, request);
+        retval = response.responseHeader.serviceResult;
+        if (retval == UA_STATUSCODE_GOOD && response.resultsSize != writeCount)
+            retval = UA_STATUSCODE_BADUNEXPECTEDERROR;
+        if (results) {
+            for (size_t i = 0; i < writeCount; i++)
+                results[writeIndexes[i]] = retval == UA_STATUSCODE_GOOD ? response.results[i] : retval;
+        }
+        UA_WriteResponse_clear(&response);
+        if (retval != UA_STATUSCODE_GOOD) {
+            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_WriteValues: Could not write values (%s)", UA_StatusCode_name(retval));
+            for (size_t i = start + count; results && i < nodeIdsSize; i++)
+                results[i] = retval;
+            break;
+        }
+    }
+    return retval;
+}
+
+// the recorder of UA_ReadValues and UA_Monitor_iterate (see UA_Recorder_open)
+// the mutex protects the pointer and all writes to the files of recorders
+static UA_Recorder* activeRecorder = 0x0;
+static std::mutex activeRecorderMutex;
+
+// appends the UA binary encoding of a value to buffer
+static UA_StatusCode appendEncoded(std::vector<UA_Byte>* buffer, const void* p, const UA_DataType* type) {
+    UA_ByteString encoded;
+    UA_ByteString_init(&encoded);
+    UA_StatusCode retval = UA_encodeBinary(p, type, &encoded);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+    buffer->insert(buffer->end(), encoded.data, encoded.data + encoded.length);
+    UA_ByteString_clear(&encoded);
+    return UA_STATUSCODE_GOOD;
+}
+
+// appends an array as UA binary encoded variant, the array is not copied
+static UA_StatusCode appendEncodedArray(std::vector<UA_Byte>* buffer, const void* array, size_t arraySize, const UA_DataType* type) {
+    UA_Variant variant;
+    UA_Variant_init(&variant);
+    UA_Variant_setArray(&variant, arraySize ? (void*)array : UA_EMPTY_ARRAY_SENTINEL, arraySize, type);
+    return appendEncoded(buffer, &variant, &UA_TYPES[UA_TYPES_VARIANT]);
+}
+
+// decodes an array encoded by appendEncodedArray, the caller is responsible to clear the variant
+static UA_StatusCode decodeArray(const UA_ByteString* payload, size_t* position, UA_Variant* variant, const UA_DataType* type) {
+    UA_StatusCode retval = UA_decodeBinary(payload, position, variant, &UA_TYPES[UA_TYPES_VARIANT], 0x0);
+    if (retval == UA_STATUSCODE_GOOD && variant->type && (variant->type != type || UA_Variant_isScalar(variant)))
+        retval = UA_STATUSCODE_BADDECODINGERROR;
+    return retval;
+}
+
+// appends a record to the file of the recorder, activeRecorderMutex has to be locked
+static UA_StatusCode writeRecord(UA_Recorder* recorder, UA_RecordKind kind, const std::vector<UA_Byte>& payload) {
+    UA_Byte header[16];
+    if (!recorder->file)
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    if (payload.size() > UA_UINT32_MAX)
+        return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
+    writeLittleEndian(header, (UA_UInt64)kind, 4);
+    writeLittleEndian(&header[4], (UA_UInt64)payload.size(), 4);
+    writeLittleEndian(&header[8], (UA_UInt64)UA_DateTime_now(), 8);
+    if (fwrite(header, 1, sizeof(header), recorder->file) != sizeof(header) ||
+        fwrite(payload.data(), 1, payload.size(), recorder->file) != payload.size())
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    recorder->records++;
+    recorder->bytes += sizeof(header) + payload.size();
+    return UA_STATUSCODE_GOOD;
+}
+
+// checks whether the responses are recorded (the payload is only encoded while recording)
+static UA_Boolean isRecording(void) {
+    std::lock_guard<std::mutex> lock(activeRecorderMutex);
+    return activeRecorder != 0x0;
+}
+
+// appends a record to the file of the active recorder
+static UA_StatusCode recordPayload(UA_RecordKind kind, const std::vector<UA_Byte>& payload) {
+    std::lock_guard<std::mutex> lock(activeRecorderMutex);
+    // the recorder may have been closed while the payload was encoded
+    if (!activeRecorder)
+        return UA_STATUSCODE_GOOD;
+    return writeRecord(activeRecorder, kind, payload);
+}
+
+// records the ReadResponse of readValuesChunked (value and data type attribute of each node)
+// the client passes decoded responses only, they are encoded again (same body as received)
+static void recordReadResponse(const UA_NodeId* nodeIds, size_t nodeIdsSize, const UA_ReadResponse* response) {
+    std::vector<UA_Byte> payload;
+    UA_StatusCode retval;
+    if (!isRecording())
+        return;
+    retval = appendEncodedArray(&payload, nodeIds, nodeIdsSize, &UA_TYPES[UA_TYPES_NODEID]);
+    retval |= appendEncodedArray(&payload, 0x0, 0, &UA_TYPES[UA_TYPES_NODEID]); // the data type IDs are part of the response
+    retval |= appendEncoded(&payload, response, &UA_TYPES[UA_TYPES_READRESPONSE]);
+    if (retval == UA_STATUSCODE_GOOD)
+        retval = recordPayload(UA_RECORDKIND_READRESPONSE, payload);
+    if (retval != UA_STATUSCODE_GOOD)
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "recordReadResponse: Could not record the ReadResponse (%s)", UA_StatusCode_name(retval));
+}
+
+// records the values of one UA_Monitor_iterate call as PublishResponse with one DataChangeNotification
+// the client does not pass the PublishResponses, so the response is built of the received values (client handle = index of the node ID)
+static void recordMonitoredValues(const UA_Monitor* monitor) {
+    const size_t valuesSize = monitor->values.size();
+    std::vector<UA_NodeId> nodeIds(valuesSize);
+    std::vector<UA_NodeId> dataTypeIds(valuesSize);
+    std::vector<UA_MonitoredItemNotification> notifications(valuesSize);
+    std::vector<UA_Byte> payload;
+    UA_DataChangeNotification dataChange;
+    UA_ExtensionObject notificationData;
+    UA_PublishResponse response;
+    UA_StatusCode retval;
+
+    if (!isRecording())
+        return;
+    // shallow copies, nothing is cleared
+    for (size_t i = 0; i < valuesSize; i++) {
+        const UA_MonitoredValue* monitoredValue = &monitor->values[i];
+        nodeIds[i] = *monitoredValue->nodeId;
+        dataTypeIds[i] = monitoredValue->dataTypeId ? *monitoredValue->dataTypeId : UA_NODEID_NULL;
+        UA_MonitoredItemNotification_init(&notifications[i]);
+        notifications[i].clientHandle = (UA_UInt32)i;
+        notifications[i].value = monitoredValue->value;
+    }
+    UA_DataChangeNotification_init(&dataChange);
+    dataChange.monitoredItems = notifications.data();
+    dataChange.monitoredItemsSize = valuesSize;
+    UA_ExtensionObject_init(&notificationData);
+    notificationData.encoding = UA_EXTENSIONOBJECT_DECODED_NODELETE;
+    notificationData.content.decoded.type = &UA_TYPES[UA_TYPES_DATACHANGENOTIFICATION];
+    notificationData.content.decoded.data = &dataChange;
+    UA_PublishResponse_init(&response);
+    response.responseHeader.timestamp = UA_DateTime_now();
+    response.subscriptionId = monitor->subscriptionId;
+    response.notificationMessage.publishTime = response.responseHeader.timestamp;
+    response.notificationMessage.notificationData = &notificationData;
+    response.notificationMessage.notificationDataSize = 1;
+
+    retval = appendEncodedArray(&payload, nodeIds.data(), valuesSize, &UA_TYPES[UA_TYPES_NODEID]);
+    retval |= appendEncodedArray(&payload, dataTypeIds.data(), valuesSize, &UA_TYPES[UA_TYPES_NODEID]);
+    retval |= appendEncoded(&payload, &response, &UA_TYPES[UA_TYPES_PUBLISHRESPONSE]);
+    if (retval == UA_STATUSCODE_GOOD)
+        retval = recordPayload(UA_RECORDKIND_PUBLISHRESPONSE, payload);
+    if (retval != UA_STATUSCODE_GOOD)
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "recordMonitoredValues: Could not record the PublishResponse (%s)", UA_StatusCode_name(retval));
+}
+
+// serializes the custom data type registry (dataTypeMap with the names of dataTypeNameMap)
+// member types are stored as type IDs and resolved when the registry is loaded (see deserializeRegistry)
+static UA_StatusCode serializeRegistry(std::vector<UA_Byte>* payload) {
+    std::map<const customTypeProperties_t*, const std::string*> names;
+    UA_UInt32 typesSize = (UA_UInt32)dataTypeMap.size();
+    UA_StatusCode retval;
+
+    for (nameTypePropIt_t nameTypePropIt = dataTypeNameMap.begin(); nameTypePropIt != dataTypeNameMap.end(); nameTypePropIt++)
+        names[nameTypePropIt->second] = &nameTypePropIt->first;
+    retval = appendEncoded(payload, &typesSize, &UA_TYPES[UA_TYPES_UINT32]);
+    for (typePropIt_t typePropIt = dataTypeMap.begin(); typePropIt != dataTypeMap.end() && retval == UA_STATUSCODE_GOOD; typePropIt++) {
+        const customTypeProperties_t* customTypeProperties = &typePropIt->second;
+        const UA_DataType* dataType = &customTypeProperties->dataType;
+        std::map<const customTypeProperties_t*, const std::string*>::iterator nameIt = names.find(customTypeProperties);
+        UA_String name = UA_STRING_NULL;
+        UA_UInt16 memSize = dataType->memSize;
+        UA_Byte typeKind = (UA_Byte)dataType->typeKind;
+        UA_Byte flags = (UA_Byte)(dataType->pointerFree | (dataType->overlayable << 1));
+        UA_Byte membersSize = (UA_Byte)dataType->membersSize;
+
+        if (nameIt != names.end()) {
+            name.length = nameIt->second->length();
+            name.data = (UA_Byte*)nameIt->second->data();
+        }
+        retval |= appendEncoded(payload, &name, &UA_TYPES[UA_TYPES_STRING]);
+        retval |= appendEncoded(payload, &dataType->typeId, &UA_TYPES[UA_TYPES_NODEID]);
+        retval |= appendEncoded(payload, &dataType->binaryEncodingId, &UA_TYPES[UA_TYPES_NODEID]);
+        retval |= appendEncoded(payload, &customTypeProperties->subTypeOfId, &UA_TYPES[UA_TYPES_NODEID]);
+        retval |= appendEncoded(payload, &memSize, &UA_TYPES[UA_TYPES_UINT16]);
+        retval |= appendEncoded(payload, &typeKind, &UA_TYPES[UA_TYPES_BYTE]);
+        retval |= appendEncoded(payload, &flags, &UA_TYPES[UA_TYPES_BYTE]);
+        retval |= appendEncoded(payload, &membersSize, &UA_TYPES[UA_TYPES_BYTE]);
+        for (UA_Byte i = 0; dataType->members && i < membersSize; i++) {
+            const UA_DataTypeMember* dataTypeMember = &dataType->members[i];
+            UA_String memberName = UA_STRING_NULL;
+            UA_Byte padding = dataTypeMember->padding;
+            UA_Byte memberFlags = (UA_Byte)(dataTypeMember->isArray | (dataTypeMember->isOptional << 1));
+#ifdef UA_ENABLE_TYPEDESCRIPTION
+            if (dataTypeMember->memberName)
+                memberName = UA_STRING((char*)dataTypeMember->memberName);
+#endif
+            retval |= appendEncoded(payload, &memberName, &UA_TYPES[UA_TYPES_STRING]);
+            retval |= appendEncoded(payload, dataTypeMember->memberType ? &dataTypeMember->memberType->typeId : &UA_NODEID_NULL, &UA_TYPES[UA_TYPES_NODEID]);
+            retval |= appendEncoded(payload, &padding, &UA_TYPES[UA_TYPES_BYTE]);
+            retval |= appendEncoded(payload, &memberFlags, &UA_TYPES[UA_TYPES_BYTE]);
+        }
+        // the tables are written as EnumValueType and StructureDefinition arrays (shallow, the names stay in the registry)
+        std::vector<UA_EnumValueType> enumValueSet(customTypeProperties->enumValuesSize);
+        std::vector<UA_StructureField> optionBits(customTypeProperties->optionBitsSize);
+        UA_StructureDefinition structureDefinition;
+        for (UA_UInt32 j = 0; j < customTypeProperties->enumValuesSize; j++) {
+            UA_EnumValueType_init(&enumValueSet[j]);
+            enumValueSet[j].value = getEnumValue(customTypeProperties, j);
+            enumValueSet[j].displayName.text = *getEnumValueName(customTypeProperties, j);
+        }
+        UA_StructureDefinition_init(&structureDefinition);
+        structureDefinition.structureType = UA_STRUCTURETYPE_STRUCTURE;
+        structureDefinition.baseDataType = NS0ID_OPTIONSET;
+        structureDefinition.fieldsSize = optionBits.size();
+        structureDefinition.fields = optionBits.data();
+        for (UA_UInt32 j = 0; j < customTypeProperties->optionBitsSize; j++) {
+            UA_StructureField_init(&optionBits[j]);
+            optionBits[j].name = *getOptionBitName(customTypeProperties, j);
+            optionBits[j].valueRank = (UA_Int32)j;
+            optionBits[j].dataType = UA_TYPES[UA_TYPES_LOCALIZEDTEXT].typeId;
+        }
+        retval |= appendEncodedArray(payload, enumValueSet.data(), enumValueSet.size(), &UA_TYPES[UA_TYPES_ENUMVALUETYPE]);
+        retval |= appendEncodedArray(payload, &structureDefinition, optionBits.empty() ? 0 : 1, &UA_TYPES[UA_TYPES_STRUCTUREDEFINITION]);
+    }
+    return retval;
+}
+
+// subfunction of deserializeRegistry, decodes one custom data type
+// the type IDs of the members are returned in memberTypeIds (resolved after all types are decoded)
+static UA_StatusCode deserializeCustomType(const UA_ByteString* payload, size_t* position, customTypeProperties_t* customTypeProperties, UA_String* name,
+                                           std::vector<UA_NodeId>* memberTypeIds) {
+    UA_DataType* dataType = &customTypeProperties->dataType;
+    UA_UInt16 memSize = 0;
+    UA_Byte typeKind = 0, flags = 0, membersSize = 0;
+    UA_Variant enumValueSet, structureDefinition;
+    UA_StatusCode retval;
+
+    retval = UA_decodeBinary(payload, position, name, &UA_TYPES[UA_TYPES_STRING], 0x0);
+    retval |= UA_decodeBinary(payload, position, &dataType->typeId, &UA_TYPES[UA_TYPES_NODEID], 0x0);
+    retval |= UA_decodeBinary(payload, position, &dataType->binaryEncodingId, &UA_TYPES[UA_TYPES_NODEID], 0x0);
+    retval |= UA_decodeBinary(payload, position, &customTypeProperties->subTypeOfId, &UA_TYPES[UA_TYPES_NODEID], 0x0);
+    retval |= UA_decodeBinary(payload, position, &memSize, &UA_TYPES[UA_TYPES_UINT16], 0x0);
+    retval |= UA_decodeBinary(payload, position, &typeKind, &UA_TYPES[UA_TYPES_BYTE], 0x0);
+    retval |= UA_decodeBinary(payload, position, &flags, &UA_TYPES[UA_TYPES_BYTE], 0x0);
+    retval |= UA_decodeBinary(payload, position, &membersSize, &UA_TYPES[UA_TYPES_BYTE], 0x0);
+    if (retval != UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    dataType->memSize = memSize;
+    dataType->typeKind = typeKind;
+    dataType->pointerFree = flags & 0x1;
+    dataType->overlayable = (flags >> 1) & 0x1;
+#ifdef UA_ENABLE_TYPEDESCRIPTION
+    dataType->typeName = (const char*)registryString(internRegistryString((const char*)name->data, name->length))->data;
+#endif
+    if (membersSize) {
+        dataType->members = (UA_DataTypeMember*)UA_calloc(membersSize, sizeof(UA_DataTypeMember));
+        if (!dataType->members)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        dataType->membersSize = membersSize;
+    }
+    memberTypeIds->resize(membersSize);
+    for (UA_Byte i = 0; i < membersSize && retval == UA_STATUSCODE_GOOD; i++) {
+        UA_DataTypeMember* dataTypeMember = &dataType->members[i];
+        UA_String memberName;
+        UA_Byte padding = 0, memberFlags = 0;
+        UA_String_init(&memberName);
+        retval = UA_decodeBinary(payload, position, &memberName, &UA_TYPES[UA_TYPES_STRING], 0x0);
+        retval |= UA_decodeBinary(payload, position, &(*memberTypeIds)[i], &UA_TYPES[UA_TYPES_NODEID], 0x0);
+        retval |= UA_decodeBinary(payload, position, &padding, &UA_TYPES[UA_TYPES_BYTE], 0x0);
+        retval |= UA_decodeBinary(payload, position, &memberFlags, &UA_TYPES[UA_TYPES_BYTE], 0x0);
+        dataTypeMember->padding = padding;
+        dataTypeMember->isArray = memberFlags & 0x1;
+        dataTypeMember->isOptional = (memberFlags >> 1) & 0x1;
+#ifdef UA_ENABLE_TYPEDESCRIPTION
+        if (memberName.length)
+            dataTypeMember->memberName = (const char*)registryString(internRegistryString((const char*)memberName.data, memberName.length))->data;
+#endif
+        UA_String_clear(&memberName);
+    }
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+    UA_Variant_init(&enumValueSet);
+    UA_Variant_init(&structureDefinition);
+    retval = decodeArray(payload, position, &enumValueSet, &UA_TYPES[UA_TYPES_ENUMVALUETYPE]);
+    retval |= decodeArray(payload, position, &structureDefinition, &UA_TYPES[UA_TYPES_STRUCTUREDEFINITION]);
+    if (retval == UA_STATUSCODE_GOOD && enumValueSet.arrayLength) {
+        std::vector<UA_Int64> values;
+        std::vector<UA_UInt32> names;
+        for (size_t i = 0; i < enumValueSet.arrayLength; i++) {
+            const UA_EnumValueType* enumValue = &((const UA_EnumValueType*)enumValueSet.data)[i];
+            values.push_back(enumValue->value);
+            names.push_back(internRegistryString((const char*)enumValue->displayName.text.data, enumValue->displayName.text.length));
+        }
+        setEnumValues(customTypeProperties, values, names);
+    }
+    if (retval == UA_STATUSCODE_GOOD && structureDefinition.arrayLength) {
+        std::vector<UA_UInt32> names;
+        for (size_t i = 0; i < structureDefinition.arrayLength; i++) {
+            const UA_StructureDefinition* definition = &((const UA_StructureDefinition*)structureDefinition.data)[i];
+            for (size_t j = 0; j < definition->fieldsSize; j++)
+                names.push_back(internRegistryString((const char*)definition->fields[j].name.data, definition->fields[j].name.length));
+        }
+        setOptionBits(customTypeProperties, names);
+    }
+    UA_Variant_clear(&enumValueSet);
+    UA_Variant_clear(&structureDefinition);
+    return retval;
+}
+
+// replaces the custom data type registry with a registry serialized by serializeRegistry
+static UA_StatusCode deserializeRegistry(const UA_ByteString* payload) {
+    std::vector<std::pair<UA_DataTypeMember*, UA_NodeId>> unresolvedMembers;
+    std::vector<UA_NodeId> memberTypeIds;
+    UA_UInt32 typesSize = 0;
+    size_t position = 0;
+    UA_StatusCode retval;
+
+    clearCustomDataTypes();
+    retval = UA_decodeBinary(payload, &position, &typesSize, &UA_TYPES[UA_TYPES_UINT32], 0x0);
+    for (UA_UInt32 i = 0; i < typesSize && retval == UA_STATUSCODE_GOOD; i++) {
+        customTypeProperties_t customTypeProperties;
+        UA_String name;
+        UA_UInt32 typeIdHash;
+
+        customTypePropertiesInit(&customTypeProperties, &UA_NODEID_NULL);
+        UA_String_init(&name);
+        retval = deserializeCustomType(payload, &position, &customTypeProperties, &name, &memberTypeIds);
+        typeIdHash = UA_NodeId_SDBMHash(&customTypeProperties.dataType.typeId);
+        if (retval != UA_STATUSCODE_GOOD || dataTypeMap.find(typeIdHash) != dataTypeMap.end()) {
+            // duplicates were already skipped by scan4BaseDataTypes
+            customTypePropertiesClear(&customTypeProperties);
+            for (UA_NodeId& memberTypeId : memberTypeIds)
+                UA_NodeId_clear(&memberTypeId);
+        }
+        else {
+            customTypeProperties_t* inserted = &dataTypeMap.insert(std::pair<UA_UInt32, customTypeProperties_t>(typeIdHash, customTypeProperties)).first->second;
+            if (name.length)
+                dataTypeNameMap.insert(std::pair<std::string, customTypeProperties_t*>(std::string((const char*)name.data, name.length), inserted));
+            for (size_t j = 0; j < memberTypeIds.size(); j++)
+                unresolvedMembers.push_back(std::make_pair(&inserted->dataType.members[j], memberTypeIds[j]));
+        }
+        memberTypeIds.clear();
+        UA_String_clear(&name);
+    }
+    // the member types point to UA_TYPES or to other custom data types
+    for (std::pair<UA_DataTypeMember*, UA_NodeId>& unresolvedMember : unresolvedMembers) {
+        const UA_DataType* memberType = UA_findDataType(&unresolvedMember.second);
+        const customTypeProperties_t* customTypeProperties = findCustomTypeProperties(&unresolvedMember.second);
+        if (!memberType && customTypeProperties && UA_NodeId_equal(&customTypeProperties->dataType.typeId, &unresolvedMember.second))
+            memberType = &customTypeProperties->dataType;
+        // members of unknown type were recorded without type ID
+        if (!memberType && !UA_NodeId_isNull(&unresolvedMember.second))
+            retval = UA_STATUSCODE_BADDECODINGERROR;
+        unresolvedMember.first->memberType = memberType;
+        UA_NodeId_clear(&unresolvedMember.second);
+    }
+    if (retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "deserializeRegistry: Invalid custom data type registry (%s)", UA_StatusCode_name(retval));
+        clearCustomDataTypes();
+        return retval;
+    }
+    return linkCustomDataTypes();
+}
+
+// appends the current custom data type registry to the file of the recorder
+// has to be called if the registry is initialized again while recording (e.g. after a reconnection to a changed server)
+UA_StatusCode UA_Recorder_writeRegistry(UA_Recorder* recorder) {
+    std::vector<UA_Byte> payload;
+    UA_StatusCode retval;
+    if (!recorder || !recorder->file) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Recorder_writeRegistry: Parameter 1 (UA_Recorder*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    retval = serializeRegistry(&payload);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+    std::lock_guard<std::mutex> lock(activeRecorderMutex);
+    return writeRecord(recorder, UA_RECORDKIND_REGISTRY, payload);
+}
+
+// opens (or continues) a recording file and records all responses of UA_ReadValues (UA_ReadAndPrintValues, UA_Poller,
+// UA_ReaderPool, UA_ReconnectManager) and UA_Monitor_iterate until UA_Recorder_close, only one recorder can be open at a time
+// the current custom data type registry is recorded first, so initializeCustomDataTypes should be called before
+UA_StatusCode UA_Recorder_open(UA_Recorder* recorder, const char* fileName) {
+    char magic[sizeof(UA_RECORDER_MAGIC) - 1];
+    UA_StatusCode retval;
+    FILE* file;
+
+    if (!recorder) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Recorder_open: Parameter 1 (UA_Recorder*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!fileName || !*fileName) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Recorder_open: Parameter 2 (const char*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    recorder->file = 0x0;
+    recorder->records = 0;
+    recorder->bytes = 0;
+    if (isRecording()) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Recorder_open: Another recorder is open");
+        return UA_STATUSCODE_BADINVALIDSTATE;
+    }
+    // append only, an existing file has to be a recording
+    file = fopen(fileName, "a+b");
+    if (!file) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Recorder_open: Could not open %s", fileName);
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    fseek(file, 0, SEEK_SET);
+    if (fread(magic, 1, sizeof(magic), file) == sizeof(magic))
+        retval = memcmp(magic, UA_RECORDER_MAGIC, sizeof(magic)) ? UA_STATUSCODE_BADINVALIDARGUMENT : UA_STATUSCODE_GOOD;
+    else {
+        fseek(file, 0, SEEK_END);
+        retval = ftell(file) ? UA_STATUSCODE_BADINVALIDARGUMENT : UA_STATUSCODE_GOOD;
+        if (retval == UA_STATUSCODE_GOOD && fwrite(UA_RECORDER_MAGIC, 1, sizeof(magic), file) != sizeof(magic))
+            retval = UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    fseek(file, 0, SEEK_END);
+    if (retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Recorder_open: %s is not a recording (%s)", fileName, UA_StatusCode_name(retval));
+        fclose(file);
+        return retval;
+    }
+    recorder->file = file;
+    retval = UA_Recorder_writeRegistry(recorder);
+    if (retval == UA_STATUSCODE_GOOD) {
+        std::lock_guard<std::mutex> lock(activeRecorderMutex);
+        if (activeRecorder)
+            retval = UA_STATUSCODE_BADINVALIDSTATE;
+        else
+            activeRecorder = recorder;
+    }
+    if (retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Recorder_open: Could not start the recording (%s)", UA_StatusCode_name(retval));
+        fclose(file);
+        recorder->file = 0x0;
+    }
+    return retval;
+}
+
+// stops the recording and closes the file
+UA_StatusCode UA_Recorder_close(UA_Recorder* recorder) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    if (!recorder) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Recorder_close: Parameter 1 (UA_Recorder*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    std::lock_guard<std::mutex> lock(activeRecorderMutex);
+    if (activeRecorder == recorder)
+        activeRecorder = 0x0;
+    if (recorder->file && fclose(recorder->file))
+        retval = UA_STATUSCODE_BADUNEXPECTEDERROR;
+    recorder->file = 0x0;
+    return retval;
+}
+
+// memory mapping of a recording or a registry image
+typedef struct {
+    const UA_Byte* data;
+    size_t length;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+} mappedFile_t;
+
+static UA_StatusCode mapFile(const char* fileName, mappedFile_t* mappedFile, UA_Boolean copyOnWrite) {
+    memset(mappedFile, 0x0, sizeof(mappedFile_t));
+#ifdef _WIN32
+    LARGE_INTEGER size;
+    mappedFile->file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, 0x0, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0x0);
+    if (mappedFile->file == INVALID_HANDLE_VALUE)
+        return UA_STATUSCODE_BADNOTFOUND;
+    if (!GetFileSizeEx(mappedFile->file, &size) || !size.QuadPart) {
+        CloseHandle(mappedFile->file);
+        return UA_STATUSCODE_BADNOTFOUND;
+    }
+    mappedFile->length = (size_t)size.QuadPart;
+    mappedFile->mapping = CreateFileMappingA(mappedFile->file, 0x0, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, 0x0);
+    if (mappedFile->mapping)
+        mappedFile->data = (const UA_Byte*)MapViewOfFile(mappedFile->mapping, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+    if (!mappedFile->data) {
+        if (mappedFile->mapping)
+            CloseHandle(mappedFile->mapping);
+        CloseHandle(mappedFile->file);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+#else
+    struct stat fileStat;
+    void* data;
+    int file = open(fileName, O_RDONLY);
+    if (file < 0)
+        return UA_STATUSCODE_BADNOTFOUND;
+    if (fstat(file, &fileStat) || !fileStat.st_size) {
+        close(file);
+        return UA_STATUSCODE_BADNOTFOUND;
+    }
+    // written pages of a copy-on-write mapping become private, the other pages stay shared with the page cache
+    data = mmap(0x0, (size_t)fileStat.st_size, copyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, file, 0);
+    // the mapping stays valid after the file is closed
+    close(file);
+    if (data == MAP_FAILED)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    // records are read once from begin to end
+    if (!copyOnWrite)
+        madvise(data, (size_t)fileStat.st_size, MADV_SEQUENTIAL);
+    mappedFile->data = (const UA_Byte*)data;
+    mappedFile->length = (size_t)fileStat.st_size;
+#endif
+    return UA_STATUSCODE_GOOD;
+}
+
+static void unmapFile(mappedFile_t* mappedFile) {
+#ifdef _WIN32
+    UnmapViewOfFile(mappedFile->data);
+    CloseHandle(mappedFile->mapping);
+    CloseHandle(mappedFile->file);
+#else
+    munmap((void*)mappedFile->data, mappedFile->length);
+#endif
+    memset(mappedFile, 0x0, sizeof(mappedFile_t));
+}
+
+// sink callback of UA_Replay without sink, the output is formatted but not written
+static UA_StatusCode discardOutput(void* sinkContext, const UA_Byte* data, size_t length) {
+    return UA_STATUSCODE_GOOD;
+}
+
+// subfunction of UA_Replay, decodes a response record and prints its values with readAndPrintValue
+static UA_StatusCode replayResponse(UA_RecordKind kind, const UA_ByteString* payload, readAndPrintContext_t* context, UA_ReplayStatistics* statistics) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point decoded;
+    UA_UInt64 decodeStarted = metricsStart();
+    UA_Variant nodeIds, dataTypeIds;
+    UA_ReadResponse readResponse;
+    UA_PublishResponse publishResponse;
+    size_t position = 0;
+    UA_StatusCode retval;
+
+    UA_Variant_init(&nodeIds);
+    UA_Variant_init(&dataTypeIds);
+    UA_ReadResponse_init(&readResponse);
+    UA_PublishResponse_init(&publishResponse);
+    retval = decodeArray(payload, &position, &nodeIds, &UA_TYPES[UA_TYPES_NODEID]);
+    retval |= decodeArray(payload, &position, &dataTypeIds, &UA_TYPES[UA_TYPES_NODEID]);
+    if (retval == UA_STATUSCODE_GOOD && kind == UA_RECORDKIND_READRESPONSE)
+        retval = UA_decodeBinary(payload, &position, &readResponse, &UA_TYPES[UA_TYPES_READRESPONSE], customDataTypes);
+    else if (retval == UA_STATUSCODE_GOOD)
+        retval = UA_decodeBinary(payload, &position, &publishResponse, &UA_TYPES[UA_TYPES_PUBLISHRESPONSE], customDataTypes);
+    decoded = std::chrono::steady_clock::now();
+    statistics->decodeTime += (UA_UInt64)std::chrono::duration_cast<std::chrono::nanoseconds>(decoded - start).count();
+    metricsRecord(UA_HISTOGRAM_DECODE, decodeStarted);
+    if (retval == UA_STATUSCODE_GOOD)
+        profileDecode(&readResponse, &publishResponse, (UA_UInt64)std::chrono::duration_cast<std::chrono::nanoseconds>(decoded - start).count());
+
+    const UA_NodeId* nodeId = (const UA_NodeId*)nodeIds.data;
+    if (retval == UA_STATUSCODE_GOOD && kind == UA_RECORDKIND_READRESPONSE) {
+        // value and data type attribute of each node (see readValuesChunked)
+        if (readResponse.resultsSize != 2 * nodeIds.arrayLength)
+            retval = UA_STATUSCODE_BADDECODINGERROR;
+        for (size_t i = 0; i < nodeIds.arrayLength && retval == UA_STATUSCODE_GOOD; i++) {
+            const UA_DataValue* dataType = &readResponse.results[2 * i + 1];
+            const UA_NodeId* dataTypeId = 0x0;
+            if (dataType->hasValue && UA_Variant_hasScalarType(&dataType->value, &UA_TYPES[UA_TYPES_NODEID]))
+                dataTypeId = (const UA_NodeId*)dataType->value.data;
+            retval = readAndPrintValue(context, &nodeId[i], dataTypeId, &readResponse.results[2 * i]);
+            statistics->values++;
+        }
+    }
+    else if (retval == UA_STATUSCODE_GOOD) {
+        const UA_NotificationMessage* message = &publishResponse.notificationMessage;
+        for (size_t i = 0; i < message->notificationDataSize && retval == UA_STATUSCODE_GOOD; i++) {
+            const UA_ExtensionObject* notificationData = &message->notificationData[i];
+            if (notificationData->encoding < UA_EXTENSIONOBJECT_DECODED || notificationData->content.decoded.type != &UA_TYPES[UA_TYPES_DATACHANGENOTIFICATION])
+                continue;
+            const UA_DataChangeNotification* dataChange = (const UA_DataChangeNotification*)notificationData->content.decoded.data;
+            for (size_t j = 0; j < dataChange->monitoredItemsSize && retval == UA_STATUSCODE_GOOD; j++) {
+                const size_t handle = dataChange->monitoredItems[j].clientHandle;
+                const UA_NodeId* dataTypeId = 0x0;
+                if (handle >= nodeIds.arrayLength) {
+                    retval = UA_STATUSCODE_BADDECODINGERROR;
+                    break;
+                }
+                if (handle < dataTypeIds.arrayLength && !UA_NodeId_isNull(&((const UA_NodeId*)dataTypeIds.data)[handle]))
+                    dataTypeId = &((const UA_NodeId*)dataTypeIds.data)[handle];
+                retval = readAndPrintValue(context, &nodeId[handle], dataTypeId, &dataChange->monitoredItems[j].value);
+                statistics->values++;
+            }
+        }
+    }
+    statistics->printTime += (UA_UInt64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - decoded).count();
+    statistics->records++;
+    statistics->bytes += payload->length;
+    UA_Variant_clear(&nodeIds);
+    UA_Variant_clear(&dataTypeIds);
+    UA_ReadResponse_clear(&readResponse);
+    UA_PublishResponse_clear(&publishResponse);
+    return retval;
+}
+
+// replays a recording of UA_Recorder without server: the file is memory-mapped and the recorded responses are
+// decoded and printed like UA_ReadAndPrintValues (format and output of the values are the same)
+// the custom data type registry of the module is replaced by the recorded registry
+// without sink the values are decoded and formatted only (e.g. for profiling), the caller is responsible to flush the sink
+// statistics (optional) returns the number of records and values and the time of decoding and printing
+UA_StatusCode UA_Replay(const char* fileName, UA_PrintFormat format, UA_OutputSink* sink, UA_ReplayStatistics* statistics) {
+    const size_t magicLength = sizeof(UA_RECORDER_MAGIC) - 1;
+    UA_ReplayStatistics replayStatistics;
+    readAndPrintContext_t context;
+    UA_OutputSink discardSink;
+    mappedFile_t mappedFile;
+    size_t position;
+    UA_StatusCode retval;
+
+    if (!fileName || !*fileName) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Replay: Parameter 1 (const char*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (sink && !sink->callback) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Replay: Parameter 3 (UA_OutputSink*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    if (!sink) {
+        UA_OutputSink_init(&discardSink, discardOutput, 0x0);
+        sink = &discardSink;
+    }
+    context.sink = sink;
+    context.format = format;
+    context.filter = 0x0;
+    memset(&replayStatistics, 0x0, sizeof(UA_ReplayStatistics));
+
+    retval = mapFile(fileName, &mappedFile, false);
+    if (retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Replay: Could not map %s (%s)", fileName, UA_StatusCode_name(retval));
+        return retval;
+    }
+    if (mappedFile.length < magicLength || memcmp(mappedFile.data, UA_RECORDER_MAGIC, magicLength)) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Replay: %s is not a recording", fileName);
+        unmapFile(&mappedFile);
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    }
+    position = magicLength;
+    while (position < mappedFile.length && retval == UA_STATUSCODE_GOOD) {
+        const UA_Byte* header = &mappedFile.data[position];
+        UA_RecordKind kind;
+        UA_ByteString payload;
+        // the last record is incomplete if the recording was interrupted
+        if (mappedFile.length - position < 16 || readLittleEndian(&header[4], 4) > mappedFile.length - position - 16) {
+            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Replay: Incomplete record at the end of %s", fileName);
+            break;
+        }
+        kind = (UA_RecordKind)readLittleEndian(header, 4);
+        payload.length = (size_t)readLittleEndian(&header[4], 4);
+        payload.data = (UA_Byte*)&header[16];
+        position += 16 + payload.length;
+        if (kind == UA_RECORDKIND_REGISTRY)
+            retval = deserializeRegistry(&payload);
+        else if (kind == UA_RECORDKIND_READRESPONSE || kind == UA_RECORDKIND_PUBLISHRESPONSE)
+            retval = replayResponse(kind, &payload, &context, &replayStatistics);
+        // unknown kinds are skipped
+    }
+    unmapFile(&mappedFile);
+    if (retval == UA_STATUSCODE_GOOD && sink == &discardSink)
+        retval = UA_OutputSink_flush(&discardSink);
+    if (retval != UA_STATUSCODE_GOOD)
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Replay: Could not replay %s (%s)", fileName, UA_StatusCode_name(retval));
+    if (statistics)
+        *statistics = replayStatistics;
+    return retval;
+}
+
+// metrics of one thread, only the owning thread writes (relaxed load and store, no locked instructions)
+typedef struct {
+    std::atomic<UA_UInt64> counters[UA_COUNTER_COUNT];
+    std::atomic<UA_UInt64> histogramSums[UA_HISTOGRAM_COUNT];
+    std::atomic<UA_UInt64> histograms[UA_HISTOGRAM_COUNT][UA_HISTOGRAM_BUCKETS];
+} metricsShard_t;
+
+// shards of the running threads, the metrics of terminated threads are merged into metricsRetired
+// UA_Metrics_reset stores a baseline, so the shards are never written by other threads
+static std::atomic<UA_Boolean> metricsEnabled(false);
+static std::mutex metricsMutex;
+static std::vector<metricsShard_t*> metricsShards;
+static UA_MetricsSnapshot metricsRetired;
+static UA_MetricsSnapshot metricsBaseline;
+static std::atomic<UA_UInt64> metricsTypesResolved(0);
+static std::atomic<UA_UInt64> metricsTypesUnresolved(0);
+
+// registers the shard of a thread on first use and merges it into metricsRetired when the thread terminates
+typedef struct metricsThreadShard_t {
+    metricsShard_t* shard;
+    metricsThreadShard_t() : shard(0x0) {}
+    ~metricsThreadShard_t() {
+        if (!shard)
+            return;
+        std::lock_guard<std::mutex> lock(metricsMutex);
+        for (size_t i = 0; i < UA_COUNTER_COUNT; i++)
+            metricsRetired.counters[i] += shard->counters[i].load(std::memory_order_relaxed);
+        for (size_t i = 0; i < UA_HISTOGRAM_COUNT; i++) {
+            metricsRetired.histogramSums[i] += shard->histogramSums[i].load(std::memory_order_relaxed);
+            for (size_t j = 0; j < UA_HISTOGRAM_BUCKETS; j++)
+                metricsRetired.histograms[i][j] += shard->histograms[i][j].load(std::memory_order_relaxed);
+        }
+        metricsShards.erase(std::find(metricsShards.begin(), metricsShards.end(), shard));
+        delete shard;
+    }
+} metricsThreadShard_t;
+static thread_local metricsThreadShard_t metricsThreadShard;
+
+static metricsShard_t* metricsShard(void) {
+    if (metricsThreadShard.shard)
+        return metricsThreadShard.shard;
+    metricsShard_t* shard = new metricsShard_t();
+    for (size_t i = 0; i < UA_COUNTER_COUNT; i++)
+        shard->counters[i].store(0, std::memory_order_relaxed);
+    for (size_t i = 0; i < UA_HISTOGRAM_COUNT; i++) {
+        shard->histogramSums[i].store(0, std::memory_order_relaxed);
+        for (size_t j = 0; j < UA_HISTOGRAM_BUCKETS; j++)
+            shard->histograms[i][j].store(0, std::memory_order_relaxed);
+    }
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    metricsShards.push_back(shard);
+    metricsThreadShard.shard = shard;
+    return shard;
+}
+
+static inline void metricsAdd(std::atomic<UA_UInt64>* metric, UA_UInt64 value) {
+    metric->store(metric->load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+// bucket of a value: 0..15 exact, above 8 sub-buckets per power of two (relative error below 12.5 %)
+static size_t histogramBucket(UA_UInt64 value) {
+    UA_UInt32 exponent = 0;
+    if (value < 2 * UA_HISTOGRAM_SUBBUCKETS)
+        return (size_t)value;
+    for (UA_UInt32 shift = 32; shift; shift >>= 1)
+        if (value >> (exponent + shift))
+            exponent += shift;
+    return 2 * UA_HISTOGRAM_SUBBUCKETS + (exponent - 4) * UA_HISTOGRAM_SUBBUCKETS + (size_t)((value >> (exponent - 3)) & (UA_HISTOGRAM_SUBBUCKETS - 1));
+}
+
+// smallest value of the next bucket (exclusive upper bound of a bucket)
+static UA_UInt64 histogramBucketLimit(size_t bucket) {
+    UA_UInt32 exponent;
+    if (bucket < 2 * UA_HISTOGRAM_SUBBUCKETS)
+        return bucket + 1;
+    exponent = (UA_UInt32)((bucket - 2 * UA_HISTOGRAM_SUBBUCKETS) / UA_HISTOGRAM_SUBBUCKETS + 4);
+    return (UA_UInt64)(UA_HISTOGRAM_SUBBUCKETS + (bucket % UA_HISTOGRAM_SUBBUCKETS) + 1) << (exponent - 3);
+}
+
+// start time of a measurement in ns, 0 if the metrics are disabled
+static UA_UInt64 metricsStart(void) {
+    if (!metricsEnabled.load(std::memory_order_relaxed))
+        return 0;
+    return (UA_UInt64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() | 1;
+}
+
+// adds the time since start to the histogram
+static void metricsRecord(UA_HistogramId histogram, UA_UInt64 start) {
+    UA_UInt64 duration;
+    metricsShard_t* shard;
+    if (!start)
+        return;
+    duration = (UA_UInt64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() - start;
+    shard = metricsShard();
+    metricsAdd(&shard->histograms[histogram][histogramBucket(duration)], 1);
+    metricsAdd(&shard->histogramSums[histogram], duration);
+}
+
+// adds the time since start to the histogram and the encoded size of the response to the received bytes
+static void metricsRecordResponse(UA_HistogramId histogram, UA_UInt64 start, const void* response, const UA_DataType* type) {
+    if (!start)
+        return;
+    metricsRecord(histogram, start);
+    metricsAdd(&metricsShard()->counters[UA_COUNTER_BYTESRECEIVED], UA_calcSizeBinary(response, type));
+}
+
+// adds the time since start to the print histogram of the type kind of the value
+static void metricsRecordPrint(UA_UInt64 start, const UA_NodeId* dataTypeId, const UA_Variant* data) {
+    const customTypeProperties_t* customTypeProperties;
+    UA_HistogramId histogram = UA_HISTOGRAM_PRINTOTHER;
+    if (!start)
+        return;
+    if (data->type && (data->type->typeKind == UA_DATATYPEKIND_STRUCTURE || data->type->typeKind == UA_DATATYPEKIND_OPTSTRUCT))
+        histogram = UA_HISTOGRAM_PRINTSTRUCTURE;
+    else if (data->type && data->type->typeKind == UA_DATATYPEKIND_UNION)
+        histogram = UA_HISTOGRAM_PRINTUNION;
+    else if (data->type && UA_NodeId_equal(&data->type->typeId, &NS0ID_INT32)) {
+        customTypeProperties = findCustomTypeProperties(dataTypeId);
+        if (customTypeProperties && customTypeProperties->enumValuesSize)
+            histogram = UA_HISTOGRAM_PRINTENUM;
+    }
+    metricsRecord(histogram, start);
+}
+
+static void metricsCount(UA_CounterId counter, UA_UInt64 value) {
+    if (metricsEnabled.load(std::memory_order_relaxed))
+        metricsAdd(&metricsShard()->counters[counter], value);
+}
+
+// counts the custom data types with and without unresolved members (types of unknown dictionary entries)
+static void metricsCountTypes(void) {
+    UA_UInt64 resolved = 0, unresolved = 0;
+    for (typePropIt_t typePropIt = dataTypeMap.begin(); typePropIt != dataTypeMap.end(); typePropIt++) {
+        const UA_DataType* dataType = &typePropIt->second.dataType;
+        UA_Boolean isResolved = !UA_NodeId_isNull(&dataType->typeId);
+        for (UA_UInt32 i = 0; isResolved && i < dataType->membersSize; i++)
+            isResolved = dataType->members[i].memberType != 0x0;
+        if (isResolved)
+            resolved++;
+        else
+            unresolved++;
+    }
+    metricsTypesResolved.store(resolved, std::memory_order_relaxed);
+    metricsTypesUnresolved.store(unresolved, std::memory_order_relaxed);
+}
+
+// enables or disables the instrumentation (disabled by default), disabled metrics cost one relaxed load per measurement
+void UA_Metrics_enable(UA_Boolean enabled) {
+    metricsEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+// subfunction of UA_Metrics_snapshot and UA_Metrics_reset, sums the metrics of all threads since the start of the program
+static void metricsSum(UA_MetricsSnapshot* snapshot) {
+    memcpy(snapshot, &metricsRetired, sizeof(UA_MetricsSnapshot));
+    for (const metricsShard_t* shard : metricsShards) {
+        for (size_t i = 0; i < UA_COUNTER_COUNT; i++)
+            snapshot->counters[i] += shard->counters[i].load(std::memory_order_relaxed);
+        for (size_t i = 0; i < UA_HISTOGRAM_COUNT; i++) {
+            snapshot->histogramSums[i] += shard->histogramSums[i].load(std::memory_order_relaxed);
+            for (size_t j = 0; j < UA_HISTOGRAM_BUCKETS; j++)
+                snapshot->histograms[i][j] += shard->histograms[i][j].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+// sets counters and histograms to zero (the type counts are kept)
+void UA_Metrics_reset(void) {
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    metricsSum(&metricsBaseline);
+}
+
+// returns the metrics of all threads since the start of the program or the last UA_Metrics_reset
+// the snapshot is consistent per value, values of running measurements may be missing
+UA_StatusCode UA_Metrics_snapshot(UA_MetricsSnapshot* snapshot) {
+    if (!snapshot) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Metrics_snapshot: Parameter 1 (UA_MetricsSnapshot*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    metricsSum(snapshot);
+    for (size_t i = 0; i < UA_COUNTER_COUNT; i++)
+        snapshot->counters[i] -= metricsBaseline.counters[i];
+    for (size_t i = 0; i < UA_HISTOGRAM_COUNT; i++) {
+        snapshot->histogramSums[i] -= metricsBaseline.histogramSums[i];
+        for (size_t j = 0; j < UA_HISTOGRAM_BUCKETS; j++)
+            snapshot->histograms[i][j] -= metricsBaseline.histograms[i][j];
+    }
+    snapshot->typesResolved = metricsTypesResolved.load(std::memory_order_relaxed);
+    snapshot->typesUnresolved = metricsTypesUnresolved.load(std::memory_order_relaxed);
+    return UA_STATUSCODE_GOOD;
+}
+
+// returns the upper bound (ns) of the bucket containing the percentile (0..100) of a histogram, 0 if the histogram is empty
+UA_UInt64 UA_Metrics_percentile(const UA_MetricsSnapshot* snapshot, UA_HistogramId histogram, UA_Double percentile) {
+    UA_UInt64 count = 0, rank, sum = 0;
+    if (!snapshot || histogram >= UA_HISTOGRAM_COUNT)
+        return 0;
+    for (size_t i = 0; i < UA_HISTOGRAM_BUCKETS; i++)
+        count += snapshot->histograms[histogram][i];
+    if (!count)
+        return 0;
+    rank = (UA_UInt64)std::ceil(std::min(std::max(percentile, 0.0), 100.0) / 100.0 * (UA_Double)count);
+    for (size_t i = 0; i < UA_HISTOGRAM_BUCKETS; i++) {
+        sum += snapshot->histograms[histogram][i];
+        if (sum >= std::max<UA_UInt64>(rank, 1))
+            return histogramBucketLimit(i) - 1;
+    }
+    return 0;
+}
+
+// subfunction of UA_Metrics_writePrometheus, writes a histogram in seconds with buckets at powers of two from 1 us to 64 s
+static UA_StatusCode prometheusWriteHistogram(UA_OutputSink* sink, const UA_MetricsSnapshot* snapshot, UA_HistogramId histogram, const char* name, const char* labels) {
+    char line[256];
+    UA_UInt64 count = 0;
+    size_t bucket = 0;
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    for (UA_UInt32 exponent = 10; exponent <= 36 && retval == UA_STATUSCODE_GOOD; exponent++) {
+        // values below 2^exponent ns
+        for (; bucket < histogramBucket((UA_UInt64)1 << exponent); bucket++)
+            count += snapshot->histograms[histogram][bucket];
+        snprintf(line, sizeof(line), "%s_bucket{%s%sle=\"%.9g\"} %llu\n", name, labels, *labels ? "," : "", (UA_Double)((UA_UInt64)1 << exponent) / 1e9,
+                 (unsigned long long)count);
+        retval = UA_OutputSink_write(sink, line, strlen(line));
+    }
+    for (; bucket < UA_HISTOGRAM_BUCKETS; bucket++)
+        count += snapshot->histograms[histogram][bucket];
+    snprintf(line, sizeof(line), "%s_bucket{%s%sle=\"+Inf\"} %llu\n%s_sum%s%s%s %.9g\n%s_count%s%s%s %llu\n", name, labels, *labels ? "," : "", (unsigned long long)count,
+             name, *labels ? "{" : "", labels, *labels ? "}" : "", (UA_Double)snapshot->histogramSums[histogram] / 1e9,
+             name, *labels ? "{" : "", labels, *labels ? "}" : "", (unsigned long long)count);
+    retval |= UA_OutputSink_write(sink, line, strlen(line));
+    return retval;
+}
+
+// writes a snapshot of the metrics in the Prometheus text exposition format to the sink (e.g. UA_OutputSink_writeFile)
+// the caller is responsible to flush the sink
+UA_StatusCode UA_Metrics_writePrometheus(UA_OutputSink* sink) {
+    static const char* printKinds[] = { "structure", "enum", "union", "other" };
+    UA_MetricsSnapshot* snapshot;
+    char line[256];
+    UA_StatusCode retval;
+
+    if (!sink || !sink->callback) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Metrics_writePrometheus: Parameter 1 (UA_OutputSink*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    // about 32 kB, too large for the stack of small threads
+    snapshot = (UA_MetricsSnapshot*)UA_malloc(sizeof(UA_MetricsSnapshot));
+    if (!snapshot)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_Metrics_snapshot(snapshot);
+    retval = jsonWriteRaw(sink, "# HELP exo_browse_duration_seconds Browse and BrowseNext round trips\n# TYPE exo_browse_duration_seconds histogram\n");
+    retval |= prometheusWriteHistogram(sink, snapshot, UA_HISTOGRAM_BROWSE, "exo_browse_duration_seconds", "");
+    retval |= jsonWriteRaw(sink, "# HELP exo_read_duration_seconds Read round trips\n# TYPE exo_read_duration_seconds histogram\n");
+    retval |= prometheusWriteHistogram(sink, snapshot, UA_HISTOGRAM_READ, "exo_read_duration_seconds", "");
+    retval |= jsonWriteRaw(sink, "# HELP exo_dictionary_parse_duration_seconds Parsing of the dictionaries\n# TYPE exo_dictionary_parse_duration_seconds histogram\n");
+    retval |= prometheusWriteHistogram(sink, snapshot, UA_HISTOGRAM_PARSEXML, "exo_dictionary_parse_duration_seconds", "");
+    retval |= jsonWriteRaw(sink, "# HELP exo_decode_duration_seconds Decoding of recorded responses\n# TYPE exo_decode_duration_seconds histogram\n");
+    retval |= prometheusWriteHistogram(sink, snapshot, UA_HISTOGRAM_DECODE, "exo_decode_duration_seconds", "");
+    retval |= jsonWriteRaw(sink, "# HELP exo_print_duration_seconds Printing of values per type kind\n# TYPE exo_print_duration_seconds histogram\n");
+    for (size_t i = 0; i < 4; i++) {
+        snprintf(line, sizeof(line), "kind=\"%s\"", printKinds[i]);
+        retval |= prometheusWriteHistogram(sink, snapshot, (UA_HistogramId)(UA_HISTOGRAM_PRINTSTRUCTURE + i), "exo_print_duration_seconds", line);
+    }
+    snprintf(line, sizeof(line), "# HELP exo_received_bytes_total Encoded size of Browse and Read responses\n# TYPE exo_received_bytes_total counter\nexo_received_bytes_total %llu\n",
+             (unsigned long long)snapshot->counters[UA_COUNTER_BYTESRECEIVED]);
+    retval |= jsonWriteRaw(sink, line);
+    snprintf(line, sizeof(line), "# HELP exo_print_allocations_total Output blocks allocated by print contexts\n# TYPE exo_print_allocations_total counter\nexo_print_allocations_total %llu\n",
+             (unsigned long long)snapshot->counters[UA_COUNTER_PRINTALLOCATIONS]);
+    retval |= jsonWriteRaw(sink, line);
+    snprintf(line, sizeof(line), "# HELP exo_datatype_cache_requests_total Lookups of the data type cache\n# TYPE exo_datatype_cache_requests_total counter\n"
+             "exo_datatype_cache_requests_total{result=\"hit\"} %llu\nexo_datatype_cache_requests_total{result=\"miss\"} %llu\n",
+             (unsigned long long)snapshot->counters[UA_COUNTER_CACHEHITS], (unsigned long long)snapshot->counters[UA_COUNTER_CACHEMISSES]);
+    retval |= jsonWriteRaw(sink, line);
+    snprintf(line, sizeof(line), "# HELP exo_custom_types Custom data types of the last initialization\n# TYPE exo_custom_types gauge\n"
+             "exo_custom_types{state=\"resolved\"} %llu\nexo_custom_types{state=\"unresolved\"} %llu\n",
+             (unsigned long long)snapshot->typesResolved, (unsigned long long)snapshot->typesUnresolved);
+    retval |= jsonWriteRaw(sink, line);
+    UA_free(snapshot);
+    return retval;
+}
+
+// writes the metrics in the Prometheus text exposition format to a file (e.g. for the textfile collector of the node exporter)
+// the file is written to fileName.tmp and renamed, so readers never see a partial snapshot
+UA_StatusCode UA_Metrics_writePrometheusFile(const char* fileName) {
+    UA_OutputSink sink;
+    UA_StatusCode retval;
+    std::string tmpFileName;
+    FILE* file;
+
+    if (!fileName || !*fileName) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Metrics_writePrometheusFile: Parameter 1 (const char*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    tmpFileName = std::string(fileName) + ".tmp";
+    file = fopen(tmpFileName.c_str(), "wb");
+    if (!file) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Metrics_writePrometheusFile: Could not open %s", tmpFileName.c_str());
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    UA_OutputSink_init(&sink, UA_OutputSink_writeFile, file);
+    retval = UA_Metrics_writePrometheus(&sink);
+    retval |= UA_OutputSink_flush(&sink);
+    if (fclose(file))
+        retval = UA_STATUSCODE_BADUNEXPECTEDERROR;
+#ifdef _WIN32
+    // rename does not replace existing files on Windows
+    if (retval == UA_STATUSCODE_GOOD && !MoveFileExA(tmpFileName.c_str(), fileName, MOVEFILE_REPLACE_EXISTING))
+        retval = UA_STATUSCODE_BADUNEXPECTEDERROR;
+#else
+    if (retval == UA_STATUSCODE_GOOD && rename(tmpFileName.c_str(), fileName))
+        retval = UA_STATUSCODE_BADUNEXPECTEDERROR;
+#endif
+    if (retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Metrics_writePrometheusFile: Could not write %s", fileName);
+        remove(tmpFileName.c_str());
+    }
+    return retval;
+}
+
+// costs of the frames of one thread, the mutex is only contended by snapshots
+typedef struct {
+    std::mutex mutex;
+    std::unordered_map<std::string, UA_ProfileEntry> entries; // key: path
+} profileShard_t;
+
+// open frame of the printing walk
+typedef struct {
+    size_t pathLength; // length of the path of the parent frame
+    const UA_DataType* type;
+    std::chrono::steady_clock::time_point start;
+    UA_UInt64 childTime;
+    UA_UInt64 allocations; // allocations of the thread at the start of the frame
+} profileFrame_t;
+
+// profiles of terminated threads are merged into profileRetired
+static std::atomic<UA_Boolean> profilerEnabled(false);
+static std::mutex profilerMutex;
+static std::vector<profileShard_t*> profileShards;
+static std::unordered_map<std::string, UA_ProfileEntry> profileRetired;
+
+// subfunction of the profiler, adds the costs of an entry
+static void profileMerge(std::unordered_map<std::string, UA_ProfileEntry>* entries, const UA_ProfileEntry* entry) {
+    UA_ProfileEntry& sum = (*entries)[entry->path];
+    if (sum.path.empty()) {
+        sum = *entry;
+        return;
+    }
+    sum.calls += entry->calls;
+    sum.printTime += entry->printTime;
+    sum.selfTime += entry->selfTime;
+    sum.decodeTime += entry->decodeTime;
+    sum.bytes += entry->bytes;
+    sum.allocations += entry->allocations;
+}
+
+// frame stack and shard of a thread, the shard is merged into profileRetired when the thread terminates
+typedef struct profileThread_t {
+    profileShard_t* shard;
+    std::string path; // collapsed stack of the open frames
+    std::vector<profileFrame_t> frames;
+    UA_UInt64 allocations; // output blocks allocated by print contexts of the thread
+    profileThread_t() : shard(0x0), allocations(0) {}
+    ~profileThread_t() {
+        if (!shard)
+            return;
+        std::lock_guard<std::mutex> lock(profilerMutex);
+        for (const std::pair<const std::string, UA_ProfileEntry>& entry : shard->entries)
+            profileMerge(&profileRetired, &entry.second);
+        profileShards.erase(std::find(profileShards.begin(), profileShards.end(), shard));
+        delete shard;
+    }
+} profileThread_t;
+static thread_local profileThread_t profileThread;
+
+static profileShard_t* profileShard(void) {
+    if (profileThread.shard)
+        return profileThread.shard;
+    profileShard_t* shard = new profileShard_t();
+    std::lock_guard<std::mutex> lock(profilerMutex);
+    profileShards.push_back(shard);
+    profileThread.shard = shard;
+    return shard;
+}
+
+// appends the name of a type, ';' and ' ' separate frames and counts in collapsed stacks
+static void profileAppendName(std::string* path, const char* name) {
+    for (; *name; name++)
+        path->push_back(*name == ';' || *name == ' ' ? '_' : *name);
+}
+
+static void profileAppendTypeName(std::string* path, const UA_DataType* type) {
+    char name[32];
+#ifdef UA_ENABLE_TYPEDESCRIPTION
+    if (type->typeName) {
+        profileAppendName(path, type->typeName);
+        return;
+    }
+#endif
+    if (type->typeId.identifierType == UA_NODEIDTYPE_NUMERIC)
+        snprintf(name, sizeof(name), "ns=%u,i=%u", type->typeId.namespaceIndex, type->typeId.identifier.numeric);
+    else
+        snprintf(name, sizeof(name), "ns=%u,h=%08X", type->typeId.namespaceIndex, UA_NodeId_SDBMHash(&type->typeId));
+    path->append(name);
+}
+
+// subfunction of the profileEnter functions
+static void profilePush(const UA_DataType* type, size_t pathLength) {
+    profileFrame_t frame;
+    frame.pathLength = pathLength;
+    frame.type = type;
+    frame.childTime = 0;
+    frame.allocations = profileThread.allocations;
+    frame.start = std::chrono::steady_clock::now();
+    profileThread.frames.push_back(frame);
+}
+
+// opens the frame of a printed value, false if the profiler is disabled
+static UA_Boolean profileEnterType(const UA_DataType* type) {
+    size_t pathLength = profileThread.path.length();
+    if (!profilerEnabled.load(std::memory_order_relaxed) || !type)
+        return false;
+    if (pathLength)
+        profileThread.path.push_back(';');
+    profileAppendTypeName(&profileThread.path, type);
+    profilePush(type, pathLength);
+    return true;
+}
+
+// opens the frame of a structure or union member, false if the profiler is disabled or no value frame is open
+// array members are typeless, the array frame (profileEnterArray) has the type of the elements
+static UA_Boolean profileEnterMember(const UA_DataType* type, size_t index) {
+    size_t pathLength = profileThread.path.length();
+    char name[32];
+    if (!profilerEnabled.load(std::memory_order_relaxed) || profileThread.frames.empty())
+        return false;
+    profileThread.path.push_back(';');
+#ifdef UA_ENABLE_TYPEDESCRIPTION
+    if (type->members[index].memberName && *type->members[index].memberName)
+        profileAppendName(&profileThread.path, type->members[index].memberName);
+    else
+#endif
+    {
+        snprintf(name, sizeof(name), "member%u", (UA_UInt32)index);
+        profileThread.path.append(name);
+    }
+    profilePush(type->members[index].isArray ? 0x0 : type->members[index].memberType, pathLength);
+    return true;
+}
+
+// opens the frame of an array of printArray, false if the profiler is disabled or no value frame is open
+static UA_Boolean profileEnterArray(const UA_DataType* type) {
+    size_t pathLength = profileThread.path.length();
+    if (!profilerEnabled.load(std::memory_order_relaxed) || profileThread.frames.empty())
+        return false;
+    profileThread.path.push_back(';');
+    profileAppendTypeName(&profileThread.path, type);
+    profileThread.path.append("[]");
+    profilePush(type, pathLength);
+    return true;
+}
+
+// closes the last frame and adds its costs to the entry of its path
+static void profileLeave(UA_UInt64 bytes) {
+    profileFrame_t* frame = &profileThread.frames.back();
+    UA_UInt64 printTime = (UA_UInt64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - frame->start).count();
+    profileShard_t* shard = profileShard();
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        UA_ProfileEntry& entry = shard->entries[profileThread.path];
+        // the name is copied, the type may be freed before the report (e.g. clearCustomDataTypes)
+        if (entry.path.empty()) {
+            entry.path = profileThread.path;
+            if (frame->type)
+                profileAppendTypeName(&entry.typeName, frame->type);
+        }
+        entry.calls++;
+        entry.printTime += printTime;
+        entry.selfTime += printTime > frame->childTime ? printTime - frame->childTime : 0;
+        entry.bytes += bytes;
+        entry.allocations += profileThread.allocations - frame->allocations;
+    }
+    profileThread.path.resize(frame->pathLength);
+    profileThread.frames.pop_back();
+    if (!profileThread.frames.empty())
+        profileThread.frames.back().childTime += printTime;
+}
+
+// returns the path of the open frames of the calling thread for profileAttach
+// empty if the profiler is disabled or no frame is open
+static std::string profileParentPath(void) {
+    if (!profilerEnabled.load(std::memory_order_relaxed) || profileThread.frames.empty())
+        return std::string();
+    return profileThread.path;
+}
+
+// continues the frames of another thread (see profileParentPath) in a worker thread, so the frames of the worker
+// get the paths of a walk in one thread, false if parentPath is empty or the thread has open frames itself
+static UA_Boolean profileAttach(const std::string& parentPath) {
+    if (parentPath.empty() || !profileThread.frames.empty())
+        return false;
+    profileThread.path = parentPath;
+    profilePush(0x0, 0);
+    return true;
+}
+
+// closes the frame of profileAttach without an entry and adds its child time and allocations to the sums
+static void profileDetach(std::atomic<UA_UInt64>* childTime, std::atomic<UA_UInt64>* allocations) {
+    profileFrame_t* frame = &profileThread.frames.back();
+    childTime->fetch_add(frame->childTime, std::memory_order_relaxed);
+    allocations->fetch_add(profileThread.allocations - frame->allocations, std::memory_order_relaxed);
+    profileThread.frames.pop_back();
+    profileThread.path.clear();
+}
+
+// adds the costs of the worker threads (see profileDetach) to the open frame of the calling thread
+static void profileAddWorkers(UA_UInt64 childTime, UA_UInt64 allocations) {
+    if (profileThread.frames.empty())
+        return;
+    profileThread.frames.back().childTime += childTime;
+    // the allocations of a frame are counted from its start value
+    profileThread.frames.back().allocations -= allocations;
+}
+
+// encoded size of an array
+static UA_UInt64 profileArraySize(const void* p, size_t length, const UA_DataType* type) {
+    UA_UInt64 bytes = sizeof(UA_Int32);
+    for (size_t i = 0; p && i < length; i++)
+        bytes += UA_calcSizeBinary((const UA_Byte*)p + i * type->memSize, type);
+    return bytes;
+}
+
+// encoded size of a structure member at p
+static UA_UInt64 profileMemberSize(const UA_DataTypeMember* member, const void* p) {
+    if (member->isArray)
+        return profileArraySize(*(void* const*)((const UA_Byte*)p + sizeof(size_t)), *(const size_t*)p, member->memberType);
+    if (member->isOptional)
+        return *(void* const*)p ? UA_calcSizeBinary(*(void* const*)p, member->memberType) : 0;
+    return UA_calcSizeBinary(p, member->memberType);
+}
+
+// attributes the decode time of a recorded response to the types of its values by their encoded size
+// the response is decoded in one call, a finer attribution is not possible
+static void profileDecode(const UA_ReadResponse* readResponse, const UA_PublishResponse* publishResponse, UA_UInt64 decodeTime) {
+    std::vector<const UA_Variant*> values;
+    std::vector<UA_UInt64> sizes;
+    std::string path;
+    UA_UInt64 total = 0;
+    profileShard_t* shard;
+    if (!profilerEnabled.load(std::memory_order_relaxed))
+        return;
+    // the data type attributes of the read responses are not attributed (see readValuesChunked)
+    for (size_t i = 0; i < readResponse->resultsSize; i += 2)
+        values.push_back(&readResponse->results[i].value);
+    for (size_t i = 0; i < publishResponse->notificationMessage.notificationDataSize; i++) {
+        const UA_ExtensionObject* notificationData = &publishResponse->notificationMessage.notificationData[i];
+        if (notificationData->encoding < UA_EXTENSIONOBJECT_DECODED || notificationData->content.decoded.type != &UA_TYPES[UA_TYPES_DATACHANGENOTIFICATION])
+            continue;
+        const UA_DataChangeNotification* dataChange = (const UA_DataChangeNotification*)notificationData->content.decoded.data;
+        for (size_t j = 0; j < dataChange->monitoredItemsSize; j++)
+            values.push_back(&dataChange->monitoredItems[j].value.value);
+    }
+    sizes.resize(values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        if (!values[i]->type)
+            continue;
+        sizes[i] = UA_Variant_isScalar(values[i]) ? UA_calcSizeBinary(values[i]->data, values[i]->type) :
+                   profileArraySize(values[i]->data, values[i]->arrayLength, values[i]->type);
+        total += sizes[i];
+    }
+    if (!total)
+        return;
+    shard = profileShard();
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    for (size_t i = 0; i < values.size(); i++) {
+        if (!values[i]->type)
+            continue;
+        path.clear();
+        profileAppendTypeName(&path, values[i]->type);
+        UA_ProfileEntry& entry = shard->entries[path];
+        if (entry.path.empty()) {
+            entry.path = path;
+            entry.typeName = path;
+        }
+        entry.decodeTime += decodeTime * sizes[i] / total;
+    }
+}
+
+// enables or disables the profiler (disabled by default)
+// the profiler attributes the costs of UA_PrintStructure, UA_PrintUnion, UA_PrintEnum and printArray to types and member paths
+void UA_Profiler_enable(UA_Boolean enabled) {
+    profilerEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+// removes the costs of all threads
+void UA_Profiler_reset(void) {
+    std::lock_guard<std::mutex> lock(profilerMutex);
+    profileRetired.clear();
+    for (profileShard_t* shard : profileShards) {
+        std::lock_guard<std::mutex> shardLock(shard->mutex);
+        shard->entries.clear();
+    }
+}
+
+// returns the costs of all member paths, sorted by decode and print time (most expensive first)
+UA_StatusCode UA_Profiler_snapshot(std::vector<UA_ProfileEntry>* entries) {
+    std::unordered_map<std::string, UA_ProfileEntry> sum;
+    if (!entries) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Profiler_snapshot: Parameter 1 (std::vector<UA_ProfileEntry>*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    {
+        std::lock_guard<std::mutex> lock(profilerMutex);
+        sum = profileRetired;
+        for (profileShard_t* shard : profileShards) {
+            std::lock_guard<std::mutex> shardLock(shard->mutex);
+            for (const std::pair<const std::string, UA_ProfileEntry>& entry : shard->entries)
+                profileMerge(&sum, &entry.second);
+        }
+    }
+    entries->clear();
+    entries->reserve(sum.size());
+    for (std::pair<const std::string, UA_ProfileEntry>& entry : sum)
+        entries->push_back(std::move(entry.second));
+    std::sort(entries->begin(), entries->end(), [](const UA_ProfileEntry& a, const UA_ProfileEntry& b) {
+        if (a.decodeTime + a.printTime != b.decodeTime + b.printTime)
+            return a.decodeTime + a.printTime > b.decodeTime + b.printTime;
+        return a.path < b.path;
+    });
+    return UA_STATUSCODE_GOOD;
+}
+
+// subfunction of UA_Profiler_writeReport, writes one row of the report
+static UA_StatusCode profileWriteRow(UA_OutputSink* sink, size_t rank, const UA_ProfileEntry* entry, const std::string& name) {
+    char line[192];
+    snprintf(line, sizeof(line), "%5u %14llu %14llu %14llu %12llu %12llu %10llu  ", (UA_UInt32)rank, (unsigned long long)entry->decodeTime,
+             (unsigned long long)entry->printTime, (unsigned long long)entry->selfTime, (unsigned long long)entry->bytes,
+             (unsigned long long)entry->allocations, (unsigned long long)entry->calls);
+    UA_StatusCode retval = jsonWriteRaw(sink, line);
+    retval |= UA_OutputSink_write(sink, name.data(), name.length());
+    retval |= UA_OutputSink_write(sink, "\n", 1);
+    return retval;
+}
+
+// writes a ranked report of the types (costs of all frames of a type, printing including the members)
+// and of the member paths (costs of the frames of a path) to the sink, maxEntries = 0 writes all rows
+UA_StatusCode UA_Profiler_writeReport(UA_OutputSink* sink, size_t maxEntries) {
+    static const char* header = " rank      decode_ns       print_ns        self_ns        bytes  allocations      calls  ";
+    std::vector<UA_ProfileEntry> entries, types;
+    std::map<std::string, size_t> typeIndex; // key: type name
+    std::string name;
+    UA_StatusCode retval;
+
+    if (!sink || !sink->callback) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Profiler_writeReport: Parameter 1 (UA_OutputSink*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    UA_Profiler_snapshot(&entries);
+    // a type does not contain itself, the frames of a type do not overlap
+    for (const UA_ProfileEntry& entry : entries) {
+        if (entry.typeName.empty())
+            continue;
+        std::map<std::string, size_t>::iterator typeIt = typeIndex.find(entry.typeName);
+        if (typeIt == typeIndex.end()) {
+            typeIndex[entry.typeName] = types.size();
+            types.push_back(entry);
+            types.back().path = entry.typeName;
+            continue;
+        }
+        UA_ProfileEntry* type = &types[typeIt->second];
+        type->calls += entry.calls;
+        type->printTime += entry.printTime;
+        type->selfTime += entry.selfTime;
+        type->decodeTime += entry.decodeTime;
+        type->bytes += entry.bytes;
+        type->allocations += entry.allocations;
+    }
+    std::sort(types.begin(), types.end(), [](const UA_ProfileEntry& a, const UA_ProfileEntry& b) {
+        return a.decodeTime + a.printTime > b.decodeTime + b.printTime;
+    });
+    retval = jsonWriteRaw(sink, "# types\n");
+    retval |= jsonWriteRaw(sink, header);
+    retval |= jsonWriteRaw(sink, "type\n");
+    for (size_t i = 0; i < types.size() && (!maxEntries || i < maxEntries); i++)
+        retval |= profileWriteRow(sink, i + 1, &types[i], types[i].path);
+    retval |= jsonWriteRaw(sink, "# member paths\n");
+    retval |= jsonWriteRaw(sink, header);
+    retval |= jsonWriteRaw(sink, "path\n");
+    for (size_t i = 0; i < entries.size() && (!maxEntries || i < maxEntries); i++) {
+        name = entries[i].path;
+        std::replace(name.begin(), name.end(), ';', '.');
+        retval |= profileWriteRow(sink, i + 1, &entries[i], name);
+    }
+    return retval;
+}
+
+// writes the costs as collapsed stacks ("frame;frame;frame ns" per line, e.g. for flamegraph.pl)
+// print time is written below the frame "print" (self time of each path), decode time below the frame "decode"
+UA_StatusCode UA_Profiler_writeCollapsed(UA_OutputSink* sink) {
+    std::vector<UA_ProfileEntry> entries;
+    char count[24];
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+
+    if (!sink || !sink->callback) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Profiler_writeCollapsed: Parameter 1 (UA_OutputSink*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    UA_Profiler_snapshot(&entries);
+    for (const UA_ProfileEntry& entry : entries) {
+        if (entry.selfTime) {
+            snprintf(count, sizeof(count), " %llu\n", (unsigned long long)entry.selfTime);
+            retval |= jsonWriteRaw(sink, "print;");
+            retval |= UA_OutputSink_write(sink, entry.path.data(), entry.path.length());
+            retval |= jsonWriteRaw(sink, count);
+        }
+        if (entry.decodeTime) {
+            snprintf(count, sizeof(count), " %llu\n", (unsigned long long)entry.decodeTime);
+            retval |= jsonWriteRaw(sink, "decode;");
+            retval |= UA_OutputSink_write(sink, entry.path.data(), entry.path.length());
+            retval |= jsonWriteRaw(sink, count);
+        }
+    }
+    return retval;
+}
+
+// subfunction of UA_Profiler_writeFiles
+static UA_StatusCode profileWriteFile(const char* fileName, UA_StatusCode (*write)(UA_OutputSink* sink)) {
+    UA_OutputSink sink;
+    UA_StatusCode retval;
+    FILE* file = fopen(fileName, "wb");
+    if (!file) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Profiler_writeFiles: Could not open %s", fileName);
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    UA_OutputSink_init(&sink, UA_OutputSink_writeFile, file);
+    retval = write(&sink);
+    retval |= UA_OutputSink_flush(&sink);
+    if (fclose(file))
+        retval = UA_STATUSCODE_BADUNEXPECTEDERROR;
+    return retval;
+}
+
+// writes the ranked report and the collapsed stacks to files (e.g. at shutdown), 0x0 skips a file
+UA_StatusCode UA_Profiler_writeFiles(const char* reportFileName, const char* collapsedFileName) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    if (reportFileName)
+        retval |= profileWriteFile(reportFileName, [](UA_OutputSink* sink) { return UA_Profiler_writeReport(sink, 0); });
+    if (collapsedFileName)
+        retval |= profileWriteFile(collapsedFileName, UA_Profiler_writeCollapsed);
+    return retval;
+}
+
+// counts an output block of a print context for the open frames
+static void profileCountAllocation(void) {
+    if (profilerEnabled.load(std::memory_order_relaxed))
+        profileThread.allocations++;
+}
+
+// trace file of UA_Trace_start, events are written immediately (a stalled initialization can be inspected while it runs)
+// traceStart is published by traceEnabled (release/acquire) and atomic itself, threads may still read it while tracing is started again
+static std::atomic<UA_Boolean> traceEnabled(false);
+static std::mutex traceMutex;
+static FILE* traceFile = 0x0;
+static std::atomic<UA_Int64> traceStart(0); // ns of std::chrono::steady_clock
+static UA_UInt64 traceEvents;
+static std::unordered_set<UA_UInt32> traceThreads; // threads with a name event
+static std::atomic<UA_UInt32> traceNextThread(0);
+static thread_local UA_Int64 traceThread = -1; // track of the thread (session index of the discovery)
+
+// start of a span in ns since the start of the trace, -1 if tracing is disabled
+static UA_Int64 traceBegin(void) {
+    if (!traceEnabled.load(std::memory_order_acquire))
+        return -1;
+    return (UA_Int64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() -
+        traceStart.load(std::memory_order_relaxed);
+}
+
+// shows the spans of the thread on the track of a discovery session (0 = session of the caller)
+static void traceSetSession(size_t session) {
+    if (traceEnabled.load(std::memory_order_acquire))
+        traceThread = (UA_Int64)session;
+}
+
+// subfunction of traceEnd, appends a JSON string
+static void traceAppendEscaped(std::string* event, const char* str) {
+    char escaped[8];
+    event->push_back('"');
+    for (; *str; str++) {
+        if (*str == '"' || *str == '\\') {
+            event->push_back('\\');
+            event->push_back(*str);
+        }
+        else if ((UA_Byte)*str < 0x20) {
+            snprintf(escaped, sizeof(escaped), "\\u%04x", (UA_Byte)*str);
+            event->append(escaped);
+        }
+        else
+            event->push_back(*str);
+    }
+    event->push_back('"');
+}
+
+// writes a complete event ("ph":"X") of a span started with traceBegin, detail (optional) is shown as argument
+static void traceEnd(UA_Int64 start, const char* category, const char* name, const char* detail) {
+    std::string event;
+    char number[96];
+    UA_Int64 end = traceBegin();
+    UA_UInt32 thread;
+    if (start < 0 || end < 0)
+        return;
+    // threads without session get the tracks behind the sessions
+    if (traceThread < 0)
+        traceThread = 1000 + traceNextThread.fetch_add(1, std::memory_order_relaxed);
+    thread = (UA_UInt32)traceThread;
+    event.append("{\"name\":");
+    traceAppendEscaped(&event, name);
+    event.append(",\"cat\":");
+    traceAppendEscaped(&event, category);
+    snprintf(number, sizeof(number), ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u", start / 1000.0, (end - start) / 1000.0, thread);
+    event.append(number);
+    if (detail && *detail) {
+        event.append(",\"args\":{\"detail\":");
+        traceAppendEscaped(&event, detail);
+        event.push_back('}');
+    }
+    event.push_back('}');
+    std::lock_guard<std::mutex> lock(traceMutex);
+    if (!traceFile)
+        return;
+    if (traceThreads.insert(thread).second) {
+        if (thread < 1000)
+            snprintf(number, sizeof(number), "session %u", thread);
+        else
+            snprintf(number, sizeof(number), "thread %u", thread - 1000);
+        fprintf(traceFile, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}", traceEvents++ ? ",\n" : "", thread, number);
+    }
+    fprintf(traceFile, "%s%s", traceEvents++ ? ",\n" : "", event.c_str());
+}
+
+// detail of a span: node ID
+static std::string traceNodeId(const UA_NodeId* nodeId) {
+    UA_String out;
+    std::string detail;
+    if (UA_print(nodeId, &UA_TYPES[UA_TYPES_NODEID], &out) != UA_STATUSCODE_GOOD)
+        return detail;
+    detail.assign((const char*)out.data, out.length);
+    UA_String_clear(&out);
+    return detail;
+}
+
+// starts tracing of the initialization (initializeCustomDataTypes) into a Chrome trace event file (JSON)
+// e.g. for chrome://tracing or https://ui.perfetto.dev, the file is complete after UA_Trace_stop
+UA_StatusCode UA_Trace_start(const char* fileName) {
+    if (!fileName || !*fileName) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Trace_start: Parameter 1 (const char*) invalid");
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    std::lock_guard<std::mutex> lock(traceMutex);
+    if (traceFile) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Trace_start: Tracing is already started");
+        return UA_STATUSCODE_BADINVALIDSTATE;
+    }
+    traceFile = fopen(fileName, "wb");
+    if (!traceFile) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_Trace_start: Could not open %s", fileName);
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    }
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", traceFile);
+    traceEvents = 0;
+    traceThreads.clear();
+    traceStart.store((UA_Int64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(),
+        std::memory_order_relaxed);
+    traceEnabled.store(true, std::memory_order_release);
+    return UA_STATUSCODE_GOOD;
+}
+
+// stops tracing and completes the trace file, spans which are still open are not written
+UA_StatusCode UA_Trace_stop(void) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    std::lock_guard<std::mutex> lock(traceMutex);
+    if (!traceFile)
+        return UA_STATUSCODE_BADINVALIDSTATE;
+    traceEnabled.store(false, std::memory_order_release);
+    fputs("\n]}\n", traceFile);
+    if (fclose(traceFile))
+        retval = UA_STATUSCODE_BADUNEXPECTEDERROR;
+    traceFile = 0x0;
+    return retval;
+}
+
+// position-independent image of the custom data type registry (see UA_RegistryImage_write)
+// references are offsets or indexes, strings are zero-terminated and stored once in the string pool
+#define REGISTRY_IMAGE_MAGIC "UAREGIMG"
+#define REGISTRY_IMAGE_VERSION 2
+#define REGISTRY_IMAGE_BYTEORDER 0x01020304
+#define REGISTRY_IMAGE_PAGESIZE 4096
+
+// string of the string pool, offset 0 is the empty string
+typedef struct {
+    UA_UInt32 offset;
+    UA_UInt32 length;
+} registryImageString_t;
+
+typedef struct {
+    UA_UInt16 namespaceIndex;
+    UA_Byte identifierType;
+    UA_Byte reserved;
+    UA_UInt32 numeric;
+    registryImageString_t string; // string and byte string identifiers
+    UA_Guid guid;
+} registryImageNodeId_t;
+
+typedef struct {
+    registryImageNodeId_t typeId;
+    registryImageNodeId_t binaryEncodingId;
+    registryImageNodeId_t subTypeOfId;
+    registryImageString_t typeName;
+    UA_UInt16 memSize;
+    UA_Byte typeKind;
+    UA_Byte flags; // bit 0: pointerFree, bit 1: overlayable
+    UA_UInt32 membersSize;
+    UA_UInt32 firstMember;
+    UA_UInt32 enumValuesSize;
+    UA_UInt32 firstEnumValue;
+    UA_UInt32 optionBitsSize;
+    UA_UInt32 firstOptionBit;
+} registryImageType_t;
+
+typedef struct {
+    UA_Int64 value;
+    registryImageString_t name;
+} registryImageEnumValue_t;
+
+// entry of the hash index (sorted by hash, key of dataTypeMap)
+typedef struct {
+    UA_UInt32 hash;
+    UA_UInt32 type;
+} registryImageHash_t;
+
+// entry of the name index (sorted by name, key of dataTypeNameMap)
+typedef struct {
+    registryImageString_t name;
+    UA_UInt32 type;
+} registryImageName_t;
+
+// the sections are 8 byte aligned, the members are the last section and start on a page of their own
+// members are stored in the native layout: memberName holds a string offset and memberType a type reference
+// (0 = none, odd = index in UA_TYPES * 2 + 1, even = (index in the image + 1) * 2), both are fixed up when loaded
+typedef struct {
+    char magic[8];
+    UA_UInt32 version;
+    UA_UInt32 byteOrder;
+    UA_UInt32 pointerSize;
+    UA_UInt32 memberSize; // sizeof(UA_DataTypeMember)
+    UA_UInt32 builtinTypesSize; // UA_TYPES_COUNT
+    UA_UInt32 typesSize; // also the size of the hash index
+    UA_UInt32 namesSize; // size of the name index
+    UA_UInt32 membersSize;
+    UA_UInt32 enumValuesSize;
+    UA_UInt32 optionBitsSize; // names of the option set bits
+    UA_UInt64 typesOffset;
+    UA_UInt64 hashIndexOffset;
+    UA_UInt64 nameIndexOffset;
+    UA_UInt64 enumValuesOffset;
+    UA_UInt64 optionBitsOffset;
+    UA_UInt64 stringsOffset;
+    UA_UInt64 stringsSize;
+    UA_UInt64 membersOffset;
+    UA_UInt64 size;
+} registryImageHeader_t;
+
+// sections of an image while it is written
+typedef struct {
+    std::vector<registryImageType_t> types;
+    std::vector<registryImageHash_t> hashIndex;
+    std::vector<registryImageName_t> nameIndex;
+    std::vector<UA_DataTypeMember> members;
+    std::vector<registryImageEnumValue_t> enumValues;
+    std::vector<registryImageString_t> optionBits;
+    std::string strings;
+    std::unordered_map<std::string, UA_UInt32> stringOffsets;
+} registryImageBuilder_t;
+
+// mapping of UA_RegistryImage_load, the names, members and node IDs of the registry point into it
+static mappedFile_t registryImage;
+
+// unmaps the registry image (the registry has to be cleared before, see clearCustomDataTypes)
+static void releaseRegistryImage(void) {
+    if (registryImage.data)
+        unmapFile(&registryImage);
+}
+
+// checks whether the registry points into a registry image, its members are read-only until clearCustomDataTypes
+static UA_Boolean isRegistryMapped(void) {
+    return registryImage.data != 0x0;
+}
+
+// subfunction of buildRegistryImage, adds a string to the string pool
+static registryImageString_t addImageString(registryImageBuilder_t* builder, const UA_Byte* data, size_t length) {
+    registryImageString_t imageString = { 0, 0 };
+    if (!data || !length)
+        return imageString;
+    std::pair<std::unordered_map<std::string, UA_UInt32>::iterator, bool> inserted =
+        builder->stringOffsets.emplace(std::string((const char*)data, length), (UA_UInt32)builder->strings.size());
+    if (inserted.second) {
+        builder->strings.append((const char*)data, length);
+        builder->strings.push_back('\0');
+    }
+    imageString.offset = inserted.first->second;
+    imageString.length = (UA_UInt32)length;
+    return imageString;
+}
+
+// subfunction of buildRegistryImage
+static registryImageNodeId_t addImageNodeId(registryImageBuilder_t* builder, const UA_NodeId* nodeId) {
+    registryImageNodeId_t imageNodeId;
+    memset(&imageNodeId, 0x0, sizeof(registryImageNodeId_t));
+    imageNodeId.namespaceIndex = nodeId->namespaceIndex;
+    imageNodeId.identifierType = (UA_Byte)nodeId->identifierType;
+    switch (nodeId->identifierType) {
+    case UA_NODEIDTYPE_NUMERIC:
+        imageNodeId.numeric = nodeId->identifier.numeric;
+        break;
+    case UA_NODEIDTYPE_STRING:
+    case UA_NODEIDTYPE_BYTESTRING:
+        imageNodeId.string = addImageString(builder, nodeId->identifier.string.data, nodeId->identifier.string.length);
         break;
-    }
-    case UA_DATATYPEKIND_BITFIELDCLUSTER /* bitfields + padding */: {
-        *output = UA_STRING_ALLOC("bitfields + padding");
+    case UA_NODEIDTYPE_GUID:
+        imageNodeId.guid = nodeId->identifier.guid;
         break;
     }
-    default: {
-        *output = UA_STRING_ALLOC("unknown");
-    }
+    return imageNodeId;
+}
+
+// subfunction of UA_RegistryImage_write, converts the registry (dataTypeMap and dataTypeNameMap) into the sections of the image
+static UA_StatusCode buildRegistryImage(registryImageBuilder_t* builder) {
+    std::unordered_map<const UA_DataType*, UA_UInt32> typeIndexes;
+    std::unordered_map<const customTypeProperties_t*, UA_UInt32> propertiesIndexes;
+
+    builder->strings.push_back('\0');
+    for (typePropIt_t typePropIt = dataTypeMap.begin(); typePropIt != dataTypeMap.end(); typePropIt++) {
+        registryImageHash_t hashEntry = { typePropIt->first, (UA_UInt32)builder->types.size() };
+        typeIndexes[&typePropIt->second.dataType] = hashEntry.type;
+        propertiesIndexes[&typePropIt->second] = hashEntry.type;
+        // dataTypeMap is ordered by hash
+        builder->hashIndex.push_back(hashEntry);
+        builder->types.emplace_back();
+    }
+    for (typePropIt_t typePropIt = dataTypeMap.begin(); typePropIt != dataTypeMap.end(); typePropIt++) {
+        const customTypeProperties_t* customTypeProperties = &typePropIt->second;
+        const UA_DataType* dataType = &customTypeProperties->dataType;
+        registryImageType_t* imageType = &builder->types[typeIndexes[dataType]];
+
+        imageType->typeId = addImageNodeId(builder, &dataType->typeId);
+        imageType->binaryEncodingId = addImageNodeId(builder, &dataType->binaryEncodingId);
+        imageType->subTypeOfId = addImageNodeId(builder, &customTypeProperties->subTypeOfId);
+#ifdef UA_ENABLE_TYPEDESCRIPTION
+        if (dataType->typeName)
+            imageType->typeName = addImageString(builder, (const UA_Byte*)dataType->typeName, strlen(dataType->typeName));
+#endif
+        imageType->memSize = dataType->memSize;
+        imageType->typeKind = (UA_Byte)dataType->typeKind;
+        imageType->flags = (UA_Byte)(dataType->pointerFree | (dataType->overlayable << 1));
+        imageType->firstMember = (UA_UInt32)builder->members.size();
+        imageType->membersSize = dataType->members ? dataType->membersSize : 0;
+        for (UA_UInt32 i = 0; i < imageType->membersSize; i++) {
+            const UA_DataTypeMember* dataTypeMember = &dataType->members[i];
+            UA_DataTypeMember imageMember;
+            uintptr_t memberType = 0;
+            memset(&imageMember, 0x0, sizeof(UA_DataTypeMember));
+            imageMember.padding = dataTypeMember->padding;
+            imageMember.isArray = dataTypeMember->isArray;
+            imageMember.isOptional = dataTypeMember->isOptional;
+#ifdef UA_ENABLE_TYPEDESCRIPTION
+            if (dataTypeMember->memberName)
+                imageMember.memberName = (const char*)(uintptr_t)addImageString(builder, (const UA_Byte*)dataTypeMember->memberName, strlen(dataTypeMember->memberName)).offset;
+#endif
+            if (dataTypeMember->memberType >= &UA_TYPES[0] && dataTypeMember->memberType < &UA_TYPES[UA_TYPES_COUNT])
+                memberType = (uintptr_t)(dataTypeMember->memberType - UA_TYPES) * 2 + 1;
+            else if (dataTypeMember->memberType) {
+                std::unordered_map<const UA_DataType*, UA_UInt32>::iterator typeIndexIt = typeIndexes.find(dataTypeMember->memberType);
+                if (typeIndexIt == typeIndexes.end()) {
+                    UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "buildRegistryImage: Member %u of a custom data type has a type outside of the registry", i);
+                    return UA_STATUSCODE_BADNOTSUPPORTED;
+                }
+                memberType = ((uintptr_t)typeIndexIt->second + 1) * 2;
+            }
+            imageMember.memberType = (const UA_DataType*)memberType;
+            builder->members.push_back(imageMember);
+        }
+        imageType->firstEnumValue = (UA_UInt32)builder->enumValues.size();
+        imageType->enumValuesSize = customTypeProperties->enumValuesSize;
+        for (UA_UInt32 i = 0; i < customTypeProperties->enumValuesSize; i++) {
+            const UA_String* name = getEnumValueName(customTypeProperties, i);
+            registryImageEnumValue_t imageEnumValue;
+            memset(&imageEnumValue, 0x0, sizeof(registryImageEnumValue_t));
+            imageEnumValue.value = getEnumValue(customTypeProperties, i);
+            imageEnumValue.name = addImageString(builder, name->data, name->length);
+            builder->enumValues.push_back(imageEnumValue);
+        }
+        imageType->firstOptionBit = (UA_UInt32)builder->optionBits.size();
+        imageType->optionBitsSize = customTypeProperties->optionBitsSize;
+        for (UA_UInt32 i = 0; i < customTypeProperties->optionBitsSize; i++) {
+            const UA_String* name = getOptionBitName(customTypeProperties, i);
+            builder->optionBits.push_back(addImageString(builder, name->data, name->length));
+        }
     }
+    // dataTypeNameMap is ordered by name
+    for (nameTypePropIt_t nameTypePropIt = dataTypeNameMap.begin(); nameTypePropIt != dataTypeNameMap.end(); nameTypePropIt++) {
+        std::unordered_map<const customTypeProperties_t*, UA_UInt32>::iterator propertiesIndexIt = propertiesIndexes.find(nameTypePropIt->second);
+        if (propertiesIndexIt == propertiesIndexes.end() || nameTypePropIt->first.empty())
+            continue;
+        registryImageName_t nameEntry;
+        memset(&nameEntry, 0x0, sizeof(registryImageName_t));
+        nameEntry.name = addImageString(builder, (const UA_Byte*)nameTypePropIt->first.data(), nameTypePropIt->first.length());
+        nameEntry.type = propertiesIndexIt->second;
+        builder->nameIndex.push_back(nameEntry);
+    }
+    if (builder->strings.size() > UA_UINT32_MAX)
+        return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
+    return UA_STATUSCODE_GOOD;
 }
 
-// prints variant data type UNION to UA_String
-UA_StatusCode UA_PrintUnion(const UA_Variant* data, UA_String* output) {
-    const UA_DataType* dataType;
-    UA_PrintContext ctx;
+// subfunction of UA_RegistryImage_write, appends a section at the next 8 byte boundary and returns its offset
+static UA_UInt64 appendImageSection(std::vector<UA_Byte>* image, const void* data, size_t length, size_t alignment = 8) {
+    UA_UInt64 offset = (image->size() + alignment - 1) / alignment * alignment;
+    image->resize((size_t)offset);
+    image->insert(image->end(), (const UA_Byte*)data, (const UA_Byte*)data + length);
+    return offset;
+}
+
+// writes the custom data type registry as image file, which can be shared by processes with UA_RegistryImage_load
+// the image is written to a temporary file and renamed (processes which mapped the previous image keep it)
+UA_StatusCode UA_RegistryImage_write(const char* fileName) {
+    registryImageBuilder_t builder;
+    registryImageHeader_t header;
+    std::vector<UA_Byte> image;
+    std::string tmpFileName;
     UA_StatusCode retval;
-    UA_String outString;
-    uintptr_t ptrs;
+    FILE* file;
 
-    if (!data) {
-        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintUnion: Parameter 1 (UA_Variant*) invalid");
+    if (!fileName || !*fileName) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_RegistryImage_write: Parameter 1 (const char*) invalid");
         return UA_STATUSCODE_BADUNEXPECTEDERROR;
     }
-    if (!output) {
-        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_PrintUnion: Parameter 2 (UA_String*) invalid");
+    retval = buildRegistryImage(&builder);
+    if (retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_RegistryImage_write: Could not build the image (%s)", UA_StatusCode_name(retval));
+        return retval;
+    }
+    memset(&header, 0x0, sizeof(registryImageHeader_t));
+    memcpy(header.magic, REGISTRY_IMAGE_MAGIC, sizeof(header.magic));
+    header.version = REGISTRY_IMAGE_VERSION;
+    header.byteOrder = REGISTRY_IMAGE_BYTEORDER;
+    header.pointerSize = ADDRESS_SIZE;
+    header.memberSize = sizeof(UA_DataTypeMember);
+    header.builtinTypesSize = UA_TYPES_COUNT;
+    header.typesSize = (UA_UInt32)builder.types.size();
+    header.namesSize = (UA_UInt32)builder.nameIndex.size();
+    header.membersSize = (UA_UInt32)builder.members.size();
+    header.enumValuesSize = (UA_UInt32)builder.enumValues.size();
+    header.optionBitsSize = (UA_UInt32)builder.optionBits.size();
+    image.resize(sizeof(registryImageHeader_t));
+    header.typesOffset = appendImageSection(&image, builder.types.data(), builder.types.size() * sizeof(registryImageType_t));
+    header.hashIndexOffset = appendImageSection(&image, builder.hashIndex.data(), builder.hashIndex.size() * sizeof(registryImageHash_t));
+    header.nameIndexOffset = appendImageSection(&image, builder.nameIndex.data(), builder.nameIndex.size() * sizeof(registryImageName_t));
+    header.enumValuesOffset = appendImageSection(&image, builder.enumValues.data(), builder.enumValues.size() * sizeof(registryImageEnumValue_t));
+    header.optionBitsOffset = appendImageSection(&image, builder.optionBits.data(), builder.optionBits.size() * sizeof(registryImageString_t));
+    header.stringsOffset = appendImageSection(&image, builder.strings.data(), builder.strings.size());
+    header.stringsSize = builder.strings.size();
+    // only the pages of the members are written by the fixup, all other pages stay shared
+    header.membersOffset = appendImageSection(&image, builder.members.data(), builder.members.size() * sizeof(UA_DataTypeMember), REGISTRY_IMAGE_PAGESIZE);
+    header.size = image.size();
+    memcpy(image.data(), &header, sizeof(registryImageHeader_t));
+
+    tmpFileName = std::string(fileName) + ".tmp";
+    file = fopen(tmpFileName.c_str(), "wb");
+    if (!file) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_RegistryImage_write: Could not open %s", tmpFileName.c_str());
         return UA_STATUSCODE_BADUNEXPECTEDERROR;
     }
-    retval = UA_STATUSCODE_GOOD;
-    ctx = UA_PrintContext();
-    ctx.depth = 0;
-    dataType = data->type;
-    ptrs = (uintptr_t)data->data;
-    TAILQ_INIT(&ctx.outputs);
-    UA_String_init(output);
-    if (!dataType) {
-        *output = UA_STRING_ALLOC("NullVariant");
+    if (fwrite(image.data(), 1, image.size(), file) != image.size())
+        retval = UA_STATUSCODE_BADUNEXPECTEDERROR;
+    if (fclose(file))
+        retval = UA_STATUSCODE_BADUNEXPECTEDERROR;
+#ifdef _WIN32
+    // rename does not replace existing files on Windows
+    if (retval == UA_STATUSCODE_GOOD && !MoveFileExA(tmpFileName.c_str(), fileName, MOVEFILE_REPLACE_EXISTING))
+        retval = UA_STATUSCODE_BADUNEXPECTEDERROR;
+#else
+    if (retval == UA_STATUSCODE_GOOD && rename(tmpFileName.c_str(), fileName))
+        retval = UA_STATUSCODE_BADUNEXPECTEDERROR;
+#endif
+    if (retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_RegistryImage_write: Could not write %s", fileName);
+        remove(tmpFileName.c_str());
+    }
+    return retval;
+}
+
+// subfunction of checkRegistryImage, checks whether a section of count elements lies within the image
+static UA_Boolean isImageSection(const registryImageHeader_t* header, UA_UInt64 offset, UA_UInt64 count, size_t elementSize) {
+    return offset % 8 == 0 && offset >= sizeof(registryImageHeader_t) && offset <= header->size && count <= (header->size - offset) / elementSize;
+}
+
+// checks the header and the sections of a mapped image, returns the header or 0x0
+static const registryImageHeader_t* checkRegistryImage(const mappedFile_t* image) {
+    const registryImageHeader_t* header = (const registryImageHeader_t*)image->data;
+    if (image->length < sizeof(registryImageHeader_t) || memcmp(header->magic, REGISTRY_IMAGE_MAGIC, sizeof(header->magic)))
+        return 0x0;
+    // the image is written for one platform and one open62541 build
+    if (header->version != REGISTRY_IMAGE_VERSION || header->byteOrder != REGISTRY_IMAGE_BYTEORDER || header->pointerSize != ADDRESS_SIZE ||
+        header->memberSize != sizeof(UA_DataTypeMember) || header->builtinTypesSize != UA_TYPES_COUNT || header->size != image->length) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "checkRegistryImage: The image was written by another build");
+        return 0x0;
+    }
+    if (!isImageSection(header, header->typesOffset, header->typesSize, sizeof(registryImageType_t)) ||
+        !isImageSection(header, header->hashIndexOffset, header->typesSize, sizeof(registryImageHash_t)) ||
+        !isImageSection(header, header->nameIndexOffset, header->namesSize, sizeof(registryImageName_t)) ||
+        !isImageSection(header, header->membersOffset, header->membersSize, sizeof(UA_DataTypeMember)) ||
+        !isImageSection(header, header->enumValuesOffset, header->enumValuesSize, sizeof(registryImageEnumValue_t)) ||
+        !isImageSection(header, header->optionBitsOffset, header->optionBitsSize, sizeof(registryImageString_t)) ||
+        !isImageSection(header, header->stringsOffset, header->stringsSize, 1) || !header->stringsSize ||
+        image->data[header->stringsOffset + header->stringsSize - 1])
+        return 0x0;
+    return header;
+}
+
+// subfunction of loadRegistryImage, returns a string of the string pool (0x0 if it is invalid)
+static const char* getImageString(const registryImageHeader_t* header, const registryImageString_t* string) {
+    const char* strings = (const char*)header + header->stringsOffset;
+    if ((UA_UInt64)string->offset + string->length >= header->stringsSize || strings[string->offset + string->length])
+        return 0x0;
+    return strings + string->offset;
+}
+
+// subfunction of loadRegistryImage, the string points into the image
+static UA_StatusCode getImageUAString(const registryImageHeader_t* header, const registryImageString_t* string, UA_String* out) {
+    const char* data = getImageString(header, string);
+    UA_String_init(out);
+    if (!data)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    if (string->length) {
+        out->length = string->length;
+        out->data = (UA_Byte*)data;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+// subfunction of loadRegistryImage, string identifiers point into the image
+static UA_StatusCode getImageNodeId(const registryImageHeader_t* header, const registryImageNodeId_t* imageNodeId, UA_NodeId* out) {
+    UA_NodeId_init(out);
+    out->namespaceIndex = imageNodeId->namespaceIndex;
+    out->identifierType = (UA_NodeIdType)imageNodeId->identifierType;
+    switch (imageNodeId->identifierType) {
+    case UA_NODEIDTYPE_NUMERIC:
+        out->identifier.numeric = imageNodeId->numeric;
+        return UA_STATUSCODE_GOOD;
+    case UA_NODEIDTYPE_STRING:
+    case UA_NODEIDTYPE_BYTESTRING:
+        return getImageUAString(header, &imageNodeId->string, &out->identifier.string);
+    case UA_NODEIDTYPE_GUID:
+        out->identifier.guid = imageNodeId->guid;
         return UA_STATUSCODE_GOOD;
     }
-    retval |= UA_PrintContext_addString(&ctx, "{");
-    ctx.depth++;
+    return UA_STATUSCODE_BADDECODINGERROR;
+}
+
+// subfunction of loadImageType, interns a string of the string pool without copying it (the image stays mapped until clearCustomDataTypes)
+static UA_StatusCode getImageRegistryString(const registryImageHeader_t* header, const registryImageString_t* string, UA_UInt32* index) {
+    const char* data = getImageString(header, string);
+    if (!data)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    *index = internRegistryString(data, string->length, true);
+    return UA_STATUSCODE_GOOD;
+}
+
+// subfunction of loadRegistryImage, a type of the image (the members are fixed up afterwards)
+static UA_StatusCode loadImageType(const registryImageHeader_t* header, const registryImageType_t* imageType, customTypeProperties_t* customTypeProperties) {
+    const registryImageEnumValue_t* imageEnumValues = (const registryImageEnumValue_t*)((const UA_Byte*)header + header->enumValuesOffset);
+    const registryImageString_t* imageOptionBits = (const registryImageString_t*)((const UA_Byte*)header + header->optionBitsOffset);
+    UA_DataType* dataType = &customTypeProperties->dataType;
+    std::vector<UA_Int64> values(imageType->enumValuesSize);
+    std::vector<UA_UInt32> names(imageType->enumValuesSize);
+    std::vector<UA_UInt32> optionBits(imageType->optionBitsSize);
+    UA_StatusCode retval;
 
+    customTypePropertiesInit(customTypeProperties, &UA_NODEID_NULL);
+    customTypeProperties->isMapped = true;
+    retval = getImageNodeId(header, &imageType->typeId, &dataType->typeId);
+    retval |= getImageNodeId(header, &imageType->binaryEncodingId, &dataType->binaryEncodingId);
+    retval |= getImageNodeId(header, &imageType->subTypeOfId, &customTypeProperties->subTypeOfId);
 #ifdef UA_ENABLE_TYPEDESCRIPTION
-    retval |= UA_PrintContext_addNewlineTabs(&ctx, ctx.depth);
-    retval |= UA_PrintContext_addName(&ctx, "DataType");
-    retval |= UA_PrintContext_addString(&ctx, dataType->typeName);
-    retval |= UA_PrintContext_addString(&ctx, ",");
+    dataType->typeName = getImageString(header, &imageType->typeName);
+    if (!dataType->typeName)
+        retval = UA_STATUSCODE_BADDECODINGERROR;
 #endif
-    retval |= UA_PrintContext_addNewlineTabs(&ctx, ctx.depth);
-    if (UA_Variant_isScalar(data)) {
-        retval |= UA_PrintContext_addName(&ctx, "SwitchValue");
-        UA_UInt32 switchIndex = *((UA_UInt32*)ptrs);
-        retval |= printUInt32(&ctx, switchIndex);
-        //ptrs += UA_TYPES[dataType->members[0].memberTypeIndex].memSize;
-        ptrs += dataType->members[1].padding;
-        if (switchIndex > 0 && switchIndex <= dataType->membersSize) {
-            const UA_DataTypeMember* unionDataTypeMember = &dataType->members[switchIndex - 1];
-            if (unionDataTypeMember) {
-                retval |= UA_PrintContext_addNewlineTabs(&ctx, ctx.depth);
+    if (retval != UA_STATUSCODE_GOOD || imageType->membersSize > UA_BYTE_MAX || (UA_UInt64)imageType->firstMember + imageType->membersSize > header->membersSize ||
+        (UA_UInt64)imageType->firstEnumValue + imageType->enumValuesSize > header->enumValuesSize ||
+        (UA_UInt64)imageType->firstOptionBit + imageType->optionBitsSize > header->optionBitsSize)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    dataType->memSize = imageType->memSize;
+    dataType->typeKind = imageType->typeKind;
+    dataType->pointerFree = imageType->flags & 0x1;
+    dataType->overlayable = (imageType->flags >> 1) & 0x1;
+    if (imageType->membersSize) {
+        dataType->members = (UA_DataTypeMember*)((const UA_Byte*)header + header->membersOffset) + imageType->firstMember;
+        dataType->membersSize = imageType->membersSize;
+    }
+    for (UA_UInt32 i = 0; i < imageType->enumValuesSize && retval == UA_STATUSCODE_GOOD; i++) {
+        values[i] = imageEnumValues[imageType->firstEnumValue + i].value;
+        retval = getImageRegistryString(header, &imageEnumValues[imageType->firstEnumValue + i].name, &names[i]);
+    }
+    for (UA_UInt32 i = 0; i < imageType->optionBitsSize && retval == UA_STATUSCODE_GOOD; i++)
+        retval = getImageRegistryString(header, &imageOptionBits[imageType->firstOptionBit + i], &optionBits[i]);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+    if (!values.empty())
+        setEnumValues(customTypeProperties, values, names);
+    if (!optionBits.empty())
+        setOptionBits(customTypeProperties, optionBits);
+    return UA_STATUSCODE_GOOD;
+}
+
+// subfunction of UA_RegistryImage_load, fills the registry from the mapped image (registryImage)
+// the indexes are sorted, dataTypeMap and dataTypeNameMap are filled in order with hinted insertions
+static UA_StatusCode loadRegistryImage(const registryImageHeader_t* header) {
+    const registryImageType_t* imageTypes = (const registryImageType_t*)((const UA_Byte*)header + header->typesOffset);
+    const registryImageHash_t* hashIndex = (const registryImageHash_t*)((const UA_Byte*)header + header->hashIndexOffset);
+    const registryImageName_t* nameIndex = (const registryImageName_t*)((const UA_Byte*)header + header->nameIndexOffset);
+    UA_DataTypeMember* members = (UA_DataTypeMember*)((const UA_Byte*)header + header->membersOffset);
+    std::vector<customTypeProperties_t*> types(header->typesSize, 0x0);
+    const std::string* previousName = 0x0;
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+
+    for (UA_UInt32 i = 0; i < header->typesSize && retval == UA_STATUSCODE_GOOD; i++) {
+        const registryImageHash_t* hashEntry = &hashIndex[i];
+        if ((i && hashEntry->hash <= hashIndex[i - 1].hash) || hashEntry->type >= header->typesSize || types[hashEntry->type])
+            return UA_STATUSCODE_BADDECODINGERROR;
+        typePropIt_t typePropIt = dataTypeMap.emplace_hint(dataTypeMap.end(), hashEntry->hash, customTypeProperties_t());
+        types[hashEntry->type] = &typePropIt->second;
+        retval = loadImageType(header, &imageTypes[hashEntry->type], &typePropIt->second);
+    }
+    for (UA_UInt32 i = 0; i < header->namesSize && retval == UA_STATUSCODE_GOOD; i++) {
+        const char* name = getImageString(header, &nameIndex[i].name);
+        if (!name || !*name || nameIndex[i].type >= header->typesSize)
+            return UA_STATUSCODE_BADDECODINGERROR;
+        nameTypePropIt_t nameTypePropIt = dataTypeNameMap.emplace_hint(dataTypeNameMap.end(), std::string(name, nameIndex[i].name.length), types[nameIndex[i].type]);
+        if (previousName && *previousName >= nameTypePropIt->first)
+            return UA_STATUSCODE_BADDECODINGERROR;
+        previousName = &nameTypePropIt->first;
+    }
+    // fixup of the members, the only pages of the image which become private
+    for (UA_UInt32 i = 0; i < header->membersSize && retval == UA_STATUSCODE_GOOD; i++) {
+        uintptr_t memberType = (uintptr_t)members[i].memberType;
 #ifdef UA_ENABLE_TYPEDESCRIPTION
-                retval |= UA_PrintContext_addName(&ctx, "Name");
-                retval |= UA_PrintContext_addString(&ctx, unionDataTypeMember->memberName);
-                retval |= UA_PrintContext_addNewlineTabs(&ctx, ctx.depth);
+        uintptr_t memberName = (uintptr_t)members[i].memberName;
+        if (memberName >= header->stringsSize)
+            return UA_STATUSCODE_BADDECODINGERROR;
+        members[i].memberName = memberName ? (const char*)header + header->stringsOffset + memberName : 0x0;
 #endif
-                retval |= UA_PrintContext_addName(&ctx, "Value");
-                UA_print((void*)ptrs, unionDataTypeMember->memberType, &outString);
-                if (retval == UA_STATUSCODE_GOOD) {
-                    retval |= UA_PrintContext_addUAString(&ctx, &outString);
-                    UA_String_clear(&outString);
-                }
-                else {
-                    retval = UA_PrintContext_addString(&ctx, UA_StatusCode_name(retval));
-                }
-            }
-            else {
-                retval |= UA_PrintContext_addString(&ctx, "UNION data type unknown");
-            }
+        if (!memberType)
+            continue;
+        if (memberType & 0x1) {
+            if (memberType / 2 >= UA_TYPES_COUNT)
+                return UA_STATUSCODE_BADDECODINGERROR;
+            members[i].memberType = &UA_TYPES[memberType / 2];
         }
         else {
-            retval |= UA_PrintContext_addNewlineTabs(&ctx, ctx.depth);
-            retval |= UA_PrintContext_addName(&ctx, "Value");
-            retval |= UA_PrintContext_addString(&ctx, "(disabled)");
-        }
-    }
-    ctx.depth--;
-    retval |= UA_PrintContext_addNewlineTabs(&ctx, ctx.depth);
-    retval |= UA_PrintContext_addString(&ctx, "}");
-    /* Allocate memory for the output */
-    if (retval == UA_STATUSCODE_GOOD) {
-        size_t total = 0;
-        UA_PrintOutput* out;
-        TAILQ_FOREACH(out, &ctx.outputs, next)
-            total += out->length;
-        retval = UA_ByteString_allocBuffer((UA_String*)output, total);
-    }
-    /* Write the output */
-    if (retval == UA_STATUSCODE_GOOD) {
-        size_t pos = 0;
-        UA_PrintOutput* out;
-        TAILQ_FOREACH(out, &ctx.outputs, next) {
-            memcpy(&output->data[pos], out->data, out->length);
-            pos += out->length;
+            if (memberType / 2 > header->typesSize)
+                return UA_STATUSCODE_BADDECODINGERROR;
+            members[i].memberType = &types[memberType / 2 - 1]->dataType;
         }
     }
-    /* Free the context */
-    UA_PrintOutput* o, * o2;
-    TAILQ_FOREACH_SAFE(o, &ctx.outputs, next, o2) {
-        TAILQ_REMOVE(&ctx.outputs, o, next);
-        UA_free(o);
-    }
     return retval;
 }
 
-// prints values of custom and base data types to UA_String
-UA_StatusCode UA_PrintValue(UA_Client* client, UA_NodeId nodeId, UA_Variant* data, UA_String* output) {
+// replaces the custom data type registry with an image written by UA_RegistryImage_write
+// the image is mapped copy-on-write: strings, enumerations, option sets and indexes are shared by all processes which load the same file,
+// only the pages of the members are fixed up (private), clearCustomDataTypes unmaps the image
+// the client is initialized with the custom data types like by initializeCustomDataTypes,
+// initializeCustomDataTypes and parseXml are refused until clearCustomDataTypes (the members are read-only)
+UA_StatusCode UA_RegistryImage_load(UA_Client* client, const char* fileName) {
+    const registryImageHeader_t* header;
+    mappedFile_t image;
     UA_StatusCode retval;
+
     if (!client) {
-        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_printValue: Client session invalid");
-        return UA_STATUSCODE_BADUNEXPECTEDERROR;
-    }
-    if (UA_NodeId_isNull(&nodeId)) {
-        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_printValue: Parameter 2 (UA_NodeId) invalid");
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_RegistryImage_load: Client session invalid");
         return UA_STATUSCODE_BADUNEXPECTEDERROR;
     }
-    if (!data) {
-        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_printValue: Parameter 3 (UA_Variant*) invalid");
+    if (!fileName || !*fileName) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_RegistryImage_load: Parameter 2 (const char*) invalid");
         return UA_STATUSCODE_BADUNEXPECTEDERROR;
     }
-    if (!output) {
-        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_printValue: Parameter 4 (UA_String*) invalid");
-        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    retval = mapFile(fileName, &image, true);
+    if (retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_RegistryImage_load: Could not map %s (%s)", fileName, UA_StatusCode_name(retval));
+        return retval;
     }
-    retval = UA_STATUSCODE_GOOD;
-    // STRUCTURE / STRUCTURE WITH OPTINAL FIELDS / UNION / OPTION SET
-    if (data->type->typeKind == UA_DATATYPEKIND_STRUCTURE || data->type->typeKind == UA_DATATYPEKIND_OPTSTRUCT)
-        retval = UA_PrintStructure(data, output);
-    // ENUM
-    else if (UA_NodeId_equal(&data->type->typeId, &NS0ID_INT32) && !data->type->membersSize && !data->arrayLength) {
-        UA_NodeId typeId;
-        typePropIt_t typePropIt;
-        retval = UA_Client_readDataTypeAttribute(client, nodeId, &typeId);
-        if (retval == UA_STATUSCODE_GOOD) {
-            typePropIt = dataTypeMap.find(UA_NodeId_SDBMHash(&typeId));
-            if (typePropIt != dataTypeMap.end() && typePropIt->second.enumValueSet.size())
-                retval = UA_PrintEnum(data, &typePropIt->second, output);
-            else
-                retval = UA_print(data, &UA_TYPES[UA_TYPES_VARIANT], output);
-        }
-        else
-            retval = UA_print(data, &UA_TYPES[UA_TYPES_VARIANT], output);
+    header = checkRegistryImage(&image);
+    if (!header) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_RegistryImage_load: %s is not a valid registry image", fileName);
+        unmapFile(&image);
+        return UA_STATUSCODE_BADDECODINGERROR;
+    }
+    // the client must not decode with the freed types
+    UA_Client_getConfig(client)->customDataTypes = 0x0;
+    clearCustomDataTypes();
+    registryImage = image;
+    retval = loadRegistryImage(header);
+    if (retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "UA_RegistryImage_load: %s is not a valid registry image", fileName);
+        clearCustomDataTypes();
+        return retval;
     }
-    // UNION
-    else if (data->type->typeKind == UA_DATATYPEKIND_UNION)
-        retval = UA_PrintUnion(data, output);
-    // FALLBACK
-    else
-        retval = UA_print(data, &UA_TYPES[UA_TYPES_VARIANT], output);
+    // the image is not written anymore
+#ifdef _WIN32
+    DWORD protection;
+    VirtualProtect((void*)registryImage.data, registryImage.length, PAGE_READONLY, &protection);
+#else
+    mprotect((void*)registryImage.data, registryImage.length, PROT_READ);
+#endif
+    retval = linkCustomDataTypes();
+    metricsCountTypes();
+    if (retval == UA_STATUSCODE_GOOD)
+        UA_Client_getConfig(client)->customDataTypes = customDataTypes;
     return retval;
 }
 
 // retrieve custom data types from the server node /Types/DataTypes/BaseDataType
 // results are stored in dataTypeMap and dataTypeNameMap
-UA_StatusCode scan4BaseDataTypes(UA_Client* client) {
+// with discoveryConfig the levels of the data type tree and the custom data type nodes are split across additional sessions,
+// the results are merged in the order of a scan with one session
+UA_StatusCode scan4BaseDataTypes(UA_Client* client, const UA_DiscoveryConfig* discoveryConfig) {
+    std::vector<UA_Client*> clients; // clients[0] is the session of the caller
     std::vector<UA_NodeId> ids; // nodes to visit
-    std::vector<UA_NodeId> dataTypeIds; // data type nodes
     std::vector<UA_NodeId> customDataTypeIds; // custom data type nodes
-    std::string csBrowseName;
-    UA_BrowseResponse bResp;
-    UA_NodeClass nodeClass;
-    UA_QualifiedName browseName;
+    std::vector<customTypeEntry_t> entries;
     UA_StatusCode retval;
     UA_UInt32 typeIdHash;
-    UA_String out;
+    UA_UInt32 depth = 0;
 
     if (!client) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "scan4BaseDataTypes: Client session invalid");
         return UA_STATUSCODE_BADUNEXPECTEDERROR;
     }
-    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "scan4BaseDataTypes: scanning for custom data types in progress ...");
+    traceSetSession(0);
+    traceSpan_t span("discovery", "scan4BaseDataTypes");
+    clients.push_back(client);
+    if (discoveryConfig && discoveryConfig->sessions) {
+        UA_Int64 traced = traceBegin();
+        openDiscoverySessions(discoveryConfig, &clients);
+        traceEnd(traced, "network", "openDiscoverySessions");
+    }
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "scan4BaseDataTypes: scanning for custom data types with %u session(s) in progress ...", (UA_UInt32)clients.size());
     retval = UA_STATUSCODE_GOOD;
     // start scanning at server node /Types/DataTypes/BaseDataType
     ids.push_back(NS0ID_BASEDATATYPE);
     // collect custom data type node IDs
     do {
-        for (const UA_NodeId& id : ids) {
-            retval |= browseNodeId(client, id, &bResp);
-            if (retval == UA_STATUSCODE_GOOD)
-                scanForTypeIds(&bResp, &dataTypeIds, &customDataTypeIds);
-        }
+        std::vector<std::vector<UA_NodeId>> shardDataTypeIds(clients.size());
+        std::vector<std::vector<UA_NodeId>> shardCustomDataTypeIds(clients.size());
+        std::vector<UA_StatusCode> shardRetval(clients.size(), UA_STATUSCODE_GOOD);
+        traceSpan_t levelSpan("discovery", "level");
+        if (levelSpan.active())
+            levelSpan.detail = "depth " + std::to_string(depth) + ", " + std::to_string(ids.size()) + " IDs";
+        depth++;
+        forEachShard(clients.size(), ids.size(), [&](size_t worker, size_t begin, size_t end) {
+            UA_BrowseResponse bResp;
+            traceSetSession(worker);
+            for (size_t i = begin; i < end; i++) {
+                shardRetval[worker] |= browseNodeId(clients[worker], ids[i], &bResp);
+                if (shardRetval[worker] == UA_STATUSCODE_GOOD)
+                    scanForTypeIds(&bResp, &shardDataTypeIds[worker], &shardCustomDataTypeIds[worker]);
+            }
+        });
         ids.clear();
-        ids.swap(dataTypeIds);
+        for (size_t i = 0; i < clients.size(); i++) {
+            retval |= shardRetval[i];
+            ids.insert(ids.end(), shardDataTypeIds[i].begin(), shardDataTypeIds[i].end());
+            customDataTypeIds.insert(customDataTypeIds.end(), shardCustomDataTypeIds[i].begin(), shardCustomDataTypeIds[i].end());
+        }
         if(ids.size())
             UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "scan4BaseDataTypes: just scanned branch has %d IDs ...", (UA_UInt32)ids.size());
     } while (!ids.empty());
     UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "scan4BaseDataTypes: %d custom node IDs are now processed ...", (UA_UInt32)customDataTypeIds.size());
     // process custom data type node IDs
-    for (const UA_NodeId& id : customDataTypeIds) {
-        typeIdHash = UA_NodeId_SDBMHash(&id);
-        retval = UA_Client_readNodeClassAttribute(client, id, &nodeClass);
-        if (retval != UA_STATUSCODE_GOOD) {
-            UA_print(&id, &UA_TYPES[UA_TYPES_NODEID], &out);
-            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "scan4BaseDataTypes: Could not read \"NodeClassAttribute\" for %.*s. (%s)", (UA_UInt16)out.length, out.data, UA_StatusCode_name(retval));
-            UA_String_clear(&out);
-            continue;
-        }
-        // retrieve node id references
-        retval |= browseNodeId(client, id, &bResp);
-        if (retval != UA_STATUSCODE_GOOD) {
-            UA_print(&id, &UA_TYPES[UA_TYPES_NODEID], &out);
-            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "scan4BaseDataTypes: Could not browse %.*s. (%s)", (UA_UInt16)out.length, out.data, UA_StatusCode_name(retval));
-            UA_String_clear(&out);
-            continue;
-        }
-        // the link between node tree and dictionary is the BrowseName
-        retval = UA_Client_readBrowseNameAttribute(client, id, &browseName);
-        if (retval != UA_STATUSCODE_GOOD) {
-            UA_print(&id, &UA_TYPES[UA_TYPES_NODEID], &out);
-            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "scan4BaseDataTypes: Could not read \"BrowseNameAttribute\" for %.*s. (%s)", (UA_UInt16)out.length, out.data, UA_StatusCode_name(retval));
-            UA_String_clear(&out);
+    entries.resize(customDataTypeIds.size());
+    UA_Int64 traced = traceBegin();
+    forEachShard(clients.size(), entries.size(), [&](size_t worker, size_t begin, size_t end) {
+        traceSetSession(worker);
+        for (size_t i = begin; i < end; i++)
+            readCustomTypeProperties(clients[worker], &customDataTypeIds[i], &entries[i]);
+    });
+    traceEnd(traced, "discovery", "custom type properties", (std::to_string(entries.size()) + " types").c_str());
+    for (size_t i = 1; i < clients.size(); i++) {
+        UA_Client_disconnect(clients[i]);
+        UA_Client_delete(clients[i]);
+    }
+    // save custom data type and context properties to global variables dataTypeMap and dataTypeNameMap
+    // in the order of the scan, so duplicates are resolved independent of the number of sessions
+    traced = traceBegin();
+    for (size_t i = 0; i < entries.size(); i++) {
+        customTypeEntry_t* entry = &entries[i];
+        retval = entry->retval;
+        if (!entry->valid)
             continue;
-        }
-        customTypeProperties_t customTypeProperties;
-        customTypePropertiesInit(&customTypeProperties, &id);
-        csBrowseName = std::string((char*)browseName.name.data, browseName.name.length);
-#ifdef UA_ENABLE_TYPEDESCRIPTION
-        customTypeProperties.dataType.typeName = (char*)UA_malloc(csBrowseName.length() * sizeof(char) + 1);
-        if (customTypeProperties.dataType.typeName)
-            strcpy((char*)customTypeProperties.dataType.typeName, csBrowseName.c_str());
-#endif
-        for (UA_UInt16 i = 0; i < bResp.resultsSize; i++) {
-            // check data type reference first and save type in customTypeProperties
-            for (UA_UInt16 j = 0; j < bResp.results[i].referencesSize; j++) {
-                if (!UA_NodeId_equal(&bResp.results[i].references[j].referenceTypeId, &NS0ID_HASSUBTYPE))
-                    continue;
-                UA_NodeId_copy(&bResp.results[i].references[j].nodeId.nodeId, &customTypeProperties.subTypeOfId);
-                getSubTypeProperties(&customTypeProperties.subTypeOfId, &customTypeProperties);
-            } // end for(UA_UInt16 j = 0; j < bResp.results[i].referencesSize; j++)
-            // check other references
-            for (UA_UInt16 j = 0; j < bResp.results[i].referencesSize; j++) {
-                // check for binary encoding node ID
-                if (UA_NodeId_equal(&bResp.results[i].references[j].referenceTypeId, &NS0ID_HASENCODING))
-                    UA_NodeId_copy(&bResp.results[i].references[j].nodeId.nodeId, &customTypeProperties.dataType.binaryEncodingId);
-                // referenced properties check
-                else if (UA_NodeId_equal(&bResp.results[i].references[j].referenceTypeId, &NS0ID_HASPROPERTY)) {
-                    UA_Variant outValue;
-                    retval = UA_Client_readValueAttribute(client, bResp.results[i].references[j].nodeId.nodeId, &outValue);
-                    // collect structure and enumeration properties of custom data type
-                    if (retval == UA_STATUSCODE_GOOD && !UA_Variant_isScalar(&outValue)) {
-                        if (outValue.type->typeId.identifier.numeric == UA_NS0ID_LOCALIZEDTEXT) {
-                            UA_LocalizedText* data = (UA_LocalizedText*)outValue.data;
-                            UA_StructureDefinition structureDef;
-                            UA_StructureDefinition_init(&structureDef);
-                            structureDef.fieldsSize = outValue.arrayLength;
-                            structureDef.structureType = UA_STRUCTURETYPE_STRUCTURE;
-                            UA_NodeId_copy(&NS0ID_OPTIONSET, &structureDef.baseDataType);
-                            if (customTypeProperties.dataType.typeKind != UA_DATATYPEKIND_ENUM)
-                                structureDef.fields = (UA_StructureField*)malloc(structureDef.fieldsSize * sizeof(UA_StructureField));
-                            for (UA_UInt32 i = 0; i < (UA_UInt32)outValue.arrayLength; i++) {
-                                if (customTypeProperties.dataType.typeKind == UA_DATATYPEKIND_ENUM) {
-                                    UA_EnumValueType enumValue;
-                                    UA_EnumValueType_init(&enumValue);
-                                    enumValue.value = i;
-                                    UA_LocalizedText_copy(&data[i], &enumValue.description);
-                                    UA_LocalizedText_copy(&data[i], &enumValue.displayName);
-                                    customTypeProperties.enumValueSet.push_back(enumValue);
-                                }
-                                else {
-                                    UA_StructureField_init(&structureDef.fields[i]);
-                                    UA_LocalizedText_copy(&data[i], &structureDef.fields[i].description);
-                                    UA_String_copy(&data[i].text, &structureDef.fields[i].name);
-                                    structureDef.fields[i].valueRank = i;
-                                    UA_NodeId_copy(&outValue.type->typeId, &structureDef.fields[i].dataType);
-                                }
-                            }
-                            if (customTypeProperties.dataType.typeKind != UA_DATATYPEKIND_ENUM)
-                                customTypeProperties.structureDefinition.push_back(structureDef);
-                        } // end if(outValue.type->typeId.identifier.numeric == UA_NS0ID_LOCALIZEDTEXT)
-                        else if (outValue.type->typeKind == UA_DATATYPEKIND_EXTENSIONOBJECT) {
-                            if (!UA_Variant_isScalar(&outValue)) {
-                                for (UA_UInt32 i = 0; i < (UA_UInt32)outValue.arrayLength; i++) {
-                                    if (((UA_ExtensionObject*)outValue.data)[i].encoding == UA_EXTENSIONOBJECT_DECODED) {
-                                        const UA_DataType* dataType = ((UA_ExtensionObject*)outValue.data)[i].content.decoded.type;
-                                        UA_ExtensionObject* extObj = &((UA_ExtensionObject*)outValue.data)[i];
-                                        if (extObj->encoding == UA_EXTENSIONOBJECT_DECODED && dataType->typeKind == UA_DATATYPEKIND_STRUCTURE) {// && dataType->typeIndex == UA_TYPES_ENUMVALUETYPE) {
-                                            UA_EnumValueType* enumValue = (UA_EnumValueType*)extObj->content.decoded.data;
-                                            UA_EnumValueType newEnumValue;
-                                            UA_EnumValueType_copy(enumValue, &newEnumValue);
-                                            customTypeProperties.enumValueSet.push_back(newEnumValue);
-                                        }
-                                    }
-                                }
-                            } // if(!UA_Variant_isScalar(&outValue))
-                        } // end else if(outValue.type->typeKind == UA_DATATYPEKIND_EXTENSIONOBJECT)
-                        UA_Variant_clear(&outValue);
-                    } // end if(retval == UA_STATUSCODE_GOOD && !UA_Variant_isScalar(&outValue))
-                } // end else if(UA_NodeId_equal(&bResp.results[i].references[j].referenceTypeId, &NS0ID_HASPROPERTY))
-            } // end for(UA_UInt16 j = 0; j < bResp.results[i].referencesSize; j++)
-        } // end for(UA_UInt16 i = 0; i < bResp.resultsSize; i++)
-        // save custom data type and context properties to global variables dataTypeMap and dataTypeNameMap
+        typeIdHash = UA_NodeId_SDBMHash(&customDataTypeIds[i]);
         if (dataTypeMap.find(typeIdHash) != dataTypeMap.end()) {
-            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "scan4BaseDataTypes: %.*s has a duplicate node ID", (UA_UInt16)browseName.name.length, browseName.name.data);
+            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "scan4BaseDataTypes: %s has a duplicate node ID", entry->browseName.c_str());
         }
         else {
-            dataTypeMap.insert(std::pair<UA_UInt32, customTypeProperties_t>(typeIdHash, customTypeProperties));
-            dataTypeNameMap.insert(std::pair<std::string, customTypeProperties_t*>(csBrowseName, &dataTypeMap[typeIdHash]));
+            dataTypeMap.insert(std::pair<UA_UInt32, customTypeProperties_t>(typeIdHash, entry->customTypeProperties));
+            dataTypeNameMap.insert(std::pair<std::string, customTypeProperties_t*>(entry->browseName, &dataTypeMap[typeIdHash]));
         }
     }
+    traceEnd(traced, "registry", "merge types");
     UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "scan4BaseDataTypes: finished");
     return retval;
 }
@@ -2111,13 +8629,59 @@ void scanForTypeIds(UA_BrowseResponse* bResp, std::vector<UA_NodeId>* dataTypeId
     }
 }
 
-UA_StatusCode scan4Variables(UA_Client* client, UA_NodeId parentNode, std::vector<UA_NodeId>* variableIds) {
+// hash set of node IDs (e.g. to de-duplicate browse results)
+typedef std::unordered_set<UA_NodeId, nodeIdHash, nodeIdEqual> nodeIdSet_t;
+
+// state of scan4Variables, the visited set holds shallow copies of the node IDs owned by variableIds and objectIds
+typedef struct {
+    nodeIdSet_t visited;
+    std::vector<UA_NodeId>* variableIds;
+    std::vector<UA_NodeId> objectIds;
+    size_t maxNodes;
+    UA_Boolean limitReached;
+} scanState_t;
+
+// subfunction of scan4Variables, collects new variables and objects of a browse result
+// objects are added to nextLevel to be browsed with the next level
+static void collectReferences(const UA_BrowseResult* bRes, scanState_t* state, std::vector<UA_NodeId>* nextLevel) {
+    UA_NodeId nodeId;
+    for (size_t i = 0; i < bRes->referencesSize && !state->limitReached; i++) {
+        const UA_ReferenceDescription* reference = &bRes->references[i];
+        // skip nodes of other servers and nodes found on another path
+        if (reference->nodeId.serverIndex || state->visited.count(reference->nodeId.nodeId))
+            continue;
+        UA_NodeId_copy(&reference->nodeId.nodeId, &nodeId);
+        if (reference->nodeClass == UA_NODECLASS_VARIABLE)
+            state->variableIds->push_back(nodeId);
+        else {
+            state->objectIds.push_back(nodeId);
+            nextLevel->push_back(nodeId);
+        }
+        state->visited.insert(nodeId);
+        if (state->maxNodes && state->visited.size() >= state->maxNodes)
+            state->limitReached = true;
+    }
+}
+
+// collects the variables below parentNode (the parent node itself too, if it is a variable)
+// each level of objects is browsed with batched Browse requests (forward hierarchical references to variables and objects only)
+// maxDepth limits the number of browsed levels and maxNodes the number of found nodes (0 = unlimited)
+// the node IDs in variableIds are copies and have to be cleared by the caller
+UA_StatusCode scan4Variables(UA_Client* client, UA_NodeId parentNode, std::vector<UA_NodeId>* variableIds, UA_UInt32 maxDepth, size_t maxNodes) {
     UA_StatusCode retval;
-    std::vector<UA_NodeId> ids; // nodes to visit
-    std::vector<UA_NodeId> subIds; // children IDs
+    std::vector<UA_NodeId> level; // objects to browse
+    std::vector<UA_NodeId> nextLevel; // objects found in this level
+    std::vector<UA_BrowseDescription> browseDescriptions;
+    std::vector<UA_ByteString> continuationPoints;
+    UA_BrowseRequest bReq;
     UA_BrowseResponse bResp;
-    UA_BrowseResult bRes;
-    UA_Variant value;
+    UA_BrowseNextRequest bNextReq;
+    UA_BrowseNextResponse bNextResp;
+    UA_NodeClass nodeClass;
+    UA_NodeId nodeId;
+    scanState_t state;
+    size_t chunkSize;
+    UA_UInt32 depth;
 
     if (!client) {
         UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "scan4Variables: Client session invalid");
@@ -2132,30 +8696,85 @@ UA_StatusCode scan4Variables(UA_Client* client, UA_NodeId parentNode, std::vecto
         return UA_STATUSCODE_BADUNEXPECTEDERROR;
     }
     retval = UA_STATUSCODE_GOOD;
-    if (UA_Client_readValueAttribute(client, parentNode, &value) == UA_STATUSCODE_GOOD)
-        variableIds->push_back(parentNode);
-    ids.push_back(parentNode);
-    while (!ids.empty()) {
-        for (const UA_NodeId& id : ids) {
-            retval |= browseNodeId(client, id, &bResp);
-            if (retval == UA_STATUSCODE_GOOD) {
-                for (size_t i = 0; i < bResp.resultsSize; ++i) {
-                    bRes = bResp.results[i];
-                    for (size_t j = 0; j < bRes.referencesSize; ++j) {
-                        if (bResp.results[i].references[j].nodeClass == UA_NODECLASS_VARIABLE)
-                            variableIds->push_back(bResp.results[i].references[j].nodeId.nodeId);
-                        else if(bResp.results[i].references[j].isForward && bResp.results[i].references[j].nodeClass == UA_NODECLASS_OBJECT)
-                            subIds.push_back(bResp.results[i].references[j].nodeId.nodeId);
+    state.variableIds = variableIds;
+    state.maxNodes = maxNodes;
+    state.limitReached = false;
+    UA_NodeId_copy(&parentNode, &nodeId);
+    if (UA_Client_readNodeClassAttribute(client, parentNode, &nodeClass) == UA_STATUSCODE_GOOD && nodeClass == UA_NODECLASS_VARIABLE)
+        variableIds->push_back(nodeId);
+    else
+        state.objectIds.push_back(nodeId);
+    state.visited.insert(nodeId);
+    level.push_back(nodeId);
+    chunkSize = readOperationLimit(client, UA_NS0ID_SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERBROWSE);
+    if (!chunkSize || chunkSize > UA_BROWSE_MAXCHUNKSIZE)
+        chunkSize = UA_BROWSE_MAXCHUNKSIZE;
+    for (depth = 0; !level.empty() && !state.limitReached && (!maxDepth || depth < maxDepth); depth++) {
+        for (size_t start = 0; start < level.size() && !state.limitReached; start += chunkSize) {
+            const size_t count = std::min(chunkSize, level.size() - start);
+            browseDescriptions.resize(count);
+            for (size_t i = 0; i < count; i++) {
+                // shallow copies of the node IDs, the request is not cleared
+                UA_BrowseDescription_init(&browseDescriptions[i]);
+                browseDescriptions[i].nodeId = level[start + i];
+                browseDescriptions[i].browseDirection = UA_BROWSEDIRECTION_FORWARD;
+                browseDescriptions[i].referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+                browseDescriptions[i].includeSubtypes = true;
+                browseDescriptions[i].nodeClassMask = UA_NODECLASS_OBJECT | UA_NODECLASS_VARIABLE;
+                browseDescriptions[i].resultMask = UA_BROWSERESULTMASK_NODECLASS;
+            }
+            UA_BrowseRequest_init(&bReq);
+            bReq.requestedMaxReferencesPerNode = 0;
+            bReq.nodesToBrowse = browseDescriptions.data();
+            bReq.nodesToBrowseSize = count;
+            UA_UInt64 started = metricsStart();
+            bResp = UA_Client_Service_browse(client, bReq);
+            metricsRecordResponse(UA_HISTOGRAM_BROWSE, started, &bResp, &UA_TYPES[UA_TYPES_BROWSERESPONSE]);
+            retval |= bResp.responseHeader.serviceResult;
+            for (size_t i = 0; i < bResp.resultsSize; i++) {
+                collectReferences(&bResp.results[i], &state, &nextLevel);
+                if (bResp.results[i].continuationPoint.length) {
+                    continuationPoints.push_back(bResp.results[i].continuationPoint);
+                    UA_ByteString_init(&bResp.results[i].continuationPoint);
+                }
+            }
+            UA_BrowseResponse_clear(&bResp);
+            // fetch the remaining references, continuation points are released if the node limit is reached
+            while (!continuationPoints.empty()) {
+                UA_BrowseNextRequest_init(&bNextReq);
+                bNextReq.releaseContinuationPoints = state.limitReached;
+                bNextReq.continuationPoints = continuationPoints.data();
+                bNextReq.continuationPointsSize = continuationPoints.size();
+                started = metricsStart();
+                bNextResp = UA_Client_Service_browseNext(client, bNextReq);
+                metricsRecordResponse(UA_HISTOGRAM_BROWSE, started, &bNextResp, &UA_TYPES[UA_TYPES_BROWSENEXTRESPONSE]);
+                for (UA_ByteString& continuationPoint : continuationPoints)
+                    UA_ByteString_clear(&continuationPoint);
+                continuationPoints.clear();
+                retval |= bNextResp.responseHeader.serviceResult;
+                for (size_t i = 0; i < bNextResp.resultsSize && !bNextReq.releaseContinuationPoints; i++) {
+                    collectReferences(&bNextResp.results[i], &state, &nextLevel);
+                    if (bNextResp.results[i].continuationPoint.length) {
+                        continuationPoints.push_back(bNextResp.results[i].continuationPoint);
+                        UA_ByteString_init(&bNextResp.results[i].continuationPoint);
                     }
                 }
+                UA_BrowseNextResponse_clear(&bNextResp);
             }
         }
-        ids.swap(subIds);
-        subIds.clear();
-    }
+        level.swap(nextLevel);
+        nextLevel.clear();
+    }
+    if (state.limitReached)
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "scan4Variables: node limit of %u reached, scan is incomplete", (UA_UInt32)maxNodes);
+    // the object IDs are not returned
+    for (UA_NodeId& objectId : state.objectIds)
+        UA_NodeId_clear(&objectId);
     return retval;
 }
 
+// example program, EXTENDEDOBJECT_NO_MAIN disables it if the module is included into another program (see ExtendedObjectBenchmark.cpp)
+#ifndef EXTENDEDOBJECT_NO_MAIN
 int main(int argc, char* argv[]) {
     /*
     // local Unified Automation Demo server
@@ -2177,8 +8796,7 @@ int main(int argc, char* argv[]) {
     UA_Client* client;
     UA_NodeId nodeId;
     UA_StatusCode retval;
-    UA_String out;
-    UA_Variant outValue;
+    UA_OutputSink sink;
     std::vector<UA_NodeId> variableIds;
 
     if (argc > 1) uaUrl = argv[1];
@@ -2196,6 +8814,7 @@ int main(int argc, char* argv[]) {
 
     /*
     // print dictionaries of the OPC UA server
+    UA_String out;
     retval = UA_PrintDictionaries(client, &out);
     if (retval == UA_STATUSCODE_GOOD) {
         printf("%.*s\n", (UA_UInt16)out.length, out.data);
@@ -2205,12 +8824,16 @@ int main(int argc, char* argv[]) {
     */
 
     // initialization of the custom data type
+    // timeline of the initialization for chrome://tracing or ui.perfetto.dev: UA_Trace_start("ExtendedObject.trace.json") before and UA_Trace_stop() after
     retval = initializeCustomDataTypes(client);
     if (retval != UA_STATUSCODE_GOOD)
         UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Could not initialize custom data types. (%s)", UA_StatusCode_name(retval));
+    // other processes of the host can share the registry: UA_RegistryImage_write("ExtendedObject.registry") here and
+    // UA_RegistryImage_load(client, "ExtendedObject.registry") instead of initializeCustomDataTypes in the other processes
 
     /*
     // print custom data type map
+    UA_String out;
     retval = UA_PrintCustomDataTypeMap(&out);
     if (retval == UA_STATUSCODE_GOOD) {
         printf("%.*s\n", (UA_UInt16)out.length, out.data);
@@ -2231,52 +8854,50 @@ int main(int argc, char* argv[]) {
         UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Could not retrieve variable node IDs from parent ID %s. (%s)", parentId, UA_StatusCode_name(retval));
     }
 
-    for (UA_NodeId nodeId : variableIds) {
-        // print node ID
-        UA_print(&nodeId, &UA_TYPES[UA_TYPES_NODEID], &out);
-        printf("%.*s\n", (UA_UInt16)out.length, out.data);
-        fflush(stdout);
-        UA_String_clear(&out);
+    /*
+    // record the responses for an offline replay without server, e.g. UA_Replay("ExtendedObject.rec", UA_PRINTFORMAT_TEXT, &sink, 0x0)
+    UA_Recorder recorder;
+    UA_Recorder_open(&recorder, "ExtendedObject.rec");
+    */
 
-        // read value of OPC UA variable
-        retval = UA_Client_readValueAttribute(client, nodeId, &outValue);
-        if (retval != UA_STATUSCODE_GOOD) {
-            UA_print(&nodeId, &UA_TYPES[UA_TYPES_NODEID], &out);
-            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Could not read %.*s (%s)", (UA_UInt16)out.length, out.data, UA_StatusCode_name(retval));
-            UA_String_clear(&out);
-            UA_NodeId_clear(&nodeId);
-            UA_Client_disconnect(client);
-            UA_Client_delete(client);
-            client = UA_Client_new();
-            UA_ClientConfig_setDefault(UA_Client_getConfig(client));
-            retval = UA_Client_connect(client, uaUrl);
-            if (retval == UA_STATUSCODE_GOOD) {
-                UA_Client_getConfig(client)->customDataTypes = customDataTypes;
-            }
-            else {
-                UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Could not reconnect to %s", uaUrl);
-            }
-            continue;
+    // read and print the values of all variables with batched read requests
+    UA_OutputSink_init(&sink, UA_OutputSink_writeFile, stdout);
+    retval = UA_ReadAndPrintValues(client, variableIds.data(), variableIds.size(), UA_PRINTFORMAT_TEXT, &sink);
+    UA_OutputSink_flush(&sink);
+    fflush(stdout);
+    if (retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Could not read values of %s. (%s)", parentId, UA_StatusCode_name(retval));
+        // the session may be broken: reconnect and read the values once more
+        UA_Client_disconnect(client);
+        UA_Client_delete(client);
+        client = UA_Client_new();
+        UA_ClientConfig_setDefault(UA_Client_getConfig(client));
+        retval = UA_Client_connect(client, uaUrl);
+        if (retval == UA_STATUSCODE_GOOD) {
+            UA_Client_getConfig(client)->customDataTypes = customDataTypes;
+            retval = UA_ReadAndPrintValues(client, variableIds.data(), variableIds.size(), UA_PRINTFORMAT_TEXT, &sink);
+            UA_OutputSink_flush(&sink);
+            fflush(stdout);
+            if (retval != UA_STATUSCODE_GOOD)
+                UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Could not read values of %s. (%s)", parentId, UA_StatusCode_name(retval));
         }
-        // print value of OPC UA variable
-        retval = UA_PrintValue(client, nodeId, &outValue, &out);
-        if (retval != UA_STATUSCODE_GOOD) {
-            UA_print(&nodeId, &UA_TYPES[UA_TYPES_NODEID], &out);
-            UA_LOG_WARNING(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Could not print data of %.*s (%s)", (UA_UInt16)out.length, out.data, UA_StatusCode_name(retval));
-            UA_String_clear(&out);
-            UA_Variant_clear(&outValue);
-            UA_NodeId_clear(&nodeId);
-            continue;
+        else {
+            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Could not reconnect to %s", uaUrl);
         }
-        printf("%.*s\n", (UA_UInt16)out.length, out.data);
-        fflush(stdout);
-        UA_String_clear(&out);
-        UA_Variant_clear(&outValue);
-        UA_NodeId_clear(&nodeId);
     }
-    
+    /*
+    // latencies and counters of the session (UA_Metrics_enable(true) before initializeCustomDataTypes)
+    UA_Metrics_writePrometheusFile("ExtendedObject.prom");
+    // costs per type and member path (UA_Profiler_enable(true) before printing), e.g. flamegraph.pl ExtendedObject.folded > profile.svg
+    UA_Profiler_writeFiles("ExtendedObject.profile", "ExtendedObject.folded");
+    */
+    for (UA_NodeId& variableId : variableIds)
+        UA_NodeId_clear(&variableId);
+    //UA_Recorder_close(&recorder);
+
     // close OPC UA session
     UA_Client_disconnect(client);
     UA_Client_delete(client);
     return EXIT_SUCCESS;
 }
+#endif // EXTENDEDOBJECT_NO_MAIN
@@ -9,12 +9,384 @@ typedef struct {
 	// If you change this structure, DO NOT forget to also change customTypePropertiesInit()!
 	UA_DataType dataType;
 	UA_NodeId subTypeOfId;
-	std::vector<UA_EnumValueType> enumValueSet;
-	std::vector<UA_StructureDefinition> structureDefinition;
+	UA_UInt32 enumValuesIndex; // first value of the enumeration in registryEnumValues and registryEnumNames
+	UA_UInt32 enumValuesSize;
+	UA_UInt32 optionBitsIndex; // name of bit 0 of the option set in registryOptionBits
+	UA_UInt32 optionBitsSize;
+	UA_Boolean isMapped; // members and node IDs belong to the registry image (see UA_RegistryImage_load)
 } customTypeProperties_t;
 typedef std::map<std::string, customTypeProperties_t*>::iterator nameTypePropIt_t;
 typedef std::map<const UA_UInt32, customTypeProperties_t>::iterator typePropIt_t;
 
+// hash and equality of node IDs for unordered containers keyed by node ID (e.g. to de-duplicate browse results)
+UA_UInt32 UA_NodeId_SDBMHash(const UA_NodeId* n);
+struct nodeIdHash {
+	size_t operator()(const UA_NodeId& nodeId) const { return UA_NodeId_SDBMHash(&nodeId); }
+};
+struct nodeIdEqual {
+	bool operator()(const UA_NodeId& n1, const UA_NodeId& n2) const { return UA_NodeId_equal(&n1, &n2); }
+};
+
+// cached data type attribute of a variable (enumerations are transferred as Int32), key and value are copies owned by the cache
+typedef std::unordered_map<UA_NodeId, UA_NodeId, nodeIdHash, nodeIdEqual>::iterator dataTypeIdCacheIt_t;
+
+// streaming output (e.g. JSON) is collected in a fixed size buffer and passed in blocks to the callback
+#define UA_OUTPUTSINK_BUFFERSIZE 4096
+typedef UA_StatusCode(*UA_OutputSinkCallback)(void* sinkContext, const UA_Byte* data, size_t length);
+typedef struct {
+	UA_OutputSinkCallback callback;
+	void* sinkContext;
+	size_t length;
+	UA_Byte buffer[UA_OUTPUTSINK_BUFFERSIZE];
+} UA_OutputSink;
+
+// column of a scalar leaf field of custom structures (columnar export)
+// fixed width values are stored contiguously (booleans bit-packed), strings as offsets and values
+typedef struct {
+	std::string name; // member path, e.g. "Motor.Status.Speed"
+	const UA_DataType* type;
+	size_t offset; // offset of the field in the structure
+	size_t nullCount;
+	std::vector<UA_Byte> values;
+	std::vector<UA_Int32> offsets;
+	std::vector<UA_Byte> validity; // empty if all values are valid
+} UA_Column;
+typedef struct {
+	const UA_DataType* type;
+	size_t length; // number of rows (structures)
+	std::vector<UA_Column> columns;
+} UA_ColumnBatch;
+
+// output format of UA_ReadAndPrintValues
+typedef enum {
+	UA_PRINTFORMAT_TEXT,
+	UA_PRINTFORMAT_JSON
+} UA_PrintFormat;
+
+// change detection, deadband of a numeric field
+// field is the member path of a scalar leaf field of custom structures (as UA_Column.name, e.g. "Motor.Status.Speed")
+// or "" for values of numeric built-in types
+typedef struct {
+	UA_NodeId nodeId; // UA_NODEID_NULL = all nodes
+	std::string field;
+	UA_Double absolute; // minimum absolute change (0 = off)
+	UA_Double percent; // minimum change in percent of the last reported value (0 = off)
+} UA_Deadband;
+typedef struct {
+	size_t offset; // offset of the field in the structure
+	const UA_DataType* type;
+	size_t deadband; // index in UA_ChangeFilter.deadbands
+} UA_DeadbandLeaf;
+// last reported value of a node
+typedef struct {
+	UA_Boolean resolved; // deadband fields are resolved for type
+	const UA_DataType* type;
+	std::vector<UA_DeadbandLeaf> leaves;
+	std::vector<size_t> skipOffsets; // sorted offsets of the deadband fields, they are not part of the hash
+	UA_UInt64 hash; // hash of status code and value without the deadband fields
+	std::vector<UA_Double> leafValues; // last reported values of the deadband fields (for each array element)
+} UA_LastValue;
+typedef struct {
+	std::vector<UA_Deadband> deadbands;
+	std::unordered_map<UA_NodeId, UA_LastValue, nodeIdHash, nodeIdEqual> lastValues; // key: copy of the node ID owned by the filter
+	UA_UInt64 changed; // reported values
+	UA_UInt64 unchanged; // skipped values
+} UA_ChangeFilter;
+typedef std::unordered_map<UA_NodeId, UA_LastValue, nodeIdHash, nodeIdEqual>::iterator lastValueIt_t;
+
+// compiled path to a field of decoded custom structures (see UA_FieldPath_compile)
+typedef enum {
+	UA_FIELDSTEP_OFFSET, // field at offset
+	UA_FIELDSTEP_POINTER, // optional field, pointer at offset
+	UA_FIELDSTEP_ARRAY, // element index of the array at offset (length and pointer)
+	UA_FIELDSTEP_UNION // union member at offset, selected if the switch field is index
+} UA_FieldStepKind;
+typedef struct {
+	UA_FieldStepKind kind;
+	size_t offset;
+	size_t index;
+	size_t elementSize; // size of the array elements
+} UA_FieldStep;
+typedef struct {
+	const UA_DataType* rootType; // type of the values (variant)
+	const UA_DataType* type; // type of the field
+	std::vector<UA_FieldStep> steps;
+} UA_FieldPath;
+
+// compiled path to a field in the binary encoded body of an ExtensionObject (see UA_EncodedFieldPath_compile)
+typedef enum {
+	UA_ENCODEDSTEP_SKIP, // skip size bytes (fixed size members)
+	UA_ENCODEDSTEP_SKIPVALUE, // skip a value or array of variable size
+	UA_ENCODEDSTEP_MASK, // read the encoding mask of a structure with optional fields
+	UA_ENCODEDSTEP_SKIPOPTIONAL, // skip an optional value or array if bit index of the encoding mask is set
+	UA_ENCODEDSTEP_OPTIONAL, // optional field of the path, bit index of the encoding mask has to be set
+	UA_ENCODEDSTEP_ARRAY, // element index of an array
+	UA_ENCODEDSTEP_UNION // union member, the switch field has to be index
+} UA_EncodedStepKind;
+typedef struct {
+	UA_EncodedStepKind kind;
+	size_t size; // encoded size of fixed size values (0 = variable size)
+	const UA_DataType* type;
+	UA_Boolean isArray;
+	size_t index;
+} UA_EncodedStep;
+typedef struct {
+	const UA_DataType* rootType; // type of the encoded body
+	const UA_DataType* type; // type of the field
+	std::vector<UA_EncodedStep> steps;
+} UA_EncodedFieldPath;
+
+// binding of native C++ structures to custom data types (see UA_bind)
+#define UA_BIND_ANYTYPE 0xFFFFFFFF // type of the member is not checked, only its size (e.g. nested custom structures)
+typedef struct {
+	const char* name; // member name of the custom data type
+	size_t offset; // offset of the field in the native structure
+	size_t size; // size of the field in the native structure (arrays: length and pointer)
+	UA_UInt32 typeIndex; // index in UA_TYPES or UA_BIND_ANYTYPE
+	UA_Boolean isArray;
+} UA_BindField;
+typedef struct {
+	size_t nativeOffset;
+	size_t memberOffset; // offset in the decoded structure
+	size_t size; // bytes to copy (pointer free members), 0 = deep copy of memberType
+	const UA_DataType* memberType;
+	UA_Boolean isArray;
+} UA_BindConversion;
+typedef struct {
+	const UA_DataType* type;
+	size_t nativeSize;
+	UA_Boolean zeroCopy; // the native structure has the memory layout of the decoded structure
+	std::vector<UA_BindConversion> conversions; // compiled conversion of the bound fields
+} UA_Binding;
+
+// field description of a native structure, e.g.
+//   UA_BIND_BEGIN(Motor)
+//       UA_BIND_FIELD(speed, "Speed", UA_TYPES_DOUBLE),
+//       UA_BIND_ARRAY(axisSize, "Axis", UA_TYPES_FLOAT) // size_t axisSize; UA_Float* axis;
+//   UA_BIND_END()
+template <typename T> struct UA_BindTraits;
+#define UA_BIND_BEGIN(STRUCT) \
+	template <> struct UA_BindTraits<STRUCT> { \
+		typedef STRUCT type; \
+		static const UA_BindField* fields(size_t* fieldsSize) { \
+			static const UA_BindField bindFields[] = {
+#define UA_BIND_FIELD(FIELD, NAME, TYPEINDEX) { NAME, offsetof(type, FIELD), sizeof(((type*)0x0)->FIELD), TYPEINDEX, false }
+#define UA_BIND_ARRAY(LENGTHFIELD, NAME, TYPEINDEX) { NAME, offsetof(type, LENGTHFIELD), sizeof(size_t) + sizeof(void*), TYPEINDEX, true }
+#define UA_BIND_END() \
+			}; \
+			*fieldsSize = sizeof(bindFields) / sizeof(bindFields[0]); \
+			return bindFields; \
+		} \
+	};
+
+// batched reading of values, the callback is called once per node and may take over the content of value
+// dataTypeId is 0x0 if the data type attribute could not be read
+#define UA_READVALUES_MAXCHUNKSIZE 1000
+typedef UA_StatusCode(*UA_ReadValuesCallback)(void* context, const UA_NodeId* nodeId, const UA_NodeId* dataTypeId, UA_DataValue* value);
+
+// batched writing of values, one status code per node (see UA_WriteValues)
+#define UA_WRITEVALUES_MAXCHUNKSIZE 1000
+
+// pre-encoded value of a custom data type for repeated writes, fixed size fields are patched into the encoded body
+typedef struct {
+	size_t position; // position of the field in the encoded body
+	const UA_DataType* type; // type of the field (fixed encoded size)
+} UA_TemplateField;
+typedef struct {
+	const UA_DataType* type;
+	UA_ExtensionObject encoded;
+	std::vector<UA_TemplateField> fields;
+} UA_WriteTemplate;
+
+// monitoring of many variables with one subscription
+// all values received within one UA_Monitor_iterate call are passed as one batch to the callback
+#define UA_MONITOR_MAXCHUNKSIZE 1000
+typedef struct {
+	const UA_NodeId* nodeId;
+	const UA_NodeId* dataTypeId; // 0x0 if unknown
+	UA_DataValue value;
+} UA_MonitoredValue;
+typedef UA_StatusCode(*UA_MonitorCallback)(void* context, UA_MonitoredValue* values, size_t valuesSize);
+typedef struct {
+	UA_NodeId nodeId;
+	UA_NodeId dataTypeId;
+	UA_UInt32 monitoredItemId;
+	UA_StatusCode statusCode; // result of the creation
+} UA_MonitorItem;
+typedef struct {
+	UA_Client* client;
+	UA_UInt32 subscriptionId;
+	UA_MonitorCallback callback;
+	void* context;
+	std::vector<UA_MonitorItem> items;
+	std::vector<UA_MonitoredValue> values; // values received in the current iteration
+} UA_Monitor;
+
+// client-side polling with a timer wheel, nodes due in the same tick are read with one batched read
+#define UA_POLLER_WHEELSIZE 256
+typedef struct {
+	UA_NodeId nodeId;
+	UA_UInt64 intervalTicks;
+	UA_UInt64 dueTick;
+} UA_PollItem;
+typedef struct {
+	size_t item; // index in UA_Poller::items
+	UA_UInt64 dueTick;
+} UA_PollEntry;
+typedef struct {
+	UA_Client* client;
+	UA_UInt32 tickInterval; // ms
+	UA_ReadValuesCallback callback;
+	void* context;
+	size_t chunkSize; // read value IDs per ReadRequest (two per node, see readValuesChunked)
+	UA_DateTime startTime;
+	UA_UInt64 currentTick;
+	std::vector<UA_PollItem> items;
+	std::vector<std::vector<UA_PollEntry>> wheel;
+	std::vector<UA_NodeId> dueNodeIds;
+	// statistics
+	UA_UInt64 reads; // batched reads
+	UA_UInt64 lateTicks; // ticks processed late (iterate called too seldom)
+	UA_UInt64 overruns; // reads lasting longer than a tick
+	UA_UInt64 skippedSamples; // samples skipped because of overruns (backpressure)
+	UA_DateTime lastReadDuration; // ms
+} UA_Poller;
+
+// reconnect manager, restores the connection with exponential backoff and reattaches the custom data types
+// if the type model fingerprint (NamespaceArray and BuildInfo) of the server is unchanged
+typedef UA_Client* (*UA_ClientFactory)(void* factoryContext); // creates a configured, not connected client
+typedef struct {
+	std::vector<UA_NodeId> nodeIds;
+	UA_ReadValuesCallback callback;
+	void* context;
+} UA_QueuedRead;
+typedef struct {
+	UA_Client* client;
+	std::string endpointUrl;
+	UA_ClientFactory factory;
+	void* factoryContext;
+	UA_Boolean connected;
+	UA_UInt32 fingerprint;
+	UA_UInt32 initialDelay; // ms
+	UA_UInt32 maxDelay; // ms
+	UA_UInt32 delay; // current delay between reconnection attempts
+	UA_DateTime nextAttempt;
+	UA_UInt32 attempts;
+	std::deque<UA_QueuedRead> queue; // reads waiting for the reconnection
+} UA_ReconnectManager;
+
+// pool of sessions to the same server reading shards of a node list in parallel threads
+typedef struct {
+	std::vector<UA_Client*> clients;
+	size_t chunkSize; // read value IDs per ReadRequest (two per node, see readValuesChunked)
+} UA_ReaderPool;
+
+// parallel type discovery of initializeCustomDataTypes, the data type tree is split across additional short-lived sessions
+typedef struct {
+	const char* endpointUrl; // server of the client passed to initializeCustomDataTypes
+	size_t sessions; // number of additional sessions (0 = scan with the session of the client only)
+	UA_ClientFactory factory; // 0x0 = UA_ClientFactory_default
+	void* factoryContext;
+} UA_DiscoveryConfig;
+
+// maximum number of nodes per Browse request of scan4Variables (if the server has no lower limit)
+#define UA_BROWSE_MAXCHUNKSIZE 1000
+
+// recording of ReadResponse and PublishResponse bodies with the custom data type registry for offline decoding and printing (see UA_Replay)
+// file: magic, records of kind (UInt32), length of the payload (UInt32), time stamp (DateTime) and payload (UA binary encoded)
+#define UA_RECORDER_MAGIC "UAREC001"
+typedef enum {
+	UA_RECORDKIND_REGISTRY = 1, // custom data type registry, replaces the registry on replay
+	UA_RECORDKIND_READRESPONSE = 2, // node IDs and ReadResponse of UA_ReadValues (value and data type attribute per node)
+	UA_RECORDKIND_PUBLISHRESPONSE = 3 // node IDs, data type IDs and PublishResponse of UA_Monitor_iterate (client handle = index of the node ID)
+} UA_RecordKind;
+typedef struct {
+	FILE* file;
+	UA_UInt64 records;
+	UA_UInt64 bytes; // written bytes
+} UA_Recorder;
+typedef struct {
+	UA_UInt64 records; // response records
+	UA_UInt64 values;
+	UA_UInt64 bytes; // size of the response records
+	UA_UInt64 decodeTime; // ns
+	UA_UInt64 printTime; // ns
+} UA_ReplayStatistics;
+
+// instrumentation of discovery, reads and printing (see UA_Metrics_enable)
+// latency histograms with logarithmic buckets (HDR style, 8 sub-buckets per power of two, values in ns)
+#define UA_HISTOGRAM_SUBBUCKETS 8
+#define UA_HISTOGRAM_BUCKETS 496
+typedef enum {
+	UA_HISTOGRAM_BROWSE, // Browse and BrowseNext round trips
+	UA_HISTOGRAM_READ, // Read round trips (batched reads and attribute reads)
+	UA_HISTOGRAM_PARSEXML, // parsing of the dictionaries
+	UA_HISTOGRAM_DECODE, // decoding of recorded responses (UA_Replay), the client decodes within the read round trip
+	UA_HISTOGRAM_PRINTSTRUCTURE, // printing of values (text and JSON) per type kind
+	UA_HISTOGRAM_PRINTENUM,
+	UA_HISTOGRAM_PRINTUNION,
+	UA_HISTOGRAM_PRINTOTHER,
+	UA_HISTOGRAM_COUNT
+} UA_HistogramId;
+typedef enum {
+	UA_COUNTER_BYTESRECEIVED, // encoded size of the Browse and Read responses (attribute reads are not counted)
+	UA_COUNTER_PRINTALLOCATIONS, // output blocks allocated by print contexts
+	UA_COUNTER_CACHEHITS, // data type cache of UA_PrintValue and UA_PrintValueJson
+	UA_COUNTER_CACHEMISSES,
+	UA_COUNTER_COUNT
+} UA_CounterId;
+typedef struct {
+	UA_UInt64 counters[UA_COUNTER_COUNT];
+	UA_UInt64 histogramSums[UA_HISTOGRAM_COUNT]; // ns
+	UA_UInt64 histograms[UA_HISTOGRAM_COUNT][UA_HISTOGRAM_BUCKETS];
+	UA_UInt64 typesResolved; // custom data types of the last initializeCustomDataTypes with resolved members
+	UA_UInt64 typesUnresolved;
+} UA_MetricsSnapshot;
+
+// cost of a type or a member path of the printing walk (see UA_Profiler_enable)
+// path: collapsed stack of type, member and array frames, e.g. "Motor;Status;Axis[]"
+typedef struct {
+	std::string path;
+	std::string typeName; // type of the frame, recorded with the first call (empty = array member, see the array frame)
+	UA_UInt64 calls;
+	UA_UInt64 printTime; // ns including the child frames
+	UA_UInt64 selfTime; // ns without the child frames
+	UA_UInt64 decodeTime; // ns, share of the decoded responses by encoded size (UA_Replay)
+	UA_UInt64 bytes; // encoded size
+	UA_UInt64 allocations; // output blocks of the print context including the child frames
+} UA_ProfileEntry;
+
+// Apache Arrow C data interface (https://arrow.apache.org/docs/format/CDataInterface.html)
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+struct ArrowSchema {
+	const char* format;
+	const char* name;
+	const char* metadata;
+	int64_t flags;
+	int64_t n_children;
+	struct ArrowSchema** children;
+	struct ArrowSchema* dictionary;
+	void (*release)(struct ArrowSchema*);
+	void* private_data;
+};
+struct ArrowArray {
+	int64_t length;
+	int64_t null_count;
+	int64_t offset;
+	int64_t n_buffers;
+	int64_t n_children;
+	const void** buffers;
+	struct ArrowArray** children;
+	struct ArrowArray* dictionary;
+	void (*release)(struct ArrowArray*);
+	void* private_data;
+};
+#endif
+
 static const UA_NodeId NS0ID_BASEDATATYPE = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATATYPE);
 static const UA_NodeId NS0ID_BYTESTRING = UA_NODEID_NUMERIC(0, UA_NS0ID_BYTESTRING);
 static const UA_NodeId NS0ID_ENUMDEFINITION_ENCODING_DEFAULTBINARY = UA_NODEID_NUMERIC(0, UA_NS0ID_ENUMDEFINITION_ENCODING_DEFAULTBINARY);
@@ -29,16 +401,125 @@ static const UA_NodeId NS0ID_UNION = UA_NODEID_NUMERIC(0, UA_NS0ID_UNION);
 
 static std::map<std::string, customTypeProperties_t*> dataTypeNameMap;
 static std::map<UA_UInt32, customTypeProperties_t> dataTypeMap;
+// enumeration and option set tables of all custom data types, each type refers to a contiguous range
+// names are indexes of the interned registry strings (see registryString)
+static std::vector<UA_Int64> registryEnumValues;
+static std::vector<UA_UInt32> registryEnumNames;
+static std::vector<UA_UInt32> registryOptionBits;
+static std::unordered_map<UA_NodeId, UA_NodeId, nodeIdHash, nodeIdEqual> dataTypeIdCache;
+static std::mutex dataTypeIdCacheMutex; // readers of UA_ReaderPool fill the cache concurrently
 static UA_DataTypeArray* customDataTypes;
+void clearCustomDataTypes(void);
 UA_StatusCode getDictionaries(UA_Client* client, std::map<UA_UInt32, std::string>* dictionaries);
-UA_StatusCode initializeCustomDataTypes(UA_Client* client);
+UA_StatusCode initializeCustomDataTypes(UA_Client* client, const UA_DiscoveryConfig* discoveryConfig = 0x0);
+UA_StatusCode UA_ChangeFilter_addDeadband(UA_ChangeFilter* filter, const UA_NodeId* nodeId, const char* field, UA_Double absolute, UA_Double percent);
+UA_Boolean UA_ChangeFilter_check(UA_ChangeFilter* filter, const UA_NodeId* nodeId, const UA_DataValue* value);
+void UA_ChangeFilter_clear(UA_ChangeFilter* filter);
+void UA_ChangeFilter_init(UA_ChangeFilter* filter);
+void UA_Binding_clearValue(const UA_Binding* binding, void* value);
+UA_StatusCode UA_Binding_copyValue(const UA_Binding* binding, const UA_Variant* data, size_t index, void* value);
+UA_StatusCode UA_Binding_init(UA_Binding* binding, const UA_NodeId* typeId, const UA_BindField* fields, size_t fieldsSize, size_t nativeSize);
+UA_Client* UA_ClientFactory_default(void* factoryContext);
+UA_StatusCode UA_ColumnBatch_exportArrow(UA_ColumnBatch* batch, struct ArrowSchema* schema, struct ArrowArray* array);
+UA_StatusCode UA_ColumnBatch_fromVariant(const UA_Variant* data, UA_ColumnBatch* batch);
+UA_StatusCode UA_ColumnBatch_writeCsv(const UA_ColumnBatch* batch, UA_OutputSink* sink, UA_Boolean withHeader);
+void UA_DataTypeCache_invalidate(const UA_NodeId* nodeId);
+UA_StatusCode UA_DataTypeCache_prefill(UA_Client* client, const UA_NodeId* nodeIds, size_t nodeIdsSize);
+UA_StatusCode UA_Poller_add(UA_Poller* poller, const UA_NodeId* nodeId, UA_UInt32 samplingInterval);
+void UA_Poller_clear(UA_Poller* poller);
+UA_StatusCode UA_Poller_init(UA_Poller* poller, UA_Client* client, UA_UInt32 tickInterval, UA_ReadValuesCallback callback, void* context);
+UA_StatusCode UA_Poller_iterate(UA_Poller* poller, UA_UInt32 timeout);
 UA_StatusCode UA_PrintCustomDataTypeMap(UA_String* output);
 UA_StatusCode UA_PrintDataType(const UA_DataType* dataType, UA_String* output);
 UA_StatusCode UA_PrintDataTypeMember(UA_DataTypeMember* dataTypeMember, UA_String* output);
 UA_StatusCode UA_PrintDictionaries(UA_Client* client, UA_String* output);
+UA_StatusCode UA_EncodeValue(const void* p, const UA_DataType* type, UA_ExtensionObject* extensionObject);
+UA_StatusCode UA_EncodedFieldPath_compile(const UA_DataType* type, const char* path, UA_EncodedFieldPath* encodedFieldPath);
+UA_StatusCode UA_EncodedFieldPath_get(const UA_EncodedFieldPath* encodedFieldPath, const UA_ExtensionObject* extensionObject, const UA_Byte** field);
+UA_StatusCode UA_EncodedFieldPath_getDouble(const UA_EncodedFieldPath* encodedFieldPath, const UA_ExtensionObject* extensionObject, UA_Double* value);
+UA_StatusCode UA_EncodedFieldPath_getString(const UA_EncodedFieldPath* encodedFieldPath, const UA_ExtensionObject* extensionObject, UA_String* value);
+UA_StatusCode UA_FieldPath_compile(const UA_DataType* type, const char* path, UA_FieldPath* fieldPath);
+UA_StatusCode UA_FieldPath_get(const UA_FieldPath* fieldPath, const UA_Variant* data, size_t index, const void** field);
+UA_StatusCode UA_FieldPath_getDouble(const UA_FieldPath* fieldPath, const UA_Variant* data, size_t index, UA_Double* value);
+void UA_Metrics_enable(UA_Boolean enabled);
+UA_UInt64 UA_Metrics_percentile(const UA_MetricsSnapshot* snapshot, UA_HistogramId histogram, UA_Double percentile);
+void UA_Metrics_reset(void);
+UA_StatusCode UA_Metrics_snapshot(UA_MetricsSnapshot* snapshot);
+UA_StatusCode UA_Metrics_writePrometheus(UA_OutputSink* sink);
+UA_StatusCode UA_Metrics_writePrometheusFile(const char* fileName);
+UA_StatusCode UA_Monitor_create(UA_Client* client, const UA_NodeId* nodeIds, size_t nodeIdsSize, UA_Double samplingInterval, UA_Double publishingInterval,
+                                UA_MonitorCallback callback, void* context, UA_Monitor* monitor);
+UA_StatusCode UA_Monitor_delete(UA_Monitor* monitor);
+UA_StatusCode UA_Monitor_iterate(UA_Monitor* monitor, UA_UInt32 timeout);
+UA_StatusCode UA_OptionSet_setBit(void* p, const UA_DataType* type, const char* name, UA_Boolean isSet);
+UA_StatusCode UA_OutputSink_flush(UA_OutputSink* sink);
+void UA_OutputSink_init(UA_OutputSink* sink, UA_OutputSinkCallback callback, void* sinkContext);
+UA_StatusCode UA_OutputSink_write(UA_OutputSink* sink, const void* data, size_t length);
+UA_StatusCode UA_OutputSink_writeFile(void* sinkContext, const UA_Byte* data, size_t length);
 UA_StatusCode UA_PrintEnum(const UA_Variant* data, customTypeProperties_t* customTypeProperties, UA_String* output);
+UA_StatusCode UA_PrintJson(const void* p, const UA_DataType* type, UA_OutputSink* sink);
 UA_StatusCode UA_PrintStructure(const UA_Variant* data, UA_String* output);
+UA_StatusCode UA_PrintStructureToSink(const UA_Variant* data, UA_OutputSink* sink);
 UA_StatusCode UA_PrintUnion(const UA_Variant* data, UA_String* output);
+UA_StatusCode UA_PrintUnionToSink(const UA_Variant* data, UA_OutputSink* sink);
 UA_StatusCode UA_PrintValue(UA_Client* client, UA_NodeId nodeId, UA_Variant* data, UA_String* output);
+UA_StatusCode UA_PrintValueJson(UA_Client* client, UA_NodeId nodeId, UA_Variant* data, UA_OutputSink* sink);
+void UA_Profiler_enable(UA_Boolean enabled);
+void UA_Profiler_reset(void);
+UA_StatusCode UA_Profiler_snapshot(std::vector<UA_ProfileEntry>* entries);
+UA_StatusCode UA_Profiler_writeCollapsed(UA_OutputSink* sink);
+UA_StatusCode UA_Profiler_writeFiles(const char* reportFileName, const char* collapsedFileName);
+UA_StatusCode UA_Profiler_writeReport(UA_OutputSink* sink, size_t maxEntries);
+UA_StatusCode UA_ReadAndPrintValues(UA_Client* client, const UA_NodeId* nodeIds, size_t nodeIdsSize, UA_PrintFormat format, UA_OutputSink* sink,
+                                    UA_ChangeFilter* filter = 0x0);
+void UA_ReaderPool_clear(UA_ReaderPool* pool);
+UA_StatusCode UA_ReaderPool_init(UA_ReaderPool* pool, const char* endpointUrl, size_t sessions, UA_ClientFactory factory, void* factoryContext);
+UA_StatusCode UA_ReaderPool_read(UA_ReaderPool* pool, const UA_NodeId* nodeIds, size_t nodeIdsSize, UA_ReadValuesCallback callback, void* context);
+void UA_ReconnectManager_clear(UA_ReconnectManager* manager);
+UA_StatusCode UA_ReconnectManager_init(UA_ReconnectManager* manager, const char* endpointUrl, UA_ClientFactory factory, void* factoryContext,
+                                       UA_UInt32 initialDelay, UA_UInt32 maxDelay);
+UA_StatusCode UA_ReconnectManager_iterate(UA_ReconnectManager* manager, UA_UInt32 timeout);
+UA_StatusCode UA_ReconnectManager_read(UA_ReconnectManager* manager, const UA_NodeId* nodeIds, size_t nodeIdsSize, UA_ReadValuesCallback callback, void* context);
+UA_StatusCode UA_Recorder_close(UA_Recorder* recorder);
+UA_StatusCode UA_Recorder_open(UA_Recorder* recorder, const char* fileName);
+UA_StatusCode UA_Recorder_writeRegistry(UA_Recorder* recorder);
+UA_StatusCode UA_RegistryImage_load(UA_Client* client, const char* fileName);
+UA_StatusCode UA_RegistryImage_write(const char* fileName);
+UA_StatusCode UA_Replay(const char* fileName, UA_PrintFormat format, UA_OutputSink* sink, UA_ReplayStatistics* statistics);
+UA_StatusCode UA_ReadValues(UA_Client* client, const UA_NodeId* nodeIds, size_t nodeIdsSize, UA_ReadValuesCallback callback, void* context);
+UA_StatusCode UA_Trace_start(const char* fileName);
+UA_StatusCode UA_Trace_stop(void);
+UA_StatusCode UA_WriteTemplate_addField(UA_WriteTemplate* writeTemplate, const char* path, size_t* fieldIndex);
+void UA_WriteTemplate_clear(UA_WriteTemplate* writeTemplate);
+UA_StatusCode UA_WriteTemplate_init(UA_WriteTemplate* writeTemplate, const void* p, const UA_DataType* type);
+UA_StatusCode UA_WriteTemplate_instantiate(const UA_WriteTemplate* writeTemplate, UA_ExtensionObject* extensionObject);
+UA_StatusCode UA_WriteTemplate_setField(UA_WriteTemplate* writeTemplate, size_t fieldIndex, const void* value);
+UA_StatusCode UA_WriteValues(UA_Client* client, const UA_NodeId* nodeIds, const UA_Variant* values, size_t nodeIdsSize, UA_StatusCode* results);
 static UA_UInt32 numberOfCustomDataTypes;
 void customTypePropertiesInit(customTypeProperties_t* customTypeProperties, const UA_NodeId* customDataTypeId);
+
+// binds the native structure T (described with UA_BIND_BEGIN) to the custom data type typeId
+template <typename T>
+UA_StatusCode UA_bind(const UA_NodeId* typeId, UA_Binding* binding) {
+	size_t fieldsSize = 0;
+	const UA_BindField* fields = UA_BindTraits<T>::fields(&fieldsSize);
+	return UA_Binding_init(binding, typeId, fields, fieldsSize, sizeof(T));
+}
+
+// zero-copy access to a decoded value, 0x0 if the layouts differ (see UA_Binding_get) or data holds another type
+template <typename T>
+const T* UA_Binding_cast(const UA_Binding* binding, const UA_Variant* data, size_t index) {
+	if (!binding || !binding->zeroCopy || binding->nativeSize != sizeof(T) || !data || data->type != binding->type || data->data <= UA_EMPTY_ARRAY_SENTINEL)
+		return 0x0;
+	if (index >= (UA_Variant_isScalar(data) ? 1 : data->arrayLength))
+		return 0x0;
+	return reinterpret_cast<const T*>((const UA_Byte*)data->data + index * sizeof(T));
+}
+
+// copies the bound fields of a decoded value into the native structure, free them with UA_Binding_clearValue
+template <typename T>
+UA_StatusCode UA_Binding_get(const UA_Binding* binding, const UA_Variant* data, size_t index, T* value) {
+	if (binding && binding->nativeSize != sizeof(T))
+		return UA_STATUSCODE_BADTYPEMISMATCH;
+	return UA_Binding_copyValue(binding, data, index, value);
+}
@@ -0,0 +1,276 @@
+/*************************************************************************\
+* Copyright (c) 2021 HZB.
+* Author: Carsten Winkler carsten.winkler@helmholtz-berlin.de
+*
+* Regression tests of ExtendedObjectOpen62541 which need no server
+*
+*   ExtendedObjectTest
+*
+* prints one line per test (OK or FAILED with the failed checks)
+* and returns EXIT_FAILURE if a test failed
+* --------------------------------------------------------------------------
+* based on open62541
+*   https://github.com/open62541/open62541/releases/tag/v1.2.2
+*
+\*************************************************************************/
+
+#include <open62541/client_config_default.h>
+#include <open62541/client_highlevel.h>
+#include <open62541/client_subscriptions.h>
+#include <open62541/plugin/log_stdout.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// the registry is static, so the module is part of this translation unit
+#define EXTENDEDOBJECT_NO_MAIN
+#include "ExtendedObjectOpen62541.cpp"
+
+static size_t testFailures;
+
+// records a failed check of the current test
+#define TEST_CHECK(condition) do { \
+    if (!(condition)) { \
+        printf("\tFAILED %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+        testFailures++; \
+    } \
+} while (0)
+
+// runs a test and prints its result
+static void testRun(const char* name, void (*test)(void)) {
+    size_t failures = testFailures;
+    test();
+    printf("%s %s\n", failures == testFailures ? "OK    " : "FAILED", name);
+}
+
+// interned names: a long name (own block) as first string after clearCustomDataTypes must not become the block of the short names
+static void testRegistryLongNameFirst(void) {
+    std::string longName(20000, 'L');
+    std::vector<std::string> shortNames;
+    std::vector<const char*> interned;
+    const char* internedLongName;
+
+    clearCustomDataTypes();
+    internedLongName = internRegistryName(longName.c_str());
+    TEST_CHECK(internedLongName && longName == internedLongName);
+    // more characters than the long name has, so the short names need more than one block
+    for (size_t i = 0; i < 5000; i++) {
+        shortNames.push_back("ShortName_" + std::to_string(i));
+        interned.push_back(internRegistryName(shortNames.back().c_str()));
+    }
+    TEST_CHECK(longName == internedLongName);
+    for (size_t i = 0; i < shortNames.size(); i++) {
+        TEST_CHECK(interned[i] && shortNames[i] == interned[i]);
+        TEST_CHECK(internRegistryName(shortNames[i].c_str()) == interned[i]);
+    }
+    TEST_CHECK(internRegistryName(longName.c_str()) == internedLongName);
+    clearCustomDataTypes();
+}
+
+// node IDs with the same SDBM hash (UA_NodeId_SDBMHash)
+static const UA_NodeId testCollidingId1 = UA_NODEID_STRING(2, (char*)"Var_10055000");
+static const UA_NodeId testCollidingId2 = UA_NODEID_STRING(2, (char*)"Var_23100131");
+
+// data type cache: variables with the same hash must not evict each other
+static void testDataTypeCacheCollision(void) {
+    const UA_NodeId typeId1 = UA_NODEID_NUMERIC(2, 3001);
+    const UA_NodeId typeId2 = UA_NODEID_NUMERIC(2, 3002);
+    UA_NodeId dataTypeId;
+
+    TEST_CHECK(UA_NodeId_SDBMHash(&testCollidingId1) == UA_NodeId_SDBMHash(&testCollidingId2));
+    UA_DataTypeCache_invalidate(0x0);
+    storeDataTypeId(&testCollidingId1, &typeId1);
+    storeDataTypeId(&testCollidingId2, &typeId2);
+    TEST_CHECK(lookupDataTypeId(&testCollidingId1, &dataTypeId) == UA_STATUSCODE_GOOD && UA_NodeId_equal(&dataTypeId, &typeId1));
+    UA_NodeId_clear(&dataTypeId);
+    TEST_CHECK(lookupDataTypeId(&testCollidingId2, &dataTypeId) == UA_STATUSCODE_GOOD && UA_NodeId_equal(&dataTypeId, &typeId2));
+    UA_NodeId_clear(&dataTypeId);
+    UA_DataTypeCache_invalidate(&testCollidingId1);
+    TEST_CHECK(lookupDataTypeId(&testCollidingId1, &dataTypeId) == UA_STATUSCODE_BADNOTFOUND && UA_NodeId_isNull(&dataTypeId));
+    TEST_CHECK(lookupDataTypeId(&testCollidingId2, &dataTypeId) == UA_STATUSCODE_GOOD);
+    UA_NodeId_clear(&dataTypeId);
+    UA_DataTypeCache_invalidate(0x0);
+    TEST_CHECK(lookupDataTypeId(&testCollidingId2, &dataTypeId) == UA_STATUSCODE_BADNOTFOUND);
+}
+
+// data type cache: a looked up data type stays valid while other threads replace the entry
+static void testDataTypeCacheConcurrentStore(void) {
+    const UA_NodeId typeId1 = UA_NODEID_STRING(2, (char*)"EnumType_A");
+    const UA_NodeId typeId2 = UA_NODEID_STRING(2, (char*)"EnumType_B");
+    std::atomic<UA_Boolean> stop(false);
+    size_t invalid = 0;
+
+    UA_DataTypeCache_invalidate(0x0);
+    storeDataTypeId(&testCollidingId1, &typeId1);
+    std::thread writer([&]() {
+        for (size_t i = 0; !stop.load(); i++)
+            storeDataTypeId(&testCollidingId1, i % 2 ? &typeId1 : &typeId2);
+    });
+    for (size_t i = 0; i < 100000; i++) {
+        UA_NodeId dataTypeId;
+        if (lookupDataTypeId(&testCollidingId1, &dataTypeId) != UA_STATUSCODE_GOOD ||
+            (!UA_NodeId_equal(&dataTypeId, &typeId1) && !UA_NodeId_equal(&dataTypeId, &typeId2)))
+            invalid++;
+        UA_NodeId_clear(&dataTypeId);
+    }
+    stop = true;
+    writer.join();
+    TEST_CHECK(invalid == 0);
+    UA_DataTypeCache_invalidate(0x0);
+}
+
+// change filter: unchanged values of nodes with the same hash are skipped
+static void testChangeFilterCollision(void) {
+    UA_ChangeFilter filter;
+    UA_DataValue value1, value2;
+    UA_Int32 number1 = 1, number2 = 2;
+
+    UA_ChangeFilter_init(&filter);
+    UA_DataValue_init(&value1);
+    UA_DataValue_init(&value2);
+    UA_Variant_setScalar(&value1.value, &number1, &UA_TYPES[UA_TYPES_INT32]);
+    value1.hasValue = true;
+    UA_Variant_setScalar(&value2.value, &number2, &UA_TYPES[UA_TYPES_INT32]);
+    value2.hasValue = true;
+    TEST_CHECK(UA_ChangeFilter_check(&filter, &testCollidingId1, &value1));
+    TEST_CHECK(UA_ChangeFilter_check(&filter, &testCollidingId2, &value2));
+    for (size_t i = 0; i < 3; i++) {
+        TEST_CHECK(!UA_ChangeFilter_check(&filter, &testCollidingId1, &value1));
+        TEST_CHECK(!UA_ChangeFilter_check(&filter, &testCollidingId2, &value2));
+    }
+    number1 = 3;
+    TEST_CHECK(UA_ChangeFilter_check(&filter, &testCollidingId1, &value1));
+    TEST_CHECK(!UA_ChangeFilter_check(&filter, &testCollidingId2, &value2));
+    TEST_CHECK(filter.changed == 3 && filter.unchanged == 7);
+    UA_ChangeFilter_clear(&filter);
+}
+
+// writing values: enumerations have no binary encoding, declared values are encoded and written as Int32
+static void testEncodeEnum(void) {
+    const UA_NodeId typeId = UA_NODEID_NUMERIC(2, 3003);
+    customTypeProperties_t* customTypeProperties;
+    UA_WriteTemplate writeTemplate;
+    UA_ExtensionObject extensionObject;
+    UA_Variant value, variant;
+    UA_Int32 number = 2;
+    size_t fieldIndex;
+
+    clearCustomDataTypes();
+    customTypeProperties = &dataTypeMap[UA_NodeId_SDBMHash(&typeId)];
+    customTypePropertiesInit(customTypeProperties, &typeId);
+    customTypeProperties->dataType.typeName = internRegistryName("TestEnumeration");
+    customTypeProperties->dataType.typeKind = UA_DATATYPEKIND_ENUM;
+    customTypeProperties->dataType.memSize = sizeof(UA_Int32);
+    setEnumValues(customTypeProperties, { 0, 2 }, { internRegistryString("Off", 3), internRegistryString("On", 2) });
+    const UA_DataType* type = &customTypeProperties->dataType;
+    TEST_CHECK(UA_NodeId_isNull(&type->binaryEncodingId));
+
+    TEST_CHECK(UA_EncodeValue(&number, type, &extensionObject) == UA_STATUSCODE_GOOD);
+    TEST_CHECK(extensionObject.encoding == UA_EXTENSIONOBJECT_DECODED && extensionObject.content.decoded.type == &UA_TYPES[UA_TYPES_INT32] &&
+        *(UA_Int32*)extensionObject.content.decoded.data == 2);
+    UA_Variant_setScalar(&value, &extensionObject, &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]);
+    TEST_CHECK(prepareWriteValue(&value, &variant) == UA_STATUSCODE_GOOD);
+    TEST_CHECK(variant.type == &UA_TYPES[UA_TYPES_INT32] && *(UA_Int32*)variant.data == 2);
+    UA_ExtensionObject_clear(&extensionObject);
+    UA_Variant_setScalar(&value, &number, type);
+    TEST_CHECK(prepareWriteValue(&value, &variant) == UA_STATUSCODE_GOOD && variant.type == &UA_TYPES[UA_TYPES_INT32] && variant.data == &number);
+
+    number = 1;
+    TEST_CHECK(UA_EncodeValue(&number, type, &extensionObject) == UA_STATUSCODE_BADOUTOFRANGE);
+    TEST_CHECK(prepareWriteValue(&value, &variant) == UA_STATUSCODE_BADOUTOFRANGE);
+
+    number = 0;
+    TEST_CHECK(UA_WriteTemplate_init(&writeTemplate, &number, type) == UA_STATUSCODE_GOOD);
+    TEST_CHECK(UA_WriteTemplate_addField(&writeTemplate, "", &fieldIndex) == UA_STATUSCODE_GOOD);
+    TEST_CHECK(UA_WriteTemplate_addField(&writeTemplate, "Value", &fieldIndex) != UA_STATUSCODE_GOOD);
+    number = 1;
+    TEST_CHECK(UA_WriteTemplate_setField(&writeTemplate, 0, &number) == UA_STATUSCODE_BADOUTOFRANGE);
+    number = 2;
+    TEST_CHECK(UA_WriteTemplate_setField(&writeTemplate, 0, &number) == UA_STATUSCODE_GOOD);
+    TEST_CHECK(UA_WriteTemplate_instantiate(&writeTemplate, &extensionObject) == UA_STATUSCODE_GOOD);
+    TEST_CHECK(extensionObject.encoding == UA_EXTENSIONOBJECT_DECODED && *(UA_Int32*)extensionObject.content.decoded.data == 2);
+    UA_ExtensionObject_clear(&extensionObject);
+    UA_WriteTemplate_clear(&writeTemplate);
+    clearCustomDataTypes();
+}
+
+// structure of the printing tests
+typedef struct {
+    UA_UInt16 a;
+    UA_Float b;
+} testStructure_t;
+
+// allocates the data type of testStructure_t, it can be freed before the profile is written
+static UA_DataType* testNewStructureType(void) {
+    UA_DataType* type = (UA_DataType*)UA_calloc(1, sizeof(UA_DataType));
+    UA_DataTypeMember* members = (UA_DataTypeMember*)UA_calloc(2, sizeof(UA_DataTypeMember));
+    members[0].memberName = "A";
+    members[0].memberType = &UA_TYPES[UA_TYPES_UINT16];
+    members[1].memberName = "B";
+    members[1].memberType = &UA_TYPES[UA_TYPES_FLOAT];
+    members[1].padding = offsetof(testStructure_t, b) - sizeof(UA_UInt16);
+    type->typeName = "TestStructure";
+    type->typeId = UA_NODEID_NUMERIC(2, 4001);
+    type->typeKind = UA_DATATYPEKIND_STRUCTURE;
+    type->memSize = sizeof(testStructure_t);
+    type->members = members;
+    type->membersSize = 2;
+    return type;
+}
+
+static UA_StatusCode testWriteString(void* sinkContext, const UA_Byte* data, size_t length) {
+    ((std::string*)sinkContext)->append((const char*)data, length);
+    return UA_STATUSCODE_GOOD;
+}
+
+// profiler: members of array elements formatted by worker threads are profiled below the array value,
+// the report does not need the printed types any more
+static void testProfilerArrayWorkers(void) {
+    const size_t length = 5 * UA_PRINT_CHUNKSIZE;
+    std::vector<testStructure_t> values(length);
+    std::vector<UA_ProfileEntry> entries;
+    UA_DataType* type = testNewStructureType();
+    UA_Variant variant;
+    UA_String output;
+    UA_OutputSink sink;
+    std::string report;
+    size_t memberCalls = 0;
+
+    UA_Variant_init(&variant);
+    variant.type = type;
+    variant.data = values.data();
+    variant.arrayLength = length;
+    UA_Profiler_reset();
+    UA_Profiler_enable(true);
+    TEST_CHECK(UA_PrintStructure(&variant, &output) == UA_STATUSCODE_GOOD);
+    UA_Profiler_enable(false);
+    UA_String_clear(&output);
+    TEST_CHECK(UA_Profiler_snapshot(&entries) == UA_STATUSCODE_GOOD);
+    for (const UA_ProfileEntry& entry : entries) {
+        if (entry.path == "TestStructure;A") {
+            memberCalls = entry.calls;
+            TEST_CHECK(entry.typeName == "UInt16");
+        }
+    }
+    TEST_CHECK(memberCalls == length);
+    UA_free((void*)type->members);
+    memset(type, 0, sizeof(UA_DataType));
+    UA_free(type);
+    UA_OutputSink_init(&sink, testWriteString, &report);
+    TEST_CHECK(UA_Profiler_writeReport(&sink, 0) == UA_STATUSCODE_GOOD);
+    UA_OutputSink_flush(&sink);
+    TEST_CHECK(report.find("  TestStructure\n") != std::string::npos);
+    UA_Profiler_reset();
+}
+
+int main(void) {
+    testRun("registry long name first", testRegistryLongNameFirst);
+    testRun("data type cache collision", testDataTypeCacheCollision);
+    testRun("data type cache concurrent store", testDataTypeCacheConcurrentStore);
+    testRun("change filter collision", testChangeFilterCollision);
+    testRun("encode enumeration", testEncodeEnum);
+    testRun("profiler array workers", testProfilerArrayWorkers);
+    return testFailures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,374 @@
+/*************************************************************************\
+* Copyright (c) 2021 HZB.
+* Author: Carsten Winkler carsten.winkler@helmholtz-berlin.de
+*
+* Local stand-in OPC UA server with a synthetic custom type system
+* for reproducible tests and measurements of ExtendedObjectOpen62541
+* on loopback instead of public demo servers
+*
+*   ExtendedObjectTestServer [port] [structs] [depth] [namespaces]
+*
+* Every namespace (urn:exo:test:1, urn:exo:test:2, ...) gets
+*   - the enumeration Mode_<ns> (EnumStrings)
+*   - the option set Flags_<ns> (OptionSetValues)
+*   - the structure with optional fields Optional_<ns>
+*   - the union Choice_<ns>
+*   - structs structures Struct_<ns>_<i>, nested up to depth levels
+*     (Struct_<ns>_0 of the following namespaces references Struct_1_0)
+* the types are published as binary schema dictionary (one per namespace)
+* and as DataType nodes with encodings and properties; the folder
+* ns=<ns>;i=90 (Objects/Synthetic_<ns>) holds one variable of each type
+* --------------------------------------------------------------------------
+* based on open62541
+*   https://github.com/open62541/open62541/releases/tag/v1.2.2
+*
+\*************************************************************************/
+
+#include <open62541/plugin/log_stdout.h>
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+
+#include <signal.h>
+#include <stdlib.h>
+
+#include <string>
+#include <vector>
+
+// node IDs of the synthetic type system (numeric identifiers in each test namespace)
+#define TESTSERVER_ID_DICTIONARY 80
+#define TESTSERVER_ID_FOLDER 90
+#define TESTSERVER_ID_MODE 100
+#define TESTSERVER_ID_FLAGS 101
+#define TESTSERVER_ID_OPTIONAL 102
+#define TESTSERVER_ID_CHOICE 103
+#define TESTSERVER_ID_STRUCT 10000
+#define TESTSERVER_OFFSET_ENCODING 100000 // type ID + offset = binary encoding
+#define TESTSERVER_OFFSET_PROPERTY 200000 // type ID + offset = EnumStrings / OptionSetValues
+#define TESTSERVER_OFFSET_VARIABLE 300000 // type ID + offset = variable of the type
+#define TESTSERVER_FLAGS_BITS 10
+
+typedef struct {
+    UA_UInt16 port;
+    size_t structs; // structures per namespace
+    size_t depth; // maximum nesting depth of the structures
+    size_t namespaces; // namespaces with own dictionary
+} testServerConfig_t;
+
+typedef struct {
+    UA_UInt16 nsIndex;
+    size_t ns; // 1 based number of the test namespace
+    std::string uri;
+    std::string dictionary;
+} testNamespace_t;
+
+static volatile UA_Boolean running = true;
+
+static void stopHandler(int sig) {
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "received ctrl-c");
+    running = false;
+}
+
+// binary encoding of the synthetic values (little endian)
+static void encodeUInt32(std::string* body, UA_UInt32 value) {
+    for (size_t i = 0; i < 4; i++)
+        body->push_back((char)(value >> (8 * i)));
+}
+
+static void encodeUInt64(std::string* body, UA_UInt64 value) {
+    for (size_t i = 0; i < 8; i++)
+        body->push_back((char)(value >> (8 * i)));
+}
+
+static void encodeDouble(std::string* body, UA_Double value) {
+    UA_UInt64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    encodeUInt64(body, bits);
+}
+
+static void encodeFloat(std::string* body, UA_Float value) {
+    UA_UInt32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    encodeUInt32(body, bits);
+}
+
+static void encodeString(std::string* body, const std::string& value) {
+    encodeUInt32(body, (UA_UInt32)value.length());
+    body->append(value);
+}
+
+static std::string typeName(const char* name, size_t ns) {
+    return std::string(name) + "_" + std::to_string(ns);
+}
+
+static std::string structName(size_t ns, size_t i) {
+    return "Struct_" + std::to_string(ns) + "_" + std::to_string(i);
+}
+
+// Struct_<ns>_<i> has a child of the previous structure unless it starts a new nesting chain
+static UA_Boolean hasChild(const testServerConfig_t* config, size_t i) {
+    return config->depth && i % (config->depth + 1);
+}
+
+static UA_Boolean hasRemote(const testNamespace_t* testNamespace, size_t i) {
+    return testNamespace->ns > 1 && !i;
+}
+
+// value of Struct_<ns>_<i> (the same fields as the dictionary entry)
+static void encodeStruct(std::string* body, const testServerConfig_t* config, const testNamespace_t* testNamespace, size_t i) {
+    encodeUInt32(body, (UA_UInt32)i);
+    encodeDouble(body, 0.5 * (UA_Double)i);
+    encodeString(body, structName(testNamespace->ns, i));
+    encodeUInt32(body, (UA_UInt32)(i % 3));
+    body->push_back((char)(i % 2));
+    encodeUInt32(body, 3);
+    for (size_t j = 0; j < 3; j++)
+        encodeFloat(body, (UA_Float)(i + j));
+    // Flags: Value and ValidBits
+    encodeUInt32(body, 2);
+    body->push_back((char)(i & 0xFF));
+    body->push_back((char)0x00);
+    encodeUInt32(body, 2);
+    body->push_back((char)0xFF);
+    body->push_back((char)0x03);
+    if (hasChild(config, i))
+        encodeStruct(body, config, testNamespace, i - 1);
+    if (hasRemote(testNamespace, i)) {
+        testNamespace_t first = *testNamespace;
+        first.ns = 1;
+        encodeStruct(body, config, &first, 0);
+    }
+}
+
+// binary schema dictionary of one namespace, structures are declared after the types they use
+static std::string createDictionary(const testServerConfig_t* config, const testNamespace_t* testNamespace) {
+    const size_t ns = testNamespace->ns;
+    std::string xml;
+
+    xml = "<opc:TypeDictionary xmlns:opc=\"http://opcfoundation.org/BinarySchema/\" xmlns:ua=\"http://opcfoundation.org/UA/\"";
+    xml += " xmlns:tns=\"" + testNamespace->uri + "\"";
+    if (ns > 1)
+        xml += " xmlns:n1=\"urn:exo:test:1\"";
+    xml += " DefaultByteOrder=\"LittleEndian\" TargetNamespace=\"" + testNamespace->uri + "\">\n";
+    xml += "<opc:Import Namespace=\"http://opcfoundation.org/UA/\"/>\n";
+    if (ns > 1)
+        xml += "<opc:Import Namespace=\"urn:exo:test:1\"/>\n";
+    xml += "<opc:EnumeratedType LengthInBits=\"32\" Name=\"" + typeName("Mode", ns) + "\">\n";
+    xml += "<opc:EnumeratedValue Name=\"Off\" Value=\"0\"/>\n<opc:EnumeratedValue Name=\"Auto\" Value=\"1\"/>\n<opc:EnumeratedValue Name=\"Manual\" Value=\"2\"/>\n";
+    xml += "</opc:EnumeratedType>\n";
+    xml += "<opc:StructuredType BaseType=\"ua:ExtensionObject\" Name=\"" + typeName("Flags", ns) + "\">\n";
+    xml += "<opc:Field TypeName=\"opc:ByteString\" Name=\"Value\"/>\n<opc:Field TypeName=\"opc:ByteString\" Name=\"ValidBits\"/>\n";
+    xml += "</opc:StructuredType>\n";
+    xml += "<opc:StructuredType BaseType=\"ua:ExtensionObject\" Name=\"" + typeName("Optional", ns) + "\">\n";
+    xml += "<opc:Field TypeName=\"opc:Bit\" Name=\"CommentSpecified\"/>\n<opc:Field TypeName=\"opc:Bit\" Name=\"LimitSpecified\"/>\n";
+    xml += "<opc:Field Length=\"30\" TypeName=\"opc:Bit\" Name=\"Reserved1\"/>\n";
+    xml += "<opc:Field TypeName=\"opc:Double\" Name=\"Speed\"/>\n";
+    xml += "<opc:Field TypeName=\"opc:String\" SwitchField=\"CommentSpecified\" Name=\"Comment\"/>\n";
+    xml += "<opc:Field TypeName=\"opc:Int32\" SwitchField=\"LimitSpecified\" Name=\"Limit\"/>\n";
+    xml += "</opc:StructuredType>\n";
+    xml += "<opc:StructuredType BaseType=\"ua:Union\" Name=\"" + typeName("Choice", ns) + "\">\n";
+    xml += "<opc:Field TypeName=\"opc:UInt32\" Name=\"SwitchField\"/>\n";
+    xml += "<opc:Field TypeName=\"opc:Int32\" SwitchField=\"SwitchField\" SwitchValue=\"1\" Name=\"Count\"/>\n";
+    xml += "<opc:Field TypeName=\"opc:Double\" SwitchField=\"SwitchField\" SwitchValue=\"2\" Name=\"Ratio\"/>\n";
+    xml += "<opc:Field TypeName=\"opc:String\" SwitchField=\"SwitchField\" SwitchValue=\"3\" Name=\"Label\"/>\n";
+    xml += "</opc:StructuredType>\n";
+    for (size_t i = 0; i < config->structs; i++) {
+        xml += "<opc:StructuredType BaseType=\"ua:ExtensionObject\" Name=\"" + structName(ns, i) + "\">\n";
+        xml += "<opc:Field TypeName=\"opc:UInt32\" Name=\"Id\"/>\n<opc:Field TypeName=\"opc:Double\" Name=\"Value\"/>\n";
+        xml += "<opc:Field TypeName=\"opc:String\" Name=\"Name\"/>\n";
+        xml += "<opc:Field TypeName=\"tns:" + typeName("Mode", ns) + "\" Name=\"Mode\"/>\n";
+        xml += "<opc:Field TypeName=\"opc:Boolean\" Name=\"Enabled\"/>\n";
+        xml += "<opc:Field TypeName=\"opc:Int32\" Name=\"NoOfSamples\"/>\n<opc:Field LengthField=\"NoOfSamples\" TypeName=\"opc:Float\" Name=\"Samples\"/>\n";
+        xml += "<opc:Field TypeName=\"tns:" + typeName("Flags", ns) + "\" Name=\"Flags\"/>\n";
+        if (hasChild(config, i))
+            xml += "<opc:Field TypeName=\"tns:" + structName(ns, i - 1) + "\" Name=\"Child\"/>\n";
+        if (hasRemote(testNamespace, i))
+            xml += "<opc:Field TypeName=\"n1:" + structName(1, 0) + "\" Name=\"Remote\"/>\n";
+        xml += "</opc:StructuredType>\n";
+    }
+    xml += "</opc:TypeDictionary>\n";
+    return xml;
+}
+
+// adds a DataType node with binary encoding below the given base type
+static UA_StatusCode addDataType(UA_Server* server, UA_UInt16 nsIndex, UA_UInt32 id, const std::string& name, UA_UInt32 baseTypeId) {
+    UA_DataTypeAttributes dtAttr = UA_DataTypeAttributes_default;
+    UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
+    UA_StatusCode retval;
+
+    dtAttr.displayName = UA_LOCALIZEDTEXT((char*)"", (char*)name.c_str());
+    retval = UA_Server_addDataTypeNode(server, UA_NODEID_NUMERIC(nsIndex, id), UA_NODEID_NUMERIC(0, baseTypeId),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE), UA_QUALIFIEDNAME(nsIndex, (char*)name.c_str()), dtAttr, 0x0, 0x0);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+    if (baseTypeId == UA_NS0ID_ENUMERATION)
+        return UA_STATUSCODE_GOOD;
+    // encoding objects have no parent, the type references them with HasEncoding
+    oAttr.displayName = UA_LOCALIZEDTEXT((char*)"", (char*)"Default Binary");
+    retval = UA_Server_addObjectNode(server, UA_NODEID_NUMERIC(nsIndex, id + TESTSERVER_OFFSET_ENCODING), UA_NODEID_NULL, UA_NODEID_NULL,
+                                     UA_QUALIFIEDNAME(0, (char*)"Default Binary"), UA_NODEID_NUMERIC(0, UA_NS0ID_DATATYPEENCODINGTYPE), oAttr, 0x0, 0x0);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+    return UA_Server_addReference(server, UA_NODEID_NUMERIC(nsIndex, id), UA_NODEID_NUMERIC(0, UA_NS0ID_HASENCODING),
+                                  UA_EXPANDEDNODEID_NUMERIC(nsIndex, id + TESTSERVER_OFFSET_ENCODING), true);
+}
+
+// adds the EnumStrings or OptionSetValues property of a data type
+static UA_StatusCode addNamesProperty(UA_Server* server, UA_UInt16 nsIndex, UA_UInt32 id, const char* browseName, const std::vector<std::string>& names) {
+    UA_VariableAttributes vAttr = UA_VariableAttributes_default;
+    std::vector<UA_LocalizedText> texts;
+    UA_UInt32 arrayDimensions = (UA_UInt32)names.size();
+
+    for (const std::string& name : names)
+        texts.push_back(UA_LOCALIZEDTEXT((char*)"", (char*)name.c_str()));
+    vAttr.displayName = UA_LOCALIZEDTEXT((char*)"", (char*)browseName);
+    vAttr.dataType = UA_TYPES[UA_TYPES_LOCALIZEDTEXT].typeId;
+    vAttr.valueRank = UA_VALUERANK_ONE_DIMENSION;
+    vAttr.arrayDimensionsSize = 1;
+    vAttr.arrayDimensions = &arrayDimensions;
+    UA_Variant_setArray(&vAttr.value, texts.data(), texts.size(), &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+    return UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(nsIndex, id + TESTSERVER_OFFSET_PROPERTY), UA_NODEID_NUMERIC(nsIndex, id),
+                                     UA_NODEID_NUMERIC(0, UA_NS0ID_HASPROPERTY), UA_QUALIFIEDNAME(0, (char*)browseName),
+                                     UA_NODEID_NUMERIC(0, UA_NS0ID_PROPERTYTYPE), vAttr, 0x0, 0x0);
+}
+
+// adds a variable of a custom data type, structured values are passed as encoded ExtensionObject
+static UA_StatusCode addVariable(UA_Server* server, UA_UInt16 nsIndex, UA_UInt32 id, const std::string& name, const UA_Variant* value) {
+    UA_VariableAttributes vAttr = UA_VariableAttributes_default;
+    vAttr.displayName = UA_LOCALIZEDTEXT((char*)"", (char*)name.c_str());
+    vAttr.dataType = UA_NODEID_NUMERIC(nsIndex, id);
+    vAttr.valueRank = UA_VALUERANK_SCALAR;
+    vAttr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    vAttr.value = *value;
+    return UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(nsIndex, id + TESTSERVER_OFFSET_VARIABLE), UA_NODEID_NUMERIC(nsIndex, TESTSERVER_ID_FOLDER),
+                                     UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES), UA_QUALIFIEDNAME(nsIndex, (char*)name.c_str()),
+                                     UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE), vAttr, 0x0, 0x0);
+}
+
+static UA_StatusCode addEncodedVariable(UA_Server* server, UA_UInt16 nsIndex, UA_UInt32 id, const std::string& name, std::string* body) {
+    UA_ExtensionObject extensionObject;
+    UA_Variant value;
+    UA_ExtensionObject_init(&extensionObject);
+    extensionObject.encoding = UA_EXTENSIONOBJECT_ENCODED_BYTESTRING;
+    extensionObject.content.encoded.typeId = UA_NODEID_NUMERIC(nsIndex, id + TESTSERVER_OFFSET_ENCODING);
+    extensionObject.content.encoded.body.length = body->length();
+    extensionObject.content.encoded.body.data = (UA_Byte*)&(*body)[0];
+    UA_Variant_setScalar(&value, &extensionObject, &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]);
+    return addVariable(server, nsIndex, id, name, &value);
+}
+
+// publishes the type system and the variables of one test namespace
+static UA_StatusCode addTestNamespace(UA_Server* server, const testServerConfig_t* config, testNamespace_t* testNamespace) {
+    const UA_UInt16 nsIndex = testNamespace->nsIndex;
+    const size_t ns = testNamespace->ns;
+    UA_VariableAttributes vAttr = UA_VariableAttributes_default;
+    UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
+    std::vector<std::string> names;
+    UA_ByteString dictionary;
+    std::string body;
+    UA_Variant value;
+    UA_Int32 mode = 1;
+    UA_StatusCode retval;
+
+    // data types
+    retval = addDataType(server, nsIndex, TESTSERVER_ID_MODE, typeName("Mode", ns), UA_NS0ID_ENUMERATION);
+    names = { "Off", "Auto", "Manual" };
+    retval |= addNamesProperty(server, nsIndex, TESTSERVER_ID_MODE, "EnumStrings", names);
+    retval |= addDataType(server, nsIndex, TESTSERVER_ID_FLAGS, typeName("Flags", ns), UA_NS0ID_OPTIONSET);
+    names.clear();
+    for (size_t i = 0; i < TESTSERVER_FLAGS_BITS; i++)
+        names.push_back("Bit" + std::to_string(i));
+    retval |= addNamesProperty(server, nsIndex, TESTSERVER_ID_FLAGS, "OptionSetValues", names);
+    retval |= addDataType(server, nsIndex, TESTSERVER_ID_OPTIONAL, typeName("Optional", ns), UA_NS0ID_STRUCTURE);
+    retval |= addDataType(server, nsIndex, TESTSERVER_ID_CHOICE, typeName("Choice", ns), UA_NS0ID_UNION);
+    for (size_t i = 0; i < config->structs && retval == UA_STATUSCODE_GOOD; i++)
+        retval = addDataType(server, nsIndex, (UA_UInt32)(TESTSERVER_ID_STRUCT + i), structName(ns, i), UA_NS0ID_STRUCTURE);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    // binary schema dictionary
+    testNamespace->dictionary = createDictionary(config, testNamespace);
+    dictionary.length = testNamespace->dictionary.length();
+    dictionary.data = (UA_Byte*)&testNamespace->dictionary[0];
+    vAttr.displayName = UA_LOCALIZEDTEXT((char*)"", (char*)testNamespace->uri.c_str());
+    vAttr.dataType = UA_TYPES[UA_TYPES_BYTESTRING].typeId;
+    UA_Variant_setScalar(&vAttr.value, &dictionary, &UA_TYPES[UA_TYPES_BYTESTRING]);
+    retval = UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(nsIndex, TESTSERVER_ID_DICTIONARY), UA_NODEID_NUMERIC(0, UA_NS0ID_OPCBINARYSCHEMA_TYPESYSTEM),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT), UA_QUALIFIEDNAME(nsIndex, (char*)testNamespace->uri.c_str()),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_DATATYPEDICTIONARYTYPE), vAttr, 0x0, 0x0);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    // one variable of each type
+    oAttr.displayName = UA_LOCALIZEDTEXT((char*)"", (char*)typeName("Synthetic", ns).c_str());
+    retval = UA_Server_addObjectNode(server, UA_NODEID_NUMERIC(nsIndex, TESTSERVER_ID_FOLDER), UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                     UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES), UA_QUALIFIEDNAME(nsIndex, (char*)typeName("Synthetic", ns).c_str()),
+                                     UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE), oAttr, 0x0, 0x0);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+    UA_Variant_setScalar(&value, &mode, &UA_TYPES[UA_TYPES_INT32]);
+    retval = addVariable(server, nsIndex, TESTSERVER_ID_MODE, typeName("Mode", ns), &value);
+    body.clear();
+    encodeUInt32(&body, 2);
+    body.append("\x05\x00", 2);
+    encodeUInt32(&body, 2);
+    body.append("\xFF\x03", 2);
+    retval |= addEncodedVariable(server, nsIndex, TESTSERVER_ID_FLAGS, typeName("Flags", ns), &body);
+    // Comment is set, Limit is not
+    body.clear();
+    encodeUInt32(&body, 0x01);
+    encodeDouble(&body, 12.5);
+    encodeString(&body, "optional comment");
+    retval |= addEncodedVariable(server, nsIndex, TESTSERVER_ID_OPTIONAL, typeName("Optional", ns), &body);
+    body.clear();
+    encodeUInt32(&body, 2);
+    encodeDouble(&body, 0.25);
+    retval |= addEncodedVariable(server, nsIndex, TESTSERVER_ID_CHOICE, typeName("Choice", ns), &body);
+    for (size_t i = 0; i < config->structs && retval == UA_STATUSCODE_GOOD; i++) {
+        body.clear();
+        encodeStruct(&body, config, testNamespace, i);
+        retval = addEncodedVariable(server, nsIndex, (UA_UInt32)(TESTSERVER_ID_STRUCT + i), structName(ns, i), &body);
+    }
+    return retval;
+}
+
+int main(int argc, char* argv[]) {
+    testServerConfig_t config;
+    std::vector<testNamespace_t> testNamespaces;
+    UA_Server* server;
+    UA_StatusCode retval;
+
+    config.port = 4840;
+    config.structs = 100;
+    config.depth = 3;
+    config.namespaces = 2;
+    if (argc > 1) config.port = (UA_UInt16)strtoul(argv[1], 0x0, 10);
+    if (argc > 2) config.structs = strtoul(argv[2], 0x0, 10);
+    if (argc > 3) config.depth = strtoul(argv[3], 0x0, 10);
+    if (argc > 4) config.namespaces = strtoul(argv[4], 0x0, 10);
+    if (!config.namespaces)
+        config.namespaces = 1;
+
+    signal(SIGINT, stopHandler);
+    signal(SIGTERM, stopHandler);
+
+    server = UA_Server_new();
+    UA_ServerConfig_setMinimal(UA_Server_getConfig(server), config.port, 0x0);
+    testNamespaces.resize(config.namespaces);
+    for (size_t i = 0; i < config.namespaces; i++) {
+        testNamespaces[i].ns = i + 1;
+        testNamespaces[i].uri = "urn:exo:test:" + std::to_string(i + 1);
+        testNamespaces[i].nsIndex = UA_Server_addNamespace(server, testNamespaces[i].uri.c_str());
+        retval = addTestNamespace(server, &config, &testNamespaces[i]);
+        if (retval != UA_STATUSCODE_GOOD) {
+            UA_LOG_ERROR(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "Could not create test namespace %s. (%s)", testNamespaces[i].uri.c_str(), UA_StatusCode_name(retval));
+            UA_Server_delete(server);
+            return EXIT_FAILURE;
+        }
+    }
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "%u namespaces with %u structures (depth %u) on port %u",
+                (UA_UInt32)config.namespaces, (UA_UInt32)config.structs, (UA_UInt32)config.depth, config.port);
+
+    retval = UA_Server_run(server, &running);
+    UA_Server_delete(server);
+    return retval == UA_STATUSCODE_GOOD ? EXIT_SUCCESS : EXIT_FAILURE;
+}
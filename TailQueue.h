@@ -162,6 +162,15 @@ struct {								\
     _Q_INVALIDATE((elm)->field.tqe_next);				\
 } while (0)
 
+#define TAILQ_CONCAT(head1, head2, field) do {				\
+    if (!TAILQ_EMPTY(head2)) {					\
+        *(head1)->tqh_last = (head2)->tqh_first;		\
+        (head2)->tqh_first->field.tqe_prev = (head1)->tqh_last;	\
+        (head1)->tqh_last = (head2)->tqh_last;			\
+        TAILQ_INIT((head2));					\
+    }								\
+} while (0)
+
 #pragma warning(disable : 4200)
 typedef struct UA_PrintElement {
     TAILQ_ENTRY(UA_PrintElement) next;